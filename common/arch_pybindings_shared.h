@@ -19,6 +19,8 @@ fn_wrapper_5a_v<Context, decltype(&Context::createRectangularRegion), &Context::
                 pass_through<int>>::def_wrap(ctx_cls, "createRectangularRegion");
 fn_wrapper_2a_v<Context, decltype(&Context::addBelToRegion), &Context::addBelToRegion, conv_from_str<IdString>,
                 conv_from_str<BelId>>::def_wrap(ctx_cls, "addBelToRegion");
+fn_wrapper_2a_v<Context, decltype(&Context::addRegionBelType), &Context::addRegionBelType, conv_from_str<IdString>,
+                conv_from_str<IdString>>::def_wrap(ctx_cls, "addRegionBelType");
 fn_wrapper_2a_v<Context, decltype(&Context::constrainCellToRegion), &Context::constrainCellToRegion,
                 conv_from_str<IdString>, conv_from_str<IdString>>::def_wrap(ctx_cls, "constrainCellToRegion");
 
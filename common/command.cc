@@ -142,6 +142,21 @@ po::options_description CommandHandler::getGeneralOptions()
     general.add_options()("cstrweight", po::value<float>(), "placer weighting for relative constraint satisfaction");
     general.add_options()("starttemp", po::value<float>(), "placer SA start temperature");
     general.add_options()("placer-budgets", "use budget rather than criticality in placer timing weights");
+    general.add_options()("placer-heap-reuse-hierarchy",
+                          "place repeated hierarchical instances with a common relative placement in HeAP");
+    general.add_options()("placer-heap-net-model", po::value<std::string>(),
+                          "wirelength model for the HeAP analytic solve; b2b (default), wa or lse");
+    general.add_options()("placer-heap-refine", po::value<std::string>(),
+                          "refinement after HeAP legalisation; sa (default), detail or none");
+    general.add_options()("placer-heap-seed", po::value<std::string>(),
+                          "initial placement for HeAP; random (default) or cluster");
+
+    general.add_options()("router2-hist-cong-in", po::value<std::string>(),
+                          "seed router2 historical congestion costs from a file written by --router2-hist-cong-out");
+    general.add_options()("router2-hist-cong-out", po::value<std::string>(),
+                          "write final router2 historical congestion costs to a file");
+    general.add_options()("router2-hold-fix-iters", po::value<int>(),
+                          "reroute arcs that violate hold for up to this many iterations after router2 (default 0)");
 
     general.add_options()("pack-only", "pack design only without placement or routing");
     general.add_options()("no-route", "process design without routing");
@@ -154,9 +169,13 @@ po::options_description CommandHandler::getGeneralOptions()
     general.add_options()("test", "check architecture database integrity");
     general.add_options()("freq", po::value<double>(), "set target frequency for design in MHz");
     general.add_options()("timing-allow-fail", "allow timing to fail in design");
+    general.add_options()("no-clock-skew", "time all registers from the same clock arrival, ignoring clock skew");
     general.add_options()("no-tmdriv", "disable timing-driven placement");
     general.add_options()("sdf", po::value<std::string>(), "SDF delay back-annotation file to write");
     general.add_options()("sdf-cvc", "enable tweaks for SDF file compatibility with the CVC simulator");
+    general.add_options()("write-verilog", po::value<std::string>(),
+                          "structural Verilog netlist to write, for simulation with the SDF file");
+    general.add_options()("verilog-delays", "include routing delays in the Verilog netlist, instead of the SDF file");
 
     return general;
 }
@@ -211,6 +230,10 @@ void CommandHandler::setupContext(Context *ctx)
         ctx->settings[ctx->id("timing/allowFail")] = true;
     }
 
+    if (vm.count("no-clock-skew")) {
+        ctx->settings[ctx->id("timing/clockSkew")] = false;
+    }
+
     if (vm.count("placer")) {
         std::string placer = vm["placer"].as<std::string>();
         if (std::find(Arch::availablePlacers.begin(), Arch::availablePlacers.end(), placer) ==
@@ -239,6 +262,27 @@ void CommandHandler::setupContext(Context *ctx)
     if (vm.count("placer-budgets")) {
         ctx->settings[ctx->id("placer1/budgetBased")] = true;
     }
+    if (vm.count("placer-heap-reuse-hierarchy")) {
+        ctx->settings[ctx->id("placerHeap/reuseHierarchy")] = true;
+    }
+    if (vm.count("placer-heap-net-model")) {
+        ctx->settings[ctx->id("placerHeap/netModel")] = vm["placer-heap-net-model"].as<std::string>();
+    }
+    if (vm.count("router2-hist-cong-in")) {
+        ctx->settings[ctx->id("router2/histCongIn")] = vm["router2-hist-cong-in"].as<std::string>();
+    }
+    if (vm.count("router2-hist-cong-out")) {
+        ctx->settings[ctx->id("router2/histCongOut")] = vm["router2-hist-cong-out"].as<std::string>();
+    }
+    if (vm.count("router2-hold-fix-iters")) {
+        ctx->settings[ctx->id("router2/holdFixIters")] = std::to_string(vm["router2-hold-fix-iters"].as<int>());
+    }
+    if (vm.count("placer-heap-refine")) {
+        ctx->settings[ctx->id("placerHeap/refine")] = vm["placer-heap-refine"].as<std::string>();
+    }
+    if (vm.count("placer-heap-seed")) {
+        ctx->settings[ctx->id("placerHeap/seed")] = vm["placer-heap-seed"].as<std::string>();
+    }
     if (vm.count("freq")) {
         auto freq = vm["freq"].as<double>();
         if (freq > 0)
@@ -364,6 +408,14 @@ int CommandHandler::executeMain(std::unique_ptr<Context> ctx)
         ctx->writeSDF(f, vm.count("sdf-cvc"));
     }
 
+    if (vm.count("write-verilog")) {
+        std::string filename = vm["write-verilog"].as<std::string>();
+        std::ofstream f(filename);
+        if (!f)
+            log_error("Failed to open Verilog file '%s' for writing.\n", filename.c_str());
+        ctx->writeVerilog(f, vm.count("verilog-delays"));
+    }
+
 #ifndef NO_PYTHON
     deinit_python();
 #endif
@@ -21,6 +21,7 @@
 #include "design_utils.h"
 #include <algorithm>
 #include <map>
+#include <sstream>
 #include <boost/regex.hpp>
 #include "log.h"
 #include "util.h"
@@ -168,4 +169,49 @@ void rename_net(Context *ctx, NetInfo *net, IdString new_name)
     net->name = new_name;
 }
 
+std::string logical_cell_type(const Context *ctx, const CellInfo *cell)
+{
+    auto found = cell->attrs.find(ctx->id("X_ORIG_TYPE"));
+    if (found != cell->attrs.end() && found->second.is_string && !found->second.str.empty())
+        return found->second.str;
+    return cell->type.str(ctx);
+}
+
+std::vector<std::string> logical_port_names(const Context *ctx, const CellInfo *cell, IdString port)
+{
+    auto found = cell->attrs.find(ctx->id("X_ORIG_PORT_" + port.str(ctx)));
+    if (found == cell->attrs.end())
+        return {port.str(ctx)};
+    std::vector<std::string> names;
+    std::istringstream ss(found->second.as_string());
+    std::string name;
+    while (ss >> name)
+        names.push_back(name);
+    return names;
+}
+
+std::map<std::string, Property> logical_params(const Context *ctx, const CellInfo *cell)
+{
+    std::map<std::string, Property> params;
+    auto found = cell->attrs.find(ctx->id("X_ORIG_PARAMS"));
+    if (found == cell->attrs.end()) {
+        for (auto &param : cell->params)
+            params[param.first.str(ctx)] = param.second;
+        return params;
+    }
+    std::istringstream ss(found->second.as_string());
+    std::string name;
+    while (ss >> name) {
+        auto value = cell->params.find(ctx->id(name));
+        if (value != cell->params.end())
+            params[name] = value->second;
+    }
+    for (auto &param : cell->params) {
+        auto orig = cell->attrs.find(ctx->id("X_ORIG_PARAM_" + param.first.str(ctx)));
+        if (orig != cell->attrs.end() && params.count(orig->second.as_string()))
+            params[orig->second.as_string()] = param.second;
+    }
+    return params;
+}
+
 NEXTPNR_NAMESPACE_END
@@ -24,6 +24,7 @@
 #define DESIGN_UTILS_H
 
 #include <algorithm>
+#include <map>
 
 NEXTPNR_NAMESPACE_BEGIN
 
@@ -99,6 +100,15 @@ void rename_net(Context *ctx, NetInfo *net, IdString new_name);
 
 void print_utilisation(const Context *ctx);
 
+// The primitive type and port names of a cell before packing, as recorded by the packer in the X_ORIG_TYPE and
+// X_ORIG_PORT_<port> attributes. A packed port may stand for several logical ports, or none
+std::string logical_cell_type(const Context *ctx, const CellInfo *cell);
+std::vector<std::string> logical_port_names(const Context *ctx, const CellInfo *cell, IdString port);
+
+// The parameters of a cell as its pre-packing primitive, where the packer records their names in X_ORIG_PARAMS.
+// Parameters renamed by packing (X_ORIG_PARAM_<new name>) take their current value; those added are dropped
+std::map<std::string, Property> logical_params(const Context *ctx, const CellInfo *cell);
+
 NEXTPNR_NAMESPACE_END
 
 #endif
@@ -0,0 +1,674 @@
+/*
+ *  nextpnr -- Next Generation Place and Route
+ *
+ *  Copyright (C) 2026  agent <agent@local>
+ *
+ *  Permission to use, copy, modify, and/or distribute this software for any
+ *  purpose with or without fee is hereby granted, provided that the above
+ *  copyright notice and this permission notice appear in all copies.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ *  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ *  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ *  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ *  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ *  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ *  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ *  Detailed placement, running the following moves over a legal placement until they stop improving wirelength:
+ *   - global swap: move a cell to (or swap it with a cell at) a bel inside the optimal region of its nets. Macros
+ *     such as LUT/FF pairs and carry chains move as a unit, keeping the offsets of their cells from the root
+ *   - local reordering: try all permutations of three neighbouring cells of the same type in a column or row
+ *   - independent set matching: optimally reassign a set of cells of one type that share no nets within a window,
+ *     together with the free bels in the window, by solving an assignment problem. Windows are disjoint, so they
+ *     are solved in parallel and then committed serially
+ *
+ */
+
+#include "detail_place.h"
+#include <algorithm>
+#include <chrono>
+#include <limits>
+#include <thread>
+#include <tuple>
+#include "place_common.h"
+#include "util.h"
+
+NEXTPNR_NAMESPACE_BEGIN
+
+namespace {
+
+// Minimum cost assignment of the n rows of cost to distinct columns (n <= m) with the Hungarian algorithm, in
+// O(n^2 m). Returns the column assigned to each row
+std::vector<int> solve_assignment(const std::vector<std::vector<double>> &cost)
+{
+    int n = int(cost.size()), m = int(cost.front().size());
+    const double inf = std::numeric_limits<double>::max();
+    // 1-indexed potentials and matching, p[j] is the row matched to column j
+    std::vector<double> u(n + 1, 0), v(m + 1, 0);
+    std::vector<int> p(m + 1, 0), way(m + 1, 0);
+    for (int i = 1; i <= n; i++) {
+        p[0] = i;
+        int j0 = 0;
+        std::vector<double> minv(m + 1, inf);
+        std::vector<bool> used(m + 1, false);
+        do {
+            used[j0] = true;
+            int i0 = p[j0], j1 = 0;
+            double delta = inf;
+            for (int j = 1; j <= m; j++) {
+                if (used[j])
+                    continue;
+                double cur = cost[i0 - 1][j - 1] - u[i0] - v[j];
+                if (cur < minv[j]) {
+                    minv[j] = cur;
+                    way[j] = j0;
+                }
+                if (minv[j] < delta) {
+                    delta = minv[j];
+                    j1 = j;
+                }
+            }
+            for (int j = 0; j <= m; j++) {
+                if (used[j]) {
+                    u[p[j]] += delta;
+                    v[j] -= delta;
+                } else {
+                    minv[j] -= delta;
+                }
+            }
+            j0 = j1;
+        } while (p[j0] != 0);
+        do {
+            int j1 = way[j0];
+            p[j0] = p[j1];
+            j0 = j1;
+        } while (j0 != 0);
+    }
+    std::vector<int> result(n, -1);
+    for (int j = 1; j <= m; j++)
+        if (p[j] != 0)
+            result[p[j] - 1] = j - 1;
+    return result;
+}
+
+} // namespace
+
+class DetailPlacer
+{
+  public:
+    DetailPlacer(Context *ctx, DetailPlaceCfg cfg) : ctx(ctx), cfg(cfg) {}
+
+    bool place()
+    {
+        auto startt = std::chrono::high_resolution_clock::now();
+        ctx->lock();
+        build_bel_grid();
+        wirelen_t start_hpwl = total_hpwl(), last_hpwl = start_hpwl;
+        log_info("Running detailed placement, initial wirelen = %d.\n", int(start_hpwl));
+        for (int pass = 0; pass < cfg.passes; pass++) {
+            int swaps = global_swap();
+            int reorders = local_reorder(true) + local_reorder(false);
+            int matched = independent_set_match(pass);
+            wirelen_t hpwl = total_hpwl();
+            log_info("    at detail pass %d, wirelen = %d (%d swaps, %d reorders, %d cells matched)\n", pass + 1,
+                     int(hpwl), swaps, reorders, matched);
+            ctx->yield();
+            if (hpwl >= last_hpwl * 0.999)
+                break;
+            last_hpwl = hpwl;
+        }
+        ctx->unlock();
+        auto endtt = std::chrono::high_resolution_clock::now();
+        log_info("Detailed placement improved wirelen from %d to %d in %.02fs.\n", int(start_hpwl),
+                 int(total_hpwl()), std::chrono::duration<double>(endtt - startt).count());
+        return true;
+    }
+
+  private:
+    Context *ctx;
+    DetailPlaceCfg cfg;
+
+    int max_x = 0, max_y = 0;
+    // Bels of each type by location
+    std::unordered_map<IdString, std::vector<std::vector<std::vector<BelId>>>> bel_grid;
+
+    // A tentative set of moves; cells not listed stay where they are
+    typedef std::vector<std::pair<CellInfo *, BelId>> MoveSet;
+
+    void build_bel_grid()
+    {
+        for (auto bel : ctx->getBels()) {
+            Loc loc = ctx->getBelLocation(bel);
+            max_x = std::max(max_x, loc.x);
+            max_y = std::max(max_y, loc.y);
+        }
+        for (auto bel : ctx->getBels()) {
+            Loc loc = ctx->getBelLocation(bel);
+            auto &grid = bel_grid[ctx->getBelType(bel)];
+            if (grid.empty())
+                grid.resize(max_x + 1, std::vector<std::vector<BelId>>(max_y + 1));
+            grid.at(loc.x).at(loc.y).push_back(bel);
+        }
+    }
+
+    bool movable(const CellInfo *cell) const
+    {
+        return cell->bel != BelId() && cell->belStrength <= STRENGTH_WEAK && cell->constr_parent == nullptr &&
+               cell->constr_children.empty() && !ctx->getBelGlobalBuf(cell->bel);
+    }
+
+    bool ignore_net(const NetInfo *net) const
+    {
+        return net->driver.cell == nullptr || net->driver.cell->bel == BelId() ||
+               int(net->users.size()) > cfg.maxFanout || ctx->getBelGlobalBuf(net->driver.cell->bel);
+    }
+
+    Loc cell_loc(const CellInfo *cell, const MoveSet &moves) const
+    {
+        for (auto &mv : moves)
+            if (mv.first == cell)
+                return ctx->getBelLocation(mv.second);
+        return ctx->getBelLocation(cell->bel);
+    }
+
+    wirelen_t net_hpwl(const NetInfo *net, const MoveSet &moves) const
+    {
+        Loc drv = cell_loc(net->driver.cell, moves);
+        int x0 = drv.x, x1 = drv.x, y0 = drv.y, y1 = drv.y;
+        for (auto &usr : net->users) {
+            if (usr.cell->bel == BelId())
+                continue;
+            Loc l = cell_loc(usr.cell, moves);
+            x0 = std::min(x0, l.x);
+            x1 = std::max(x1, l.x);
+            y0 = std::min(y0, l.y);
+            y1 = std::max(y1, l.y);
+        }
+        return wirelen_t(cfg.hpwl_scale_x) * (x1 - x0) + wirelen_t(cfg.hpwl_scale_y) * (y1 - y0);
+    }
+
+    // Nets affected by moving any of a set of cells
+    void cell_nets(const std::vector<CellInfo *> &cells, std::vector<const NetInfo *> &nets) const
+    {
+        nets.clear();
+        for (auto cell : cells) {
+            if (cell == nullptr)
+                continue;
+            for (auto &port : cell->ports) {
+                const NetInfo *ni = port.second.net;
+                if (ni == nullptr || ignore_net(ni))
+                    continue;
+                if (std::find(nets.begin(), nets.end(), ni) == nets.end())
+                    nets.push_back(ni);
+            }
+        }
+    }
+
+    wirelen_t nets_hpwl(const std::vector<const NetInfo *> &nets, const MoveSet &moves) const
+    {
+        wirelen_t total = 0;
+        for (auto ni : nets)
+            total += net_hpwl(ni, moves);
+        return total;
+    }
+
+    wirelen_t total_hpwl() const
+    {
+        wirelen_t total = 0;
+        for (auto &net : ctx->nets)
+            if (!ignore_net(net.second.get()))
+                total += net_hpwl(net.second.get(), {});
+        return total;
+    }
+
+    bool valid_for(const CellInfo *cell, BelId bel) const
+    {
+        return ctx->getBelType(bel) == cell->type && check_cell_bel_region(ctx, cell, bel);
+    }
+
+    // Commit a set of moves, reverting them and returning false if the result is not legal. Cells keep their
+    // binding strength
+    bool apply_moves(const MoveSet &moves)
+    {
+        std::vector<std::tuple<CellInfo *, BelId, PlaceStrength>> old;
+        for (auto &mv : moves) {
+            old.emplace_back(mv.first, mv.first->bel, mv.first->belStrength);
+            ctx->unbindBel(mv.first->bel);
+        }
+        bool ok = true;
+        for (size_t i = 0; i < moves.size(); i++) {
+            auto &mv = moves.at(i);
+            if (!ctx->checkBelAvail(mv.second) || !ctx->isValidBelForCell(mv.first, mv.second)) {
+                ok = false;
+                break;
+            }
+            ctx->bindBel(mv.second, mv.first, std::get<2>(old.at(i)));
+        }
+        if (ok) {
+            for (auto &mv : moves)
+                if (!ctx->isBelLocationValid(mv.second)) {
+                    ok = false;
+                    break;
+                }
+            for (auto &o : old)
+                if (ok && !ctx->isBelLocationValid(std::get<1>(o)))
+                    ok = false;
+        }
+        if (ok)
+            return true;
+        for (auto &mv : moves)
+            if (mv.first->bel != BelId())
+                ctx->unbindBel(mv.first->bel);
+        for (auto &o : old)
+            ctx->bindBel(std::get<1>(o), std::get<0>(o), std::get<2>(o));
+        return false;
+    }
+
+    // Find the optimal region of a group of cells that move together, the median of the bounding boxes of their nets
+    // without the group itself. Returns false if the group has no nets, or cur is already inside the region
+    bool optimal_target(const std::vector<CellInfo *> &group, Loc cur, int &tx, int &ty) const
+    {
+        std::vector<int> xs, ys;
+        std::vector<const NetInfo *> nets;
+        cell_nets(group, nets);
+        for (auto ni : nets) {
+            int x0 = std::numeric_limits<int>::max(), x1 = std::numeric_limits<int>::min();
+            int y0 = x0, y1 = x1;
+            auto add_pin = [&](const CellInfo *other) {
+                if (other->bel == BelId() || std::find(group.begin(), group.end(), other) != group.end())
+                    return;
+                Loc l = ctx->getBelLocation(other->bel);
+                x0 = std::min(x0, l.x);
+                x1 = std::max(x1, l.x);
+                y0 = std::min(y0, l.y);
+                y1 = std::max(y1, l.y);
+            };
+            add_pin(ni->driver.cell);
+            for (auto &usr : ni->users)
+                add_pin(usr.cell);
+            if (x0 > x1)
+                continue;
+            xs.push_back(x0);
+            xs.push_back(x1);
+            ys.push_back(y0);
+            ys.push_back(y1);
+        }
+        if (xs.empty())
+            return false;
+        std::sort(xs.begin(), xs.end());
+        std::sort(ys.begin(), ys.end());
+        size_t k = xs.size() / 2;
+        int ox0 = xs.at(k - 1), ox1 = xs.at(k), oy0 = ys.at(k - 1), oy1 = ys.at(k);
+        if (cur.x >= ox0 && cur.x <= ox1 && cur.y >= oy0 && cur.y <= oy1)
+            return false;
+        tx = (ox0 + ox1) / 2;
+        ty = (oy0 + oy1) / 2;
+        return true;
+    }
+
+    // The cells of the macro rooted at root with their locations relative to it (x and y relative, z absolute), as
+    // used by placer1 for chains. Returns false if any cell of the macro can't be moved
+    bool macro_footprint(CellInfo *root, std::vector<std::pair<CellInfo *, Loc>> &footprint) const
+    {
+        footprint.clear();
+        Loc base = ctx->getBelLocation(root->bel);
+        std::vector<CellInfo *> visit{root};
+        while (!visit.empty()) {
+            CellInfo *ci = visit.back();
+            visit.pop_back();
+            if (ci->bel == BelId() || ci->belStrength > STRENGTH_WEAK || ctx->getBelGlobalBuf(ci->bel))
+                return false;
+            Loc l = ctx->getBelLocation(ci->bel);
+            footprint.emplace_back(ci, Loc(l.x - base.x, l.y - base.y, l.z));
+            for (auto child : ci->constr_children)
+                visit.push_back(child);
+        }
+        return true;
+    }
+
+    // The moves placing a macro with its root at base, swapping any single cells in the way into the bels the macro
+    // vacates. Returns false if the macro doesn't fit there
+    bool macro_moves(const std::vector<std::pair<CellInfo *, Loc>> &footprint, BelId base, MoveSet &moves) const
+    {
+        moves.clear();
+        Loc bl = ctx->getBelLocation(base);
+        std::vector<BelId> targets;
+        for (auto &fp : footprint) {
+            BelId target = ctx->getBelByLocation(Loc(bl.x + fp.second.x, bl.y + fp.second.y, fp.second.z));
+            if (target == BelId() || !valid_for(fp.first, target))
+                return false;
+            targets.push_back(target);
+        }
+        for (size_t i = 0; i < footprint.size(); i++) {
+            CellInfo *ci = footprint.at(i).first;
+            moves.emplace_back(ci, targets.at(i));
+            CellInfo *other = ctx->getBoundBelCell(targets.at(i));
+            bool in_macro = std::any_of(footprint.begin(), footprint.end(),
+                                        [&](const std::pair<CellInfo *, Loc> &fp) { return fp.first == other; });
+            if (other == nullptr || in_macro)
+                continue;
+            // The displaced cell takes this cell's old bel, which must not be claimed by the macro itself
+            if (!movable(other) || !valid_for(other, ci->bel) ||
+                std::find(targets.begin(), targets.end(), ci->bel) != targets.end())
+                return false;
+            moves.emplace_back(other, ci->bel);
+        }
+        return true;
+    }
+
+    // Move a macro as a unit towards the optimal region of its nets
+    bool move_macro(CellInfo *root)
+    {
+        std::vector<std::pair<CellInfo *, Loc>> footprint;
+        if (!macro_footprint(root, footprint))
+            return false;
+        std::vector<CellInfo *> group;
+        for (auto &fp : footprint)
+            group.push_back(fp.first);
+        Loc cur = ctx->getBelLocation(root->bel);
+        int tx, ty;
+        if (!optimal_target(group, cur, tx, ty))
+            return false;
+
+        auto &grid = bel_grid.at(root->type);
+        std::vector<CellInfo *> cells;
+        std::vector<const NetInfo *> nets;
+        MoveSet moves, best_moves;
+        wirelen_t best_delta = 0;
+        for (int x = std::max(0, tx - cfg.swapRadius); x <= std::min(max_x, tx + cfg.swapRadius); x++)
+            for (int y = std::max(0, ty - cfg.swapRadius); y <= std::min(max_y, ty + cfg.swapRadius); y++)
+                for (auto bel : grid.at(x).at(y)) {
+                    if (bel == root->bel || ctx->getBelLocation(bel).z != cur.z)
+                        continue;
+                    if (!macro_moves(footprint, bel, moves))
+                        continue;
+                    cells.clear();
+                    for (auto &mv : moves)
+                        cells.push_back(mv.first);
+                    cell_nets(cells, nets);
+                    wirelen_t delta = nets_hpwl(nets, moves) - nets_hpwl(nets, {});
+                    if (delta < best_delta) {
+                        best_delta = delta;
+                        best_moves = moves;
+                    }
+                }
+        return !best_moves.empty() && apply_moves(best_moves);
+    }
+
+    // Move each cell towards the optimal region of its nets. Macros (such as LUT/FF pairs and carry chains) are moved
+    // as a unit from their root
+    int global_swap()
+    {
+        int moved = 0;
+        std::vector<const NetInfo *> nets;
+        for (auto cell : sorted(ctx->cells)) {
+            CellInfo *ci = cell.second;
+            if (ci->bel == BelId() || !bel_grid.count(ci->type))
+                continue;
+            if (ci->constr_parent == nullptr && !ci->constr_children.empty()) {
+                if (move_macro(ci))
+                    ++moved;
+                continue;
+            }
+            if (!movable(ci))
+                continue;
+            int tx, ty;
+            if (!optimal_target({ci}, ctx->getBelLocation(ci->bel), tx, ty))
+                continue;
+
+            auto &grid = bel_grid.at(ci->type);
+            BelId best_bel;
+            wirelen_t best_delta = 0;
+            for (int x = std::max(0, tx - cfg.swapRadius); x <= std::min(max_x, tx + cfg.swapRadius); x++)
+                for (int y = std::max(0, ty - cfg.swapRadius); y <= std::min(max_y, ty + cfg.swapRadius); y++)
+                    for (auto bel : grid.at(x).at(y)) {
+                        if (bel == ci->bel || !valid_for(ci, bel))
+                            continue;
+                        CellInfo *other = ctx->getBoundBelCell(bel);
+                        if (other != nullptr && (!movable(other) || !valid_for(other, ci->bel)))
+                            continue;
+                        cell_nets({ci, other}, nets);
+                        MoveSet moves{{ci, bel}};
+                        if (other != nullptr)
+                            moves.emplace_back(other, ci->bel);
+                        wirelen_t delta = nets_hpwl(nets, moves) - nets_hpwl(nets, {});
+                        if (delta < best_delta) {
+                            best_delta = delta;
+                            best_bel = bel;
+                        }
+                    }
+            if (best_bel == BelId())
+                continue;
+            CellInfo *other = ctx->getBoundBelCell(best_bel);
+            MoveSet moves{{ci, best_bel}};
+            if (other != nullptr)
+                moves.emplace_back(other, ci->bel);
+            if (apply_moves(moves))
+                ++moved;
+        }
+        return moved;
+    }
+
+    // Try all orderings of three consecutive cells of the same type along a column (or row) over their bels
+    int local_reorder(bool vertical)
+    {
+        int reordered = 0;
+        // Cells by type and column (or row), ordered along it
+        std::map<std::pair<IdString, int>, std::vector<std::pair<Loc, CellInfo *>>> lines;
+        for (auto cell : sorted(ctx->cells)) {
+            CellInfo *ci = cell.second;
+            if (!movable(ci))
+                continue;
+            Loc l = ctx->getBelLocation(ci->bel);
+            lines[std::make_pair(ci->type, vertical ? l.x : l.y)].emplace_back(l, ci);
+        }
+        std::vector<const NetInfo *> nets;
+        for (auto &line : lines) {
+            auto &cells = line.second;
+            std::sort(cells.begin(), cells.end(), [&](const std::pair<Loc, CellInfo *> &a,
+                                                      const std::pair<Loc, CellInfo *> &b) {
+                int pa = vertical ? a.first.y : a.first.x, pb = vertical ? b.first.y : b.first.x;
+                return pa < pb || (pa == pb && a.first.z < b.first.z);
+            });
+            for (size_t i = 0; i + 3 <= cells.size(); i++) {
+                std::vector<CellInfo *> window{cells.at(i).second, cells.at(i + 1).second, cells.at(i + 2).second};
+                // Only neighbouring cells
+                int span = vertical ? (cells.at(i + 2).first.y - cells.at(i).first.y)
+                                    : (cells.at(i + 2).first.x - cells.at(i).first.x);
+                if (span > 2)
+                    continue;
+                std::vector<BelId> bels;
+                for (auto c : window)
+                    bels.push_back(c->bel);
+                cell_nets(window, nets);
+                wirelen_t base = nets_hpwl(nets, {}), best = base;
+                std::vector<int> perm{0, 1, 2}, best_perm = perm;
+                while (std::next_permutation(perm.begin(), perm.end())) {
+                    MoveSet moves;
+                    bool ok = true;
+                    for (int j = 0; j < 3; j++) {
+                        if (!valid_for(window.at(j), bels.at(perm.at(j))))
+                            ok = false;
+                        if (perm.at(j) != j)
+                            moves.emplace_back(window.at(j), bels.at(perm.at(j)));
+                    }
+                    if (!ok)
+                        continue;
+                    wirelen_t cost = nets_hpwl(nets, moves);
+                    if (cost < best) {
+                        best = cost;
+                        best_perm = perm;
+                    }
+                }
+                if (best == base)
+                    continue;
+                MoveSet moves;
+                for (int j = 0; j < 3; j++)
+                    if (best_perm.at(j) != j)
+                        moves.emplace_back(window.at(j), bels.at(best_perm.at(j)));
+                if (apply_moves(moves)) {
+                    ++reordered;
+                    // Keep the line consistent with the new locations
+                    for (int j = 0; j < 3; j++)
+                        cells.at(i + j) = std::make_pair(ctx->getBelLocation(window.at(j)->bel), window.at(j));
+                    std::sort(cells.begin() + i, cells.begin() + i + 3,
+                              [&](const std::pair<Loc, CellInfo *> &a, const std::pair<Loc, CellInfo *> &b) {
+                                  int pa = vertical ? a.first.y : a.first.x, pb = vertical ? b.first.y : b.first.x;
+                                  return pa < pb || (pa == pb && a.first.z < b.first.z);
+                              });
+                }
+            }
+        }
+        return reordered;
+    }
+
+    struct IsmWindow
+    {
+        IdString type;
+        // Extent of the window, clipped to the device at x0/y0 but not at x1/y1 (exclusive)
+        int x0, y0, x1, y1;
+        std::vector<CellInfo *> cells;
+        // Result: moves and their predicted change in wirelength
+        MoveSet moves;
+        wirelen_t delta = 0;
+    };
+
+    // Solve one window; only reads the current placement so windows can be solved concurrently
+    void solve_ism_window(IsmWindow &w) const
+    {
+        std::vector<CellInfo *> set;
+        std::vector<const NetInfo *> used_nets, nets;
+        for (auto cell : w.cells) {
+            if (int(set.size()) >= cfg.ismSetSize)
+                break;
+            cell_nets({cell}, nets);
+            bool independent = std::none_of(nets.begin(), nets.end(), [&](const NetInfo *ni) {
+                return std::find(used_nets.begin(), used_nets.end(), ni) != used_nets.end();
+            });
+            if (!independent)
+                continue;
+            set.push_back(cell);
+            used_nets.insert(used_nets.end(), nets.begin(), nets.end());
+        }
+        if (set.size() < 2)
+            return;
+        std::vector<BelId> bels;
+        for (auto cell : set)
+            bels.push_back(cell->bel);
+        auto &grid = bel_grid.at(w.type);
+        int free_bels = 0;
+        for (int x = w.x0; x < std::min(max_x + 1, w.x1) && free_bels < cfg.ismSetSize; x++)
+            for (int y = w.y0; y < std::min(max_y + 1, w.y1) && free_bels < cfg.ismSetSize; y++)
+                for (auto bel : grid.at(x).at(y))
+                    if (free_bels < cfg.ismSetSize && ctx->checkBelAvail(bel)) {
+                        bels.push_back(bel);
+                        ++free_bels;
+                    }
+
+        // As the cells share no nets, the cost of each cell at each bel is independent of the others
+        const double invalid = 1e12;
+        std::vector<std::vector<double>> cost(set.size(), std::vector<double>(bels.size(), 0));
+        wirelen_t base = 0;
+        for (size_t i = 0; i < set.size(); i++) {
+            cell_nets({set.at(i)}, nets);
+            base += nets_hpwl(nets, {});
+            for (size_t j = 0; j < bels.size(); j++)
+                cost.at(i).at(j) = valid_for(set.at(i), bels.at(j)) ? nets_hpwl(nets, {{set.at(i), bels.at(j)}})
+                                                                     : invalid;
+        }
+        auto assignment = solve_assignment(cost);
+        double total = 0;
+        for (size_t i = 0; i < set.size(); i++) {
+            total += cost.at(i).at(assignment.at(i));
+            if (bels.at(assignment.at(i)) != set.at(i)->bel)
+                w.moves.emplace_back(set.at(i), bels.at(assignment.at(i)));
+        }
+        w.delta = wirelen_t(total) - base;
+        if (total >= invalid || w.delta >= 0)
+            w.moves.clear();
+    }
+
+    int independent_set_match(int pass)
+    {
+        // Offset the window grid on alternate passes, so that cells can cross window boundaries
+        int offset = (pass % 2) ? cfg.ismWindow / 2 : 0;
+        std::map<std::tuple<IdString, int, int>, IsmWindow> window_map;
+        for (auto cell : sorted(ctx->cells)) {
+            CellInfo *ci = cell.second;
+            if (!movable(ci) || !bel_grid.count(ci->type))
+                continue;
+            Loc l = ctx->getBelLocation(ci->bel);
+            int wx = ((l.x + offset) / cfg.ismWindow) * cfg.ismWindow - offset;
+            int wy = ((l.y + offset) / cfg.ismWindow) * cfg.ismWindow - offset;
+            auto &w = window_map[std::make_tuple(ci->type, wx, wy)];
+            w.type = ci->type;
+            w.x0 = std::max(0, wx);
+            w.y0 = std::max(0, wy);
+            w.x1 = wx + cfg.ismWindow;
+            w.y1 = wy + cfg.ismWindow;
+            w.cells.push_back(ci);
+        }
+        std::vector<IsmWindow> windows;
+        for (auto &w : window_map)
+            if (w.second.cells.size() >= 2)
+                windows.push_back(std::move(w.second));
+
+        int nthreads = std::max(1, std::min<int>(cfg.threads, int(windows.size())));
+        std::vector<std::thread> workers;
+        for (int t = 0; t < nthreads; t++)
+            workers.emplace_back([&, t]() {
+                for (size_t i = t; i < windows.size(); i += nthreads)
+                    solve_ism_window(windows.at(i));
+            });
+        for (auto &th : workers)
+            th.join();
+
+        int matched = 0;
+        std::vector<CellInfo *> cells;
+        std::vector<const NetInfo *> nets;
+        for (auto &w : windows) {
+            if (w.moves.empty())
+                continue;
+            // Earlier windows may have moved other pins of these nets, so check the gain again before committing
+            cells.clear();
+            for (auto &mv : w.moves)
+                cells.push_back(mv.first);
+            cell_nets(cells, nets);
+            if (nets_hpwl(nets, w.moves) >= nets_hpwl(nets, {}))
+                continue;
+            if (apply_moves(w.moves))
+                matched += int(w.moves.size());
+        }
+        return matched;
+    }
+};
+
+DetailPlaceCfg::DetailPlaceCfg(Context *ctx)
+{
+    hpwl_scale_x = 1;
+    hpwl_scale_y = 1;
+    maxFanout = ctx->setting<int>("placerDetail/maxFanout", 64);
+    passes = ctx->setting<int>("placerDetail/passes", 5);
+    swapRadius = ctx->setting<int>("placerDetail/swapRadius", 1);
+    ismWindow = ctx->setting<int>("placerDetail/ismWindow", 4);
+    ismSetSize = ctx->setting<int>("placerDetail/ismSetSize", 16);
+    threads = ctx->setting<int>("placerDetail/threads", std::max<int>(1, std::thread::hardware_concurrency()));
+}
+
+bool detail_place(Context *ctx, DetailPlaceCfg cfg)
+{
+    try {
+        DetailPlacer(ctx, cfg).place();
+#ifndef NDEBUG
+        ctx->lock();
+        ctx->check();
+        ctx->unlock();
+#endif
+        return true;
+    } catch (log_execution_error_exception) {
+        return false;
+    }
+}
+
+NEXTPNR_NAMESPACE_END
@@ -0,0 +1,52 @@
+/*
+ *  nextpnr -- Next Generation Place and Route
+ *
+ *  Copyright (C) 2026  agent <agent@local>
+ *
+ *  Permission to use, copy, modify, and/or distribute this software for any
+ *  purpose with or without fee is hereby granted, provided that the above
+ *  copyright notice and this permission notice appear in all copies.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ *  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ *  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ *  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ *  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ *  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ *  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ */
+
+#ifndef DETAIL_PLACE_H
+#define DETAIL_PLACE_H
+
+#include "log.h"
+#include "nextpnr.h"
+
+NEXTPNR_NAMESPACE_BEGIN
+
+struct DetailPlaceCfg
+{
+    DetailPlaceCfg(Context *ctx);
+
+    int hpwl_scale_x, hpwl_scale_y;
+    // Nets with more users than this are ignored, as moving a single cell barely changes their wirelength
+    int maxFanout;
+    // Number of passes of global swap, local reordering and independent set matching
+    int passes;
+    // Global swap considers bels within this many tiles of a cell's optimal location
+    int swapRadius;
+    // Size in tiles of the windows used for independent set matching, and the maximum number of cells matched at
+    // once in a window
+    int ismWindow, ismSetSize;
+    // Number of threads used to solve independent set matching windows
+    int threads;
+};
+
+// Fast local improvement of a legal placement. Only cells bound with STRENGTH_WEAK or lower are moved, with chains
+// and other macros moved as a unit by global swap; all moves are checked with isBelLocationValid
+extern bool detail_place(Context *ctx, DetailPlaceCfg cfg);
+
+NEXTPNR_NAMESPACE_END
+
+#endif
@@ -0,0 +1,157 @@
+/*
+ *  nextpnr -- Next Generation Place and Route
+ *
+ *  Copyright (C) 2026  agent <agent@local>
+ *
+ *  Permission to use, copy, modify, and/or distribute this software for any
+ *  purpose with or without fee is hereby granted, provided that the above
+ *  copyright notice and this permission notice appear in all copies.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ *  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ *  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ *  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ *  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ *  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ *  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ */
+
+#include "electrostatics.h"
+#include <cmath>
+#include "log.h"
+
+NEXTPNR_NAMESPACE_BEGIN
+
+void fft(std::vector<std::complex<double>> &a, bool inverse)
+{
+    size_t n = a.size();
+    NPNR_ASSERT((n & (n - 1)) == 0);
+    // Bit reversal permutation
+    for (size_t i = 1, j = 0; i < n; i++) {
+        size_t bit = n >> 1;
+        for (; j & bit; bit >>= 1)
+            j ^= bit;
+        j ^= bit;
+        if (i < j)
+            std::swap(a[i], a[j]);
+    }
+    for (size_t len = 2; len <= n; len <<= 1) {
+        double ang = 2 * M_PI / len * (inverse ? 1 : -1);
+        std::complex<double> wlen(std::cos(ang), std::sin(ang));
+        for (size_t i = 0; i < n; i += len) {
+            std::complex<double> w(1);
+            for (size_t j = 0; j < len / 2; j++) {
+                std::complex<double> u = a[i + j], v = a[i + j + len / 2] * w;
+                a[i + j] = u + v;
+                a[i + j + len / 2] = u - v;
+                w *= wlen;
+            }
+        }
+    }
+}
+
+// Both transforms are computed with a zero-padded FFT of twice the length, which keeps the index arithmetic simple
+// at the cost of a factor of two in runtime
+
+void dct2(const std::vector<double> &x, std::vector<double> &a)
+{
+    size_t n = x.size();
+    std::vector<std::complex<double>> buf(2 * n);
+    for (size_t i = 0; i < n; i++)
+        buf[i] = x[i];
+    fft(buf, false);
+    a.resize(n);
+    for (size_t k = 0; k < n; k++)
+        a[k] = (buf[k] * std::polar(1.0, -M_PI * k / (2.0 * n))).real();
+}
+
+void idct_idst(const std::vector<double> &a, std::vector<double> *c, std::vector<double> *s)
+{
+    size_t n = a.size();
+    std::vector<std::complex<double>> buf(2 * n);
+    for (size_t k = 0; k < n; k++)
+        buf[k] = a[k] * std::polar(1.0, M_PI * k / (2.0 * n));
+    fft(buf, true);
+    if (c != nullptr) {
+        c->resize(n);
+        for (size_t i = 0; i < n; i++)
+            (*c)[i] = buf[i].real();
+    }
+    if (s != nullptr) {
+        s->resize(n);
+        for (size_t i = 0; i < n; i++)
+            (*s)[i] = buf[i].imag();
+    }
+}
+
+ElectrostaticField::ElectrostaticField(int width, int height) : width(width), height(height)
+{
+    NPNR_ASSERT(width > 0 && (width & (width - 1)) == 0);
+    NPNR_ASSERT(height > 0 && (height & (height - 1)) == 0);
+    density.resize(width * height, 0.0);
+    potential.resize(width * height, 0.0);
+    field_x.resize(width * height, 0.0);
+    field_y.resize(width * height, 0.0);
+}
+
+namespace {
+// Apply a 1D transform along y (for every x) and then along x (for every y)
+template <typename Ty, typename Tx> void transform_2d(std::vector<double> &data, int width, int height, Ty fy, Tx fx)
+{
+    std::vector<double> in, out;
+    for (int x = 0; x < width; x++) {
+        in.assign(data.begin() + x * height, data.begin() + (x + 1) * height);
+        fy(in, out);
+        std::copy(out.begin(), out.end(), data.begin() + x * height);
+    }
+    in.resize(width);
+    for (int y = 0; y < height; y++) {
+        for (int x = 0; x < width; x++)
+            in[x] = data[x * height + y];
+        fx(in, out);
+        for (int x = 0; x < width; x++)
+            data[x * height + y] = out[x];
+    }
+}
+
+void inv_cos(const std::vector<double> &in, std::vector<double> &out) { idct_idst(in, &out, nullptr); }
+void inv_sin(const std::vector<double> &in, std::vector<double> &out) { idct_idst(in, nullptr, &out); }
+} // namespace
+
+void ElectrostaticField::solve()
+{
+    std::vector<double> coeff = density;
+    transform_2d(coeff, width, height, dct2, dct2);
+    for (int u = 0; u < width; u++) {
+        double wu = M_PI * u / width;
+        for (int v = 0; v < height; v++) {
+            double wv = M_PI * v / height;
+            int idx = u * height + v;
+            // Normalisation of the inverse transform
+            double scale = (u == 0 ? 1.0 : 2.0) / width * (v == 0 ? 1.0 : 2.0) / height;
+            if (u == 0 && v == 0) {
+                // The mean charge is dropped, so that the system is neutral
+                potential[idx] = field_x[idx] = field_y[idx] = 0;
+                continue;
+            }
+            double a = coeff[idx] * scale / (wu * wu + wv * wv);
+            potential[idx] = a;
+            field_x[idx] = a * wu;
+            field_y[idx] = a * wv;
+        }
+    }
+    transform_2d(potential, width, height, inv_cos, inv_cos);
+    transform_2d(field_x, width, height, inv_cos, inv_sin);
+    transform_2d(field_y, width, height, inv_sin, inv_cos);
+}
+
+double ElectrostaticField::energy() const
+{
+    double total = 0;
+    for (size_t i = 0; i < density.size(); i++)
+        total += density[i] * potential[i];
+    return total / 2;
+}
+
+NEXTPNR_NAMESPACE_END
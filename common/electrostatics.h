@@ -0,0 +1,64 @@
+/*
+ *  nextpnr -- Next Generation Place and Route
+ *
+ *  Copyright (C) 2026  agent <agent@local>
+ *
+ *  Permission to use, copy, modify, and/or distribute this software for any
+ *  purpose with or without fee is hereby granted, provided that the above
+ *  copyright notice and this permission notice appear in all copies.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ *  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ *  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ *  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ *  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ *  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ *  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ *  [[cite]] ePlace
+ *  ePlace: Electrostatics-Based Placement Using Fast Fourier Transform and Nesterov's Method,
+ *  Jingwei Lu, Pengwen Chen, Chin-Chih Chang, Lu Sha, Dennis Jen-Hsin Huang, Chin-Chi Teng and Chung-Kuan Cheng
+ *  https://cseweb.ucsd.edu/~jlu/papers/eplace-todaes14/paper.pdf
+ *
+ */
+
+#ifndef ELECTROSTATICS_H
+#define ELECTROSTATICS_H
+
+#include <complex>
+#include <vector>
+#include "nextpnr.h"
+
+NEXTPNR_NAMESPACE_BEGIN
+
+// In-place radix-2 FFT, the size of a must be a power of two. The inverse transform is not normalised
+void fft(std::vector<std::complex<double>> &a, bool inverse);
+
+// a[k] = sum_n x[n] cos(pi k (n + 1/2) / N), the size of x must be a power of two
+void dct2(const std::vector<double> &x, std::vector<double> &a);
+
+// c[n] = sum_k a[k] cos(pi k (n + 1/2) / N) and s[n] = sum_k a[k] sin(pi k (n + 1/2) / N); either output may be
+// null
+void idct_idst(const std::vector<double> &a, std::vector<double> *c, std::vector<double> *s);
+
+// Solution of Poisson's equation -laplace(psi) = rho over a rectangular grid of bins with Neumann boundary
+// conditions, as used for the density penalty of the electrostatic placer. Bin (x, y) is at index x * height + y
+// and both dimensions must be powers of two
+struct ElectrostaticField
+{
+    ElectrostaticField(int width, int height);
+
+    int width, height;
+    // Charge density of each bin, set by the caller before solve()
+    std::vector<double> density;
+    // Outputs: potential and electric field (E = -grad psi) at the centre of each bin
+    std::vector<double> potential, field_x, field_y;
+
+    void solve();
+    // Total energy 1/2 * sum(rho * psi)
+    double energy() const;
+};
+
+NEXTPNR_NAMESPACE_END
+
+#endif
@@ -19,12 +19,80 @@
 
 #include "nextpnr.h"
 #include <boost/algorithm/string.hpp>
+#include <thread>
 #include "design_utils.h"
 #include "log.h"
 #include "util.h"
 
 NEXTPNR_NAMESPACE_BEGIN
 
+namespace {
+// Run fn(i) for every i in [0, count), split into contiguous ranges over worker threads if threaded
+template <typename Func> void parallel_for(int count, bool threaded, Func fn)
+{
+    int nthreads = threaded ? std::max(1, std::min<int>(std::thread::hardware_concurrency(), count / 1024)) : 1;
+    if (nthreads == 1) {
+        for (int i = 0; i < count; i++)
+            fn(i);
+        return;
+    }
+    std::vector<std::thread> workers;
+    for (int t = 0; t < nthreads; t++)
+        workers.emplace_back([&, t]() {
+            for (int i = (count * int64_t(t)) / nthreads; i < (count * int64_t(t + 1)) / nthreads; i++)
+                fn(i);
+        });
+    for (auto &th : workers)
+        th.join();
+}
+
+// Wire and pip names as strings. Arches with Arch::threadsafe_names can name wires and pips, and find them by name,
+// without interning the names; so routing can be converted to and from strings on several threads
+template <bool threadsafe> struct RoutingNames
+{
+    template <typename Ctx> static void setup(const Ctx *) {}
+    template <typename Ctx> static std::string wire_name(const Ctx *ctx, WireId wire)
+    {
+        return ctx->getWireName(wire).str(ctx);
+    }
+    template <typename Ctx> static std::string pip_name(const Ctx *ctx, PipId pip)
+    {
+        return ctx->getPipName(pip).str(ctx);
+    }
+    template <typename Ctx> static WireId wire_by_name(const Ctx *ctx, const std::string &name)
+    {
+        return ctx->getWireByName(ctx->id(name));
+    }
+    template <typename Ctx> static PipId pip_by_name(const Ctx *ctx, const std::string &name)
+    {
+        return ctx->getPipByName(ctx->id(name));
+    }
+};
+
+template <> struct RoutingNames<true>
+{
+    template <typename Ctx> static void setup(const Ctx *ctx) { ctx->setup_byname(); }
+    template <typename Ctx> static std::string wire_name(const Ctx *ctx, WireId wire)
+    {
+        return ctx->getWireNameString(wire);
+    }
+    template <typename Ctx> static std::string pip_name(const Ctx *ctx, PipId pip)
+    {
+        return ctx->getPipNameString(pip);
+    }
+    template <typename Ctx> static WireId wire_by_name(const Ctx *ctx, const std::string &name)
+    {
+        return ctx->getWireByNameString(name);
+    }
+    template <typename Ctx> static PipId pip_by_name(const Ctx *ctx, const std::string &name)
+    {
+        return ctx->getPipByNameString(name);
+    }
+};
+
+typedef RoutingNames<Arch::threadsafe_names> ArchRoutingNames;
+} // namespace
+
 assertion_failure::assertion_failure(std::string msg, std::string expr_str, std::string filename, int line)
         : runtime_error("Assertion failure: " + msg + " (" + filename + ":" + std::to_string(line) + ")"), msg(msg),
           expr_str(expr_str), filename(filename), line(line)
@@ -137,18 +205,129 @@ TimingConstrObjectId BaseCtx::timingPortObject(CellInfo *cell, IdString port)
     }
 }
 
-Property::Property() : is_string(false), str(""), intval(0) {}
+Property::Property() : is_string(false) {}
 
-Property::Property(int64_t intval, int width) : is_string(false), intval(intval)
+Property::Property(int64_t intval, int width) : is_string(false)
 {
-    str.reserve(width);
-    for (int i = 0; i < width; i++)
-        str.push_back((intval & (1ULL << i)) ? S1 : S0);
+    resize(width);
+    if (width > 0)
+        value0 = uint64_t(intval);
+    mask_top();
 }
 
-Property::Property(const std::string &strval) : is_string(true), str(strval), intval(0xDEADBEEF) {}
+Property::Property(const std::string &strval) : is_string(true), str(strval) {}
+
+Property::Property(State bit) : is_string(false)
+{
+    resize(1);
+    set_bit(0, bit);
+}
+
+void Property::set_bit(int i, State bit)
+{
+    NPNR_ASSERT(!is_string && i >= 0 && i < width);
+    NPNR_ASSERT(bit == S0 || bit == S1 || bit == Sx || bit == Sz);
+    uint64_t mask = 1ULL << (i % 64);
+    uint64_t &v = word_ref(i / 64, false), &u = word_ref(i / 64, true);
+    v = (bit == S1 || bit == Sz) ? (v | mask) : (v & ~mask);
+    u = (bit == Sx || bit == Sz) ? (u | mask) : (u & ~mask);
+}
+
+void Property::resize(int new_width, State padding)
+{
+    NPNR_ASSERT(!is_string && new_width >= 0);
+    int old_width = width;
+    width = new_width;
+    ext_words.resize(2 * std::max(0, num_words() - 1), 0);
+    if (new_width < old_width) {
+        mask_top();
+        return;
+    }
+    if (padding == S0) // new words are already zero, and bits above the old width were cleared by mask_top
+        return;
+    for (int i = old_width; i < new_width; i++)
+        set_bit(i, padding);
+}
+
+void Property::mask_top()
+{
+    if (width == 0)
+        value0 = undef0 = 0;
+    if (width % 64 == 0)
+        return;
+    uint64_t mask = (1ULL << (width % 64)) - 1;
+    word_ref(num_words() - 1, false) &= mask;
+    word_ref(num_words() - 1, true) &= mask;
+}
+
+uint64_t Property::get_bits(int offset, bool undef) const
+{
+    if (offset >= width || offset < 0)
+        return 0;
+    int w = offset / 64, sh = offset % 64;
+    uint64_t lo = undef ? undef_word(w) : value_word(w);
+    if (sh == 0)
+        return lo;
+    uint64_t hi = (w + 1 < num_words()) ? (undef ? undef_word(w + 1) : value_word(w + 1)) : 0;
+    return (lo >> sh) | (hi << (64 - sh));
+}
+
+std::vector<bool> Property::as_bits() const
+{
+    NPNR_ASSERT(is_fully_def());
+    std::vector<bool> result(width);
+    for (int w = 0; w < num_words(); w++) {
+        uint64_t v = value_word(w);
+        for (int i = 0; i < 64 && (w * 64 + i) < width; i++)
+            result[w * 64 + i] = (v >> i) & 1;
+    }
+    return result;
+}
+
+bool Property::as_bool() const
+{
+    for (int w = 0; w < num_words(); w++)
+        if (value_word(w) & ~undef_word(w))
+            return true;
+    return false;
+}
+
+bool Property::is_fully_def() const
+{
+    if (is_string)
+        return false;
+    for (int w = 0; w < num_words(); w++)
+        if (undef_word(w) != 0)
+            return false;
+    return true;
+}
+
+Property Property::extract(int offset, int len, State padding) const
+{
+    NPNR_ASSERT(!is_string);
+    Property ret;
+    ret.resize(len);
+    for (int w = 0; w < ret.num_words(); w++) {
+        ret.word_ref(w, false) = get_bits(offset + 64 * w, false);
+        ret.word_ref(w, true) = get_bits(offset + 64 * w, true);
+    }
+    // Bits beyond the end of this value take the padding state
+    int avail = std::max(0, std::min(len, width - offset));
+    if (padding != S0)
+        for (int i = avail; i < len; i++)
+            ret.set_bit(i, padding);
+    ret.mask_top();
+    return ret;
+}
 
-Property::Property(State bit) : is_string(false), str(std::string("") + char(bit)), intval(bit == S1) {}
+std::string Property::bit_str() const
+{
+    NPNR_ASSERT(!is_string);
+    std::string result(width, S0);
+    for (int i = 0; i < width; i++)
+        result[i] = get_bit(i);
+    return result;
+}
 
 void CellInfo::addInput(IdString name)
 {
@@ -191,7 +370,15 @@ std::string Property::to_string() const
             result += " ";
         return result;
     } else {
-        return std::string(str.rbegin(), str.rend());
+        std::string result(width, S0);
+        for (int w = 0; w < num_words(); w++) {
+            uint64_t v = value_word(w), u = undef_word(w);
+            for (int i = 0; i < 64 && (w * 64 + i) < width; i++) {
+                bool vb = (v >> i) & 1, ub = (u >> i) & 1;
+                result[width - 1 - (w * 64 + i)] = ub ? (vb ? Sz : Sx) : (vb ? S1 : S0);
+            }
+        }
+        return result;
     }
 }
 
@@ -201,9 +388,19 @@ Property Property::from_string(const std::string &s)
 
     size_t cursor = s.find_first_not_of("01xz");
     if (cursor == std::string::npos) {
-        p.str = std::string(s.rbegin(), s.rend());
-        p.is_string = false;
-        p.update_intval();
+        // Pack the bits straight into words, the string is most significant bit first
+        int width = int(s.size());
+        p.resize(width);
+        for (int i = 0; i < width; i++) {
+            char c = s[width - 1 - i];
+            if (c == S0)
+                continue;
+            uint64_t mask = 1ULL << (i % 64);
+            if (c == S1 || c == Sz)
+                p.word_ref(i / 64, false) |= mask;
+            if (c == Sx || c == Sz)
+                p.word_ref(i / 64, true) |= mask;
+        }
     } else if (s.find_first_not_of(' ', cursor) == std::string::npos) {
         p = Property(s.substr(0, s.size() - 1));
     } else {
@@ -260,6 +457,113 @@ const char *BaseCtx::nameOfGroup(GroupId group) const
     return ctx->getGroupName(group).c_str(ctx);
 }
 
+namespace {
+bool in_region_rects(const Context *ctx, const Region *region, BelId bel)
+{
+    if (region->tile_mask.empty())
+        return false;
+    Loc loc = ctx->getBelLocation(bel);
+    return region->tile_mask.at(loc.y * region->mask_width + loc.x) &&
+           (region->bel_types.empty() || region->bel_types.count(ctx->getBelType(bel)));
+}
+} // namespace
+
+bool Context::isBelInRegion(const Region *region, BelId bel) const
+{
+    if (bel == BelId())
+        return false;
+    return in_region_rects(this, region, bel) || (!region->bels.empty() && region->bels.count(bel));
+}
+
+const std::vector<BelId> &Context::getRegionBels(Region *region, IdString type) const
+{
+    auto found = region->bels_by_type.find(type);
+    if (found != region->bels_by_type.end())
+        return found->second;
+    std::vector<BelId> &result = region->bels_by_type[type];
+    if (!region->tile_mask.empty()) {
+        int height = int(region->tile_mask.size()) / region->mask_width;
+        for (int y = 0; y < height; y++)
+            for (int x = 0; x < region->mask_width; x++) {
+                if (!region->tile_mask.at(y * region->mask_width + x))
+                    continue;
+                for (auto bel : getBelsByTile(x, y)) {
+                    IdString bel_type = getBelType(bel);
+                    if ((type == IdString() || bel_type == type) &&
+                        (region->bel_types.empty() || region->bel_types.count(bel_type)))
+                        result.push_back(bel);
+                }
+            }
+    }
+    for (auto bel : region->bels)
+        if ((type == IdString() || getBelType(bel) == type) && !in_region_rects(this, region, bel))
+            result.push_back(bel);
+    return result;
+}
+
+const Region *Context::getNetRoutingRegion(const NetInfo *net) const
+{
+    if (net->driver.cell == nullptr)
+        return nullptr;
+    const Region *r = net->driver.cell->region;
+    if (r == nullptr || (!r->constr_pips && !r->constr_wires))
+        return nullptr;
+    for (auto &usr : net->users)
+        if (usr.cell->region != r)
+            return nullptr;
+    return r;
+}
+
+void Context::prepareRegionRouting()
+{
+    int width = getGridDimX(), height = getGridDimY();
+    for (auto &r : region) {
+        Region *ri = r.second.get();
+        if (!ri->constr_pips)
+            continue;
+        if (ri->tile_mask.empty()) {
+            ri->mask_width = width;
+            ri->routing_mask.assign(width * height, false);
+        } else {
+            ri->routing_mask = ri->tile_mask;
+        }
+        for (auto loc : ri->piplocs)
+            if (loc.x >= 0 && loc.x < width && loc.y >= 0 && loc.y < height)
+                ri->routing_mask[loc.y * width + loc.x] = true;
+    }
+}
+
+bool Context::isPipInRegion(const Region *region, PipId pip) const
+{
+    if (region->constr_pips) {
+        Loc loc = getPipLocation(pip);
+        if (!region->routing_mask[loc.y * region->mask_width + loc.x])
+            return false;
+    }
+    return !region->constr_wires || region->wires.count(getPipDstWire(pip));
+}
+
+int Context::checkRegionRouting() const
+{
+    int violations = 0;
+    for (auto net : sorted(nets)) {
+        const NetInfo *ni = net.second;
+        const Region *r = getNetRoutingRegion(ni);
+        if (r == nullptr)
+            continue;
+        for (auto &wire : ni->wires) {
+            PipId pip = wire.second.pip;
+            if (pip == PipId() || isPipInRegion(r, pip))
+                continue;
+            log_warning("net '%s' is constrained to region '%s', but uses pip %s outside of it\n", nameOf(ni),
+                        nameOf(r->name), nameOfPip(pip));
+            ++violations;
+            break;
+        }
+    }
+    return violations;
+}
+
 WireId Context::getNetinfoSourceWire(const NetInfo *net_info) const
 {
     if (net_info->driver.cell == nullptr)
@@ -369,7 +673,7 @@ uint32_t Context::checksum() const
         for (auto &a : ni.attrs) {
             uint32_t attr_x = 123456789;
             attr_x = xorshift32(attr_x + xorshift32(a.first.index));
-            for (char ch : a.second.str)
+            for (char ch : a.second.is_string ? a.second.str : a.second.bit_str())
                 attr_x = xorshift32(attr_x + xorshift32((int)ch));
             attr_x_sum += attr_x;
         }
@@ -413,7 +717,7 @@ uint32_t Context::checksum() const
         for (auto &a : ci.attrs) {
             uint32_t attr_x = 123456789;
             attr_x = xorshift32(attr_x + xorshift32(a.first.index));
-            for (char ch : a.second.str)
+            for (char ch : a.second.is_string ? a.second.str : a.second.bit_str())
                 attr_x = xorshift32(attr_x + xorshift32((int)ch));
             attr_x_sum += attr_x;
         }
@@ -423,7 +727,7 @@ uint32_t Context::checksum() const
         for (auto &p : ci.params) {
             uint32_t param_x = 123456789;
             param_x = xorshift32(param_x + xorshift32(p.first.index));
-            for (char ch : p.second.str)
+            for (char ch : p.second.is_string ? p.second.str : p.second.bit_str())
                 param_x = xorshift32(param_x + xorshift32((int)ch));
             param_x_sum += param_x;
         }
@@ -518,15 +822,25 @@ void BaseCtx::createRectangularRegion(IdString name, int x0, int y0, int x1, int
     new_region->constr_bels = true;
     new_region->constr_pips = false;
     new_region->constr_wires = false;
-    for (int x = x0; x <= x1; x++) {
-        for (int y = y0; y <= y1; y++) {
-            for (auto bel : getCtx()->getBelsByTile(x, y))
-                new_region->bels.insert(bel);
-        }
-    }
+    new_region->rects.emplace_back(x0, y0, x1, y1);
+    int width = getCtx()->getGridDimX(), height = getCtx()->getGridDimY();
+    new_region->mask_width = width;
+    new_region->tile_mask.resize(width * height, false);
+    for (int x = std::max(x0, 0); x <= std::min(x1, width - 1); x++)
+        for (int y = std::max(y0, 0); y <= std::min(y1, height - 1); y++)
+            new_region->tile_mask.at(y * width + x) = true;
     region[name] = std::move(new_region);
 }
-void BaseCtx::addBelToRegion(IdString name, BelId bel) { region[name]->bels.insert(bel); }
+void BaseCtx::addBelToRegion(IdString name, BelId bel)
+{
+    region[name]->bels.insert(bel);
+    region[name]->bels_by_type.clear();
+}
+void BaseCtx::addRegionBelType(IdString name, IdString type)
+{
+    region.at(name)->bel_types.insert(type);
+    region.at(name)->bels_by_type.clear();
+}
 void BaseCtx::constrainCellToRegion(IdString cell, IdString region_name)
 {
     // Support hierarchical cells as well as leaf ones
@@ -580,22 +894,30 @@ void BaseCtx::archInfoToAttributes()
             ci->attrs[id("CONSTR_CHILDREN")] = constr;
         }
     }
-    for (auto &net : getCtx()->nets) {
-        auto ni = net.second.get();
+    std::vector<NetInfo *> net_list;
+    net_list.reserve(nets.size());
+    for (auto &net : nets)
+        net_list.push_back(net.second.get());
+    IdString routing_id = id("ROUTING");
+    const Context *ctx = getCtx();
+    parallel_for(int(net_list.size()), Arch::threadsafe_names, [&](int i) {
+        NetInfo *ni = net_list.at(i);
         std::string routing;
+        routing.reserve(ni->wires.size() * 64);
         bool first = true;
         for (auto &item : ni->wires) {
             if (!first)
-                routing += ";";
-            routing += getCtx()->getWireName(item.first).c_str(this);
-            routing += ";";
+                routing += ';';
+            routing += ArchRoutingNames::wire_name(ctx, item.first);
+            routing += ';';
             if (item.second.pip != PipId())
-                routing += getCtx()->getPipName(item.second.pip).c_str(this);
-            routing += ";" + std::to_string(item.second.strength);
+                routing += ArchRoutingNames::pip_name(ctx, item.second.pip);
+            routing += ';';
+            routing += std::to_string(item.second.strength);
             first = false;
         }
-        ni->attrs[id("ROUTING")] = routing;
-    }
+        ni->attrs[routing_id] = routing;
+    });
 }
 
 void BaseCtx::attributesToArchInfo()
@@ -655,22 +977,75 @@ void BaseCtx::attributesToArchInfo()
             }
         }
     }
-    for (auto &net : getCtx()->nets) {
-        auto ni = net.second.get();
-        auto val = ni->attrs.find(id("ROUTING"));
-        if (val != ni->attrs.end()) {
-            std::vector<std::string> strs;
-            auto routing = val->second.as_string();
-            boost::split(strs, routing, boost::is_any_of(";"));
-            for (size_t i = 0; i < strs.size() / 3; i++) {
-                std::string wire = strs[i * 3];
-                std::string pip = strs[i * 3 + 1];
-                PlaceStrength strength = (PlaceStrength)std::stoi(strs[i * 3 + 2]);
-                if (pip.empty())
-                    getCtx()->bindWire(getCtx()->getWireByName(id(wire)), ni, strength);
-                else
-                    getCtx()->bindPip(getCtx()->getPipByName(id(pip)), ni, strength);
+    std::vector<NetInfo *> net_list;
+    std::vector<const std::string *> routing_str;
+    IdString routing_id = id("ROUTING");
+    for (auto &net : nets) {
+        auto val = net.second->attrs.find(routing_id);
+        if (val != net.second->attrs.end()) {
+            net_list.push_back(net.second.get());
+            routing_str.push_back(&val->second.str);
+            NPNR_ASSERT(val->second.is_string);
+        }
+    }
+
+    // Names are resolved in parallel, and the routing is then bound in the original order
+    struct RoutingItem
+    {
+        WireId wire;
+        PipId pip;
+        PlaceStrength strength;
+        size_t name_begin, name_end;
+    };
+    std::vector<std::vector<RoutingItem>> routing(net_list.size());
+    const Context *ctx = getCtx();
+    ArchRoutingNames::setup(ctx);
+    parallel_for(int(net_list.size()), Arch::threadsafe_names, [&](int i) {
+        // The attribute is a flat list of (wire; pip; strength) triples, separated by semicolons
+        const std::string &str = *routing_str.at(i);
+        size_t pos = 0;
+        auto next_field = [&](size_t &begin, size_t &end) {
+            if (pos > str.size())
+                return false;
+            begin = pos;
+            end = str.find(';', pos);
+            if (end == std::string::npos)
+                end = str.size();
+            pos = end + 1;
+            return true;
+        };
+        std::string name;
+        size_t wire_begin, wire_end, pip_begin, pip_end, str_begin, str_end;
+        while (next_field(wire_begin, wire_end) && next_field(pip_begin, pip_end) && next_field(str_begin, str_end)) {
+            RoutingItem item;
+            item.strength = PlaceStrength(std::strtol(str.c_str() + str_begin, nullptr, 10));
+            if (pip_begin == pip_end) {
+                name.assign(str, wire_begin, wire_end - wire_begin);
+                item.wire = ArchRoutingNames::wire_by_name(ctx, name);
+                item.name_begin = wire_begin;
+                item.name_end = wire_end;
+            } else {
+                name.assign(str, pip_begin, pip_end - pip_begin);
+                item.pip = ArchRoutingNames::pip_by_name(ctx, name);
+                item.name_begin = pip_begin;
+                item.name_end = pip_end;
             }
+            routing.at(i).push_back(item);
+        }
+    });
+
+    for (size_t i = 0; i < net_list.size(); i++) {
+        NetInfo *ni = net_list.at(i);
+        for (auto &item : routing.at(i)) {
+            bool is_pip = (item.wire == WireId());
+            if (is_pip && item.pip == PipId())
+                log_error("unknown wire or pip '%s' in routing of net '%s'\n",
+                          routing_str.at(i)->substr(item.name_begin, item.name_end - item.name_begin).c_str(),
+                          ni->name.c_str(this));
+            if (is_pip)
+                getCtx()->bindPip(item.pip, ni, item.strength);
+            else
+                getCtx()->bindWire(item.wire, ni, item.strength);
         }
     }
     getCtx()->assignArchInfo();
@@ -284,9 +284,23 @@ struct Region
     bool constr_wires = false;
     bool constr_pips = false;
 
+    // The bels of a region are those in its rectangles of tiles (with inclusive bounds), only of the types in
+    // bel_types if that isn't empty, together with any bels added individually. Use Context::isBelInRegion and
+    // Context::getRegionBels rather than the members to find them
+    std::vector<ArcBounds> rects;
+    std::unordered_set<IdString> bel_types;
     std::unordered_set<BelId> bels;
     std::unordered_set<WireId> wires;
     std::unordered_set<Loc> piplocs;
+
+    // Which tiles are covered by rects, indexed by y * mask_width + x
+    std::vector<bool> tile_mask;
+    int mask_width = 0;
+    // Bels of each type in the region (all bels for the empty IdString), built on demand
+    std::unordered_map<IdString, std::vector<BelId>> bels_by_type;
+    // With constr_pips, the tiles whose pips nets inside the region may use: those covered by rects, and piplocs.
+    // Built by Context::prepareRegionRouting, with the same indexing as tile_mask
+    std::vector<bool> routing_mask;
 };
 
 enum PlaceStrength
@@ -330,36 +344,32 @@ struct Property
 
     bool is_string;
 
-    // The string literal (for string values), or a string of [01xz] (for numeric values)
+    // The string literal (for string values)
     std::string str;
-    // The lower 64 bits (for numeric values), unused for string values
-    int64_t intval;
 
-    void update_intval()
+    // Numeric values are stored as two planes of bits, packed 64 to a word. Bits that are clear in the undef plane
+    // are 0 or 1 according to the value plane; bits that are set are x (value 0) or z (value 1). The first word of
+    // each plane is stored inline, and the remainder as pairs of (value, undef) words in ext_words
+    int num_words() const { return (width + 63) / 64; }
+    uint64_t value_word(int w) const { return (w == 0) ? value0 : ext_words.at(2 * (w - 1)); }
+    uint64_t undef_word(int w) const { return (w == 0) ? undef0 : ext_words.at(2 * (w - 1) + 1); }
+
+    State get_bit(int i) const
     {
-        intval = 0;
-        for (int i = 0; i < int(str.size()); i++) {
-            NPNR_ASSERT(str[i] == S0 || str[i] == S1 || str[i] == Sx || str[i] == Sz);
-            if ((str[i] == S1) && i < 64)
-                intval |= (1ULL << i);
-        }
+        NPNR_ASSERT(!is_string && i >= 0 && i < width);
+        bool v = (value_word(i / 64) >> (i % 64)) & 1, u = (undef_word(i / 64) >> (i % 64)) & 1;
+        return u ? (v ? Sz : Sx) : (v ? S1 : S0);
     }
+    void set_bit(int i, State bit);
+    // Change the width of a numeric value, padding new bits with the given state
+    void resize(int new_width, State padding = State::S0);
 
     int64_t as_int64() const
     {
         NPNR_ASSERT(!is_string);
-        return intval;
-    }
-    std::vector<bool> as_bits() const
-    {
-        std::vector<bool> result;
-        result.reserve(str.size());
-        for (auto c : str) {
-            NPNR_ASSERT(c == S0 || c == S1);
-            result.push_back(c == S1);
-        }
-        return result;
+        return int64_t(value0 & ~undef0);
     }
+    std::vector<bool> as_bits() const;
     std::string as_string() const
     {
         NPNR_ASSERT(is_string);
@@ -370,43 +380,49 @@ struct Property
         NPNR_ASSERT(is_string);
         return str.c_str();
     }
-    size_t size() const { return is_string ? 8 * str.size() : str.size(); }
+    size_t size() const { return is_string ? 8 * str.size() : width; }
     double as_double() const
     {
         NPNR_ASSERT(is_string);
         return std::stod(str);
     }
-    bool as_bool() const
-    {
-        if (int(str.size()) <= 64)
-            return intval != 0;
-        else
-            return std::any_of(str.begin(), str.end(), [](char c) { return c == S1; });
-    }
-    bool is_fully_def() const
-    {
-        return !is_string && std::all_of(str.begin(), str.end(), [](char c) { return c == S0 || c == S1; });
-    }
-    Property extract(int offset, int len, State padding = State::S0) const
-    {
-        Property ret;
-        ret.is_string = false;
-        ret.str.reserve(len);
-        for (int i = offset; i < offset + len; i++)
-            ret.str.push_back(i < int(str.size()) ? str[i] : padding);
-        ret.update_intval();
-        return ret;
-    }
+    bool as_bool() const;
+    bool is_fully_def() const;
+    Property extract(int offset, int len, State padding = State::S0) const;
+    // The bits of a numeric value as a string of [01xz], least significant bit first
+    std::string bit_str() const;
     // Convert to a string representation, escaping literal strings matching /^[01xz]* *$/ by adding a space at the end,
     // to disambiguate from binary strings
     std::string to_string() const;
     // Convert a string of four-value binary [01xz], or a literal string escaped according to the above rule
     // to a Property
     static Property from_string(const std::string &s);
-};
 
-inline bool operator==(const Property &a, const Property &b) { return a.is_string == b.is_string && a.str == b.str; }
-inline bool operator!=(const Property &a, const Property &b) { return a.is_string != b.is_string || a.str != b.str; }
+    bool operator==(const Property &other) const
+    {
+        if (is_string != other.is_string)
+            return false;
+        if (is_string)
+            return str == other.str;
+        return width == other.width && value0 == other.value0 && undef0 == other.undef0 &&
+               ext_words == other.ext_words;
+    }
+    bool operator!=(const Property &other) const { return !(*this == other); }
+
+  private:
+    int width = 0;
+    uint64_t value0 = 0, undef0 = 0;
+    std::vector<uint64_t> ext_words;
+
+    uint64_t &word_ref(int w, bool undef)
+    {
+        return (w == 0) ? (undef ? undef0 : value0) : ext_words.at(2 * (w - 1) + undef);
+    }
+    // 64 bits of a plane starting at an arbitrary bit offset, with zeros beyond the width
+    uint64_t get_bits(int offset, bool undef) const;
+    // Clear any bits beyond the width in the last word
+    void mask_top();
+};
 
 struct ClockConstraint;
 
@@ -822,6 +838,8 @@ struct BaseCtx
     void addClock(IdString net, float freq);
     void createRectangularRegion(IdString name, int x0, int y0, int x1, int y1);
     void addBelToRegion(IdString name, BelId bel);
+    // Only include bels of the given types (repeat for more types) from the rectangles of a region
+    void addRegionBelType(IdString name, IdString type);
     void constrainCellToRegion(IdString cell, IdString region_name);
 
     // Helper functions for Python bindings
@@ -861,6 +879,21 @@ struct Context : Arch, DeterministicRNG
     WireId getNetinfoSinkWire(const NetInfo *net_info, const PortRef &sink) const;
     delay_t getNetinfoRouteDelay(const NetInfo *net_info, const PortRef &sink) const;
 
+    // Constant time check of whether a bel is in a region; safe to call from several threads
+    bool isBelInRegion(const Region *region, BelId bel) const;
+    // The bels of a type in a region, or all its bels for an empty type
+    const std::vector<BelId> &getRegionBels(Region *region, IdString type = IdString()) const;
+    // The region whose routing constraints a net must follow: the region of its driver and all of its users, if that
+    // has constr_wires or constr_pips set; or nullptr. Nets between different regions aren't constrained
+    const Region *getNetRoutingRegion(const NetInfo *net) const;
+    // Build the routing masks of all regions with routing constraints; call before routing, from a single thread
+    void prepareRegionRouting();
+    // Whether routing constrained to a region may use a pip; safe to call from several threads after
+    // prepareRegionRouting
+    bool isPipInRegion(const Region *region, PipId pip) const;
+    // Report nets whose bound pips are outside their routing region, returning how many there are
+    int checkRegionRouting() const;
+
     // provided by router1.cc
     bool checkRoutedDesign() const;
     bool getActualRouteDelay(WireId src_wire, WireId dst_wire, delay_t *delay = nullptr,
@@ -875,6 +908,9 @@ struct Context : Arch, DeterministicRNG
     // provided by sdf.cc
     void writeSDF(std::ostream &out, bool cvc_mode = false) const;
 
+    // provided by verilog.cc
+    void writeVerilog(std::ostream &out, bool interconnect_delays = false) const;
+
     // --------------------------------------------------------------
 
     uint32_t checksum() const;
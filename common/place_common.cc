@@ -529,9 +529,9 @@ int get_constraints_distance(const Context *ctx, const CellInfo *cell)
     return dist;
 }
 
-bool check_cell_bel_region(const CellInfo *cell, BelId bel)
+bool check_cell_bel_region(const Context *ctx, const CellInfo *cell, BelId bel)
 {
-    if (cell->region != nullptr && cell->region->constr_bels && !cell->region->bels.count(bel))
+    if (cell->region != nullptr && cell->region->constr_bels && !ctx->isBelInRegion(cell->region, bel))
         return false;
     else
         return true;
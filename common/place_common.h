@@ -51,7 +51,7 @@ bool legalise_relative_constraints(Context *ctx);
 int get_constraints_distance(const Context *ctx, const CellInfo *cell);
 
 // Check that a Bel is within the region for a cell
-bool check_cell_bel_region(const CellInfo *cell, BelId bel);
+bool check_cell_bel_region(const Context *ctx, const CellInfo *cell, BelId bel);
 
 NEXTPNR_NAMESPACE_END
 
@@ -124,6 +124,13 @@ class SAPlacer
                 bb.x1 = std::numeric_limits<int>::min();
                 bb.y0 = std::numeric_limits<int>::max();
                 bb.y1 = std::numeric_limits<int>::min();
+                // The rectangles bound the region, with individually added bels outside them
+                for (auto &rect : r->rects) {
+                    bb.x0 = std::min(bb.x0, std::max(0, rect.x0));
+                    bb.x1 = std::max(bb.x1, std::min(max_x, rect.x1));
+                    bb.y0 = std::min(bb.y0, std::max(0, rect.y0));
+                    bb.y1 = std::max(bb.y1, std::min(max_y, rect.y1));
+                }
                 for (auto bel : r->bels) {
                     Loc loc = ctx->getBelLocation(bel);
                     bb.x0 = std::min(bb.x0, loc.x);
@@ -241,6 +248,7 @@ class SAPlacer
                 else
                     autoplaced.push_back(ci);
             }
+            setup_macros(chain_basis);
             require_legal = false;
             diameter = 3;
             log_info("Running simulated annealing placer for refinement.\n");
@@ -290,8 +298,7 @@ class SAPlacer
                 }
                 // Also try swapping chains, if applicable
                 for (auto cb : chain_basis) {
-                    Loc chain_base_loc = ctx->getBelLocation(cb->bel);
-                    BelId try_base = random_bel_for_cell(cb, chain_base_loc.z);
+                    BelId try_base = random_anchor_for_macro(cb);
                     if (try_base != BelId() && try_base != cb->bel)
                         try_swap_chain(cb, try_base);
                 }
@@ -371,6 +378,7 @@ class SAPlacer
                         else if (cell.second->belStrength < STRENGTH_STRONG)
                             autoplaced.push_back(cell.second);
                     }
+                    setup_macros(chain_basis);
                     // temp = post_legalise_temp;
                     // diameter = std::min<int>(M, diameter * post_legalise_dia_scale);
                     ctx->shuffle(autoplaced);
@@ -472,7 +480,7 @@ class SAPlacer
             };
 
             if (cell->region != nullptr && cell->region->constr_bels) {
-                for (auto bel : cell->region->bels) {
+                for (auto bel : ctx->getRegionBels(cell->region, cell->type)) {
                     proc_bel(bel);
                 }
             } else {
@@ -625,11 +633,106 @@ class SAPlacer
             discover_chain(baseLoc, child, cell_rel);
     }
 
-    // Attempt to swap a chain with a non-chain
+    // Get the root of the macro that a cell is part of
+    CellInfo *macro_root(CellInfo *cell)
+    {
+        while (cell->constr_parent != nullptr)
+            cell = cell->constr_parent;
+        return cell;
+    }
+
+    // Precompute the footprint of each macro, and an index of the bels their roots can be moved to. Macros are only
+    // moved as a whole once legalised, so footprints don't change until the next legalisation
+    void setup_macros(const std::vector<CellInfo *> &chain_basis)
+    {
+        macro_footprints.clear();
+        std::map<std::vector<std::tuple<IdString, int, int, int>>, int> shapes;
+        std::set<std::pair<IdString, int>> new_kinds;
+        for (auto root : chain_basis) {
+            MacroFootprint &fp = macro_footprints[root->name];
+            Loc baseLoc = ctx->getBelLocation(root->bel);
+            discover_chain(baseLoc, root, fp.cells);
+            std::sort(fp.cells.begin(), fp.cells.end(),
+                      [](const std::pair<CellInfo *, Loc> &a, const std::pair<CellInfo *, Loc> &b) {
+                          return std::make_tuple(a.second.x, a.second.y, a.second.z) <
+                                 std::make_tuple(b.second.x, b.second.y, b.second.z);
+                      });
+            std::vector<std::tuple<IdString, int, int, int>> shape;
+            for (const auto &cr : fp.cells)
+                shape.emplace_back(cr.first->type, cr.second.x, cr.second.y, cr.second.z);
+            fp.shape = shapes.emplace(shape, int(shapes.size())).first->second;
+            if (!anchor_bels.count(std::make_pair(root->type, baseLoc.z)))
+                new_kinds.emplace(root->type, baseLoc.z);
+        }
+        if (new_kinds.empty())
+            return;
+        for (auto bel : ctx->getBels()) {
+            Loc loc = ctx->getBelLocation(bel);
+            auto kind = std::make_pair(ctx->getBelType(bel), loc.z);
+            if (!new_kinds.count(kind))
+                continue;
+            auto &grid = anchor_bels[kind].grid;
+            if (int(grid.size()) < (loc.x + 1))
+                grid.resize(loc.x + 1);
+            if (int(grid.at(loc.x).size()) < (loc.y + 1))
+                grid.at(loc.x).resize(loc.y + 1);
+            grid.at(loc.x).at(loc.y).push_back(bel);
+        }
+        // As with fast_bels, rare bels are all put at (0, 0) so that random picks find them
+        for (auto kind : new_kinds) {
+            AnchorIndex &index = anchor_bels.at(kind);
+            int count = 0;
+            for (const auto &col : index.grid)
+                for (const auto &fb : col)
+                    count += int(fb.size());
+            if (count >= cfg.minBelsForGridPick)
+                continue;
+            std::vector<BelId> all;
+            for (const auto &col : index.grid)
+                for (const auto &fb : col)
+                    all.insert(all.end(), fb.begin(), fb.end());
+            index.grid.assign(1, std::vector<std::vector<BelId>>(1, all));
+            index.by_location = false;
+        }
+    }
+
+    // Find a random bel within the specified diameter that the root of a macro could be moved to, or BelId() if none
+    // was found
+    BelId random_anchor_for_macro(CellInfo *root)
+    {
+        Loc curr_loc = ctx->getBelLocation(root->bel);
+        const AnchorIndex &index = anchor_bels.at(std::make_pair(root->type, curr_loc.z));
+        int dx = diameter, dy = diameter;
+        if (root->region != nullptr && root->region->constr_bels) {
+            const BoundingBox &rb = region_bounds[root->region->name];
+            dx = std::min(cfg.hpwl_scale_x * diameter, (rb.x1 - rb.x0) + 1);
+            dy = std::min(cfg.hpwl_scale_y * diameter, (rb.y1 - rb.y0) + 1);
+            curr_loc.x = std::min(rb.x1, std::max(rb.x0, curr_loc.x));
+            curr_loc.y = std::min(rb.y1, std::max(rb.y0, curr_loc.y));
+        }
+        for (int tries = 0; tries < 100; tries++) {
+            int nx = 0, ny = 0;
+            if (index.by_location) {
+                nx = ctx->rng(2 * dx + 1) + std::max(curr_loc.x - dx, 0);
+                ny = ctx->rng(2 * dy + 1) + std::max(curr_loc.y - dy, 0);
+            }
+            if (nx >= int(index.grid.size()) || ny >= int(index.grid.at(nx).size()))
+                continue;
+            const auto &fb = index.grid.at(nx).at(ny);
+            if (fb.empty())
+                continue;
+            BelId bel = fb.at(ctx->rng(int(fb.size())));
+            if (!check_cell_bel_region(ctx, root, bel) || locked_bels.count(bel))
+                continue;
+            return bel;
+        }
+        return BelId();
+    }
+
+    // Attempt to move a macro as a whole to a new base. The cells occupying the new footprint are swapped into the old
+    // one; they can be unconstrained cells, or another macro of the same shape based at the new base
     bool try_swap_chain(CellInfo *cell, BelId newBase)
     {
-        std::vector<std::pair<CellInfo *, Loc>> cell_rel;
-        std::unordered_set<IdString> cells;
         std::vector<std::pair<CellInfo *, BelId>> moves_made;
         std::vector<std::pair<CellInfo *, BelId>> dest_bels;
         double delta = 0;
@@ -639,26 +742,39 @@ class SAPlacer
         if (ctx->debug)
             log_info("finding cells for chain swap %s\n", cell->name.c_str(ctx));
 #endif
+        const MacroFootprint &fp = macro_footprints.at(cell->name);
         Loc baseLoc = ctx->getBelLocation(cell->bel);
-        discover_chain(baseLoc, cell, cell_rel);
         Loc newBaseLoc = ctx->getBelLocation(newBase);
         NPNR_ASSERT(newBaseLoc.z == baseLoc.z);
-        for (const auto &cr : cell_rel)
-            cells.insert(cr.first->name);
+        CellInfo *other_root = nullptr;
 
-        for (const auto &cr : cell_rel) {
+        for (const auto &cr : fp.cells) {
             Loc targetLoc = {newBaseLoc.x + cr.second.x, newBaseLoc.y + cr.second.y, cr.second.z};
             BelId targetBel = ctx->getBelByLocation(targetLoc);
             if (targetBel == BelId())
                 return false;
-            if (ctx->getBelType(targetBel) != cell->type)
+            if (ctx->getBelType(targetBel) != cr.first->type)
                 return false;
             CellInfo *bound = ctx->getBoundBelCell(targetBel);
-            // We don't consider swapping chains with other chains, at least for the time being - unless it is
-            // part of this chain
-            if (bound != nullptr && !cells.count(bound->name) &&
-                (bound->belStrength >= STRENGTH_STRONG || is_constrained(bound)))
+            if (bound != nullptr && bound->belStrength > STRENGTH_STRONG)
                 return false;
+            if (bound != nullptr && is_constrained(bound)) {
+                CellInfo *bound_root = macro_root(bound);
+                if (bound_root != cell) {
+                    // Another macro can only be swapped with if it fits exactly into the footprint being vacated
+                    if (other_root == nullptr) {
+                        auto other_fp = macro_footprints.find(bound_root->name);
+                        if (other_fp == macro_footprints.end() || other_fp->second.shape != fp.shape ||
+                            bound_root->bel != newBase)
+                            return false;
+                        other_root = bound_root;
+                    } else if (bound_root != other_root) {
+                        return false;
+                    }
+                }
+            } else if (bound != nullptr && bound->belStrength >= STRENGTH_STRONG) {
+                return false;
+            }
             dest_bels.emplace_back(std::make_pair(cr.first, targetBel));
         }
 #if 0
@@ -675,12 +791,12 @@ class SAPlacer
                 add_move_cell(moveChange, bound, db.second);
         }
         for (const auto &mm : moves_made) {
-            if (!ctx->isBelLocationValid(mm.first->bel) || !check_cell_bel_region(mm.first, mm.first->bel))
+            if (!ctx->isBelLocationValid(mm.first->bel) || !check_cell_bel_region(ctx, mm.first, mm.first->bel))
                 goto swap_fail;
             if (!ctx->isBelLocationValid(mm.second))
                 goto swap_fail;
             CellInfo *bound = ctx->getBoundBelCell(mm.second);
-            if (bound && !check_cell_bel_region(bound, bound->bel))
+            if (bound && !check_cell_bel_region(ctx, bound, bound->bel))
                 goto swap_fail;
         }
         compute_cost_changes(moveChange);
@@ -750,7 +866,7 @@ class SAPlacer
                 if (loc.z != force_z)
                     continue;
             }
-            if (!check_cell_bel_region(cell, bel))
+            if (!check_cell_bel_region(ctx, cell, bel))
                 continue;
             if (locked_bels.find(bel) != locked_bels.end())
                 continue;
@@ -1218,6 +1334,21 @@ class SAPlacer
     std::unordered_map<IdString, std::tuple<int, int>> bel_types;
     std::unordered_map<IdString, BoundingBox> region_bounds;
     std::vector<std::vector<std::vector<std::vector<BelId>>>> fast_bels;
+    // Footprint of a macro: its cells and their locations relative to the root, in a canonical order
+    struct MacroFootprint
+    {
+        std::vector<std::pair<CellInfo *, Loc>> cells;
+        // Macros with the same shape have cells of the same types at the same relative locations
+        int shape = -1;
+    };
+    std::unordered_map<IdString, MacroFootprint> macro_footprints;
+    // Bels of one type and z, indexed by x and y, for picking macro bases
+    struct AnchorIndex
+    {
+        std::vector<std::vector<std::vector<BelId>>> grid;
+        bool by_location = true;
+    };
+    std::map<std::pair<IdString, int>, AnchorIndex> anchor_bels;
     std::unordered_set<BelId> locked_bels;
     std::vector<NetInfo *> net_by_udata;
     std::vector<decltype(NetInfo::udata)> old_udata;
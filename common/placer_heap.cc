@@ -41,10 +41,13 @@
 #include <chrono>
 #include <deque>
 #include <fstream>
+#include <limits>
 #include <numeric>
 #include <queue>
 #include <tuple>
 #include <unordered_map>
+#include "detail_place.h"
+#include "electrostatics.h"
 #include "log.h"
 #include "nextpnr.h"
 #include "place_common.h"
@@ -148,15 +151,37 @@ class HeAPPlacer
         build_fast_bels();
         seed_placement();
         update_all_chains();
+        bool clustered = (cfg.seed == PlacerHeapCfg::SEED_CLUSTER) && cluster_seed();
+        if (clustered) {
+            update_all_chains();
+            for (auto &cl : cell_locs) {
+                cl.second.legal_x = cl.second.x;
+                cl.second.legal_y = cl.second.y;
+            }
+        }
+        if (cfg.reuseHierarchy) {
+            // The electrostatic placer's global placement happens before the first legalisation, so there would be
+            // no representative placement to pull instances towards
+            if (cfg.electrostatic)
+                log_error("Reusing the placement of repeated hierarchy is not supported by the electrostatic "
+                          "placer.\n");
+            find_repeated_instances();
+        }
         wirelen_t hpwl = total_hpwl();
-        log_info("Creating initial analytic placement for %d cells, random placement wirelen = %d.\n",
-                 int(place_cells.size()), int(hpwl));
-        for (int i = 0; i < 4; i++) {
+        if (cfg.netModel != PlacerHeapCfg::NET_MODEL_B2B || cfg.electrostatic)
+            log_info("Using %s net model.\n", cfg.netModel != PlacerHeapCfg::NET_MODEL_LSE ? "weighted-average"
+                                                                                           : "log-sum-exp");
+        log_info("Creating initial analytic placement for %d cells, %s placement wirelen = %d.\n",
+                 int(place_cells.size()), clustered ? "clustered" : "random", int(hpwl));
+        // The clustered seed is already spread, and collapsing it again with unconstrained solves would waste it
+        for (int i = 0; i < (clustered ? 0 : 4); i++) {
             setup_solve_cells();
             auto solve_startt = std::chrono::high_resolution_clock::now();
-            boost::thread xaxis([&]() { build_solve_direction(false, -1); });
-            build_solve_direction(true, -1);
-            xaxis.join();
+            // The electrostatic placer starts from a quadratic placement, as in ePlace
+            if (cfg.electrostatic)
+                solve_b2b(-1);
+            else
+                solve_positions(-1);
             auto solve_endt = std::chrono::high_resolution_clock::now();
             solve_time += std::chrono::duration<double>(solve_endt - solve_startt).count();
 
@@ -166,6 +191,13 @@ class HeAPPlacer
             log_info("    at initial placer iter %d, wirelen = %d\n", i, int(hpwl));
         }
 
+        if (cfg.electrostatic) {
+            auto solve_startt = std::chrono::high_resolution_clock::now();
+            electrostatic_place();
+            auto solve_endt = std::chrono::high_resolution_clock::now();
+            solve_time += std::chrono::duration<double>(solve_endt - solve_startt).count();
+        }
+
         wirelen_t solved_hpwl = 0, spread_hpwl = 0, legal_hpwl = 0, best_hpwl = std::numeric_limits<wirelen_t>::max();
         int iter = 0, stalled = 0;
 
@@ -190,7 +222,7 @@ class HeAPPlacer
                 break;
             }
 
-        if (cfg.placeAllAtOnce) {
+        if (cfg.placeAllAtOnce || cfg.electrostatic) {
             // Never want to deal with LUTs, FFs, MUXFxs seperately,
             // for now disable all single-cell-type runs and only have heteregenous
             // runs
@@ -208,19 +240,14 @@ class HeAPPlacer
                 setup_solve_cells(&run);
                 if (solve_cells.empty())
                     continue;
-                // Heuristic: don't bother with threading below a certain size
-                auto solve_startt = std::chrono::high_resolution_clock::now();
-
-                if (solve_cells.size() < 500) {
-                    build_solve_direction(false, (iter == 0) ? -1 : iter);
-                    build_solve_direction(true, (iter == 0) ? -1 : iter);
-                } else {
-                    boost::thread xaxis([&]() { build_solve_direction(false, (iter == 0) ? -1 : iter); });
-                    build_solve_direction(true, (iter == 0) ? -1 : iter);
-                    xaxis.join();
+                // Electrostatic placement has already produced a spread global placement
+                if (!cfg.electrostatic) {
+                    auto solve_startt = std::chrono::high_resolution_clock::now();
+                    // After a clustered seed, even the first solve is anchored to the (seed) legal positions
+                    solve_positions(clustered ? iter + 1 : (iter == 0) ? -1 : iter);
+                    auto solve_endt = std::chrono::high_resolution_clock::now();
+                    solve_time += std::chrono::duration<double>(solve_endt - solve_startt).count();
                 }
-                auto solve_endt = std::chrono::high_resolution_clock::now();
-                solve_time += std::chrono::duration<double>(solve_endt - solve_startt).count();
                 update_all_chains();
                 solved_hpwl = total_hpwl();
 
@@ -240,6 +267,8 @@ class HeAPPlacer
                 update_all_chains();
 
                 legal_hpwl = total_hpwl();
+                if (!repeated_groups.empty())
+                    update_macro_targets();
                 auto run_stopt = std::chrono::high_resolution_clock::now();
                 log_info("    at iteration #%d, type %s: wirelen solved = %d, spread = %d, legal = %d; time = %.02fs\n",
                          iter + 1, (run.size() > 1 ? "ALL" : run.begin()->c_str(ctx)), int(solved_hpwl),
@@ -267,6 +296,8 @@ class HeAPPlacer
             }
             ctx->yield();
             ++iter;
+            if (cfg.electrostatic)
+                break;
         }
 
         // Apply saved solution
@@ -283,6 +314,9 @@ class HeAPPlacer
             ctx->bindBel(bel, cell, strength);
         }
 
+        if (!repeated_groups.empty())
+            replicate_instances();
+
         for (auto cell : sorted(ctx->cells)) {
             if (cell.second->bel == BelId())
                 log_error("Found unbound cell %s\n", cell.first.c_str(ctx));
@@ -294,18 +328,26 @@ class HeAPPlacer
 
         ctx->unlock();
         auto endtt = std::chrono::high_resolution_clock::now();
-        log_info("HeAP Placer Time: %.02fs\n", std::chrono::duration<double>(endtt - startt).count());
+        log_info("%s Placer Time: %.02fs\n", cfg.electrostatic ? "ePlace" : "HeAP",
+                 std::chrono::duration<double>(endtt - startt).count());
         log_info("  of which solving equations: %.02fs\n", solve_time);
         log_info("  of which spreading cells: %.02fs\n", cl_time);
         log_info("  of which strict legalisation: %.02fs\n", sl_time);
 
         ctx->check();
 
-        auto placer1_cfg = Placer1Cfg(ctx);
-        placer1_cfg.hpwl_scale_x = cfg.hpwl_scale_x;
-        placer1_cfg.hpwl_scale_y = cfg.hpwl_scale_y;
-        placer1_cfg.netShareWeight = cfg.netShareWeight;
-        placer1_refine(ctx, placer1_cfg);
+        if (cfg.refine == PlacerHeapCfg::REFINE_SA) {
+            auto placer1_cfg = Placer1Cfg(ctx);
+            placer1_cfg.hpwl_scale_x = cfg.hpwl_scale_x;
+            placer1_cfg.hpwl_scale_y = cfg.hpwl_scale_y;
+            placer1_cfg.netShareWeight = cfg.netShareWeight;
+            placer1_refine(ctx, placer1_cfg);
+        } else if (cfg.refine == PlacerHeapCfg::REFINE_DETAIL) {
+            auto detail_cfg = DetailPlaceCfg(ctx);
+            detail_cfg.hpwl_scale_x = cfg.hpwl_scale_x;
+            detail_cfg.hpwl_scale_y = cfg.hpwl_scale_y;
+            detail_place(ctx, detail_cfg);
+        }
 
         return true;
     }
@@ -362,6 +404,19 @@ class HeAPPlacer
     // Performance counting
     double solve_time = 0, cl_time = 0, sl_time = 0;
 
+    // Instances of the same hierarchical module with isomorphic contents, for structured placement
+    struct RepeatedInstance
+    {
+        IdString path;
+        // Cells in canonical order, so that cells at the same index correspond between instances of a group
+        std::vector<CellInfo *> cells;
+    };
+    std::vector<std::vector<RepeatedInstance>> repeated_groups;
+    // Index of the most compactly placed instance in each group
+    std::vector<int> group_representative;
+    // Soft macro target location of cells in the other instances
+    std::unordered_map<IdString, std::pair<int, int>> macro_targets;
+
     NetCriticalityMap net_crit;
 
     // Place cells with the BEL attribute set to constrain them
@@ -478,6 +533,13 @@ class HeAPPlacer
                 bb.x1 = std::numeric_limits<int>::min();
                 bb.y0 = std::numeric_limits<int>::max();
                 bb.y1 = std::numeric_limits<int>::min();
+                // The rectangles bound the region, with individually added bels outside them
+                for (auto &rect : r->rects) {
+                    bb.x0 = std::min(bb.x0, std::max(0, rect.x0));
+                    bb.x1 = std::max(bb.x1, std::min(max_x, rect.x1));
+                    bb.y0 = std::min(bb.y0, std::max(0, rect.y0));
+                    bb.y1 = std::max(bb.y1, std::min(max_y, rect.y1));
+                }
                 for (auto bel : r->bels) {
                     Loc loc = ctx->getBelLocation(bel);
                     bb.x0 = std::min(bb.x0, loc.x);
@@ -495,6 +557,28 @@ class HeAPPlacer
         }
     }
 
+    // Solve for the positions of solve_cells using the configured net model
+    void solve_positions(int iter)
+    {
+        if (cfg.netModel != PlacerHeapCfg::NET_MODEL_B2B)
+            solve_smooth(iter);
+        else
+            solve_b2b(iter);
+    }
+
+    void solve_b2b(int iter)
+    {
+        // Heuristic: don't bother with threading below a certain size
+        if (solve_cells.size() < 500) {
+            build_solve_direction(false, iter);
+            build_solve_direction(true, iter);
+        } else {
+            boost::thread xaxis([&]() { build_solve_direction(false, iter); });
+            build_solve_direction(true, iter);
+            xaxis.join();
+        }
+    }
+
     // Build and solve in one direction
     void build_solve_direction(bool yaxis, int iter)
     {
@@ -568,6 +652,290 @@ class HeAPPlacer
         }
     }
 
+    // Replace the random placement of the movable cells with one that follows the connectivity of the netlist. The
+    // netlist is coarsened by heavy-edge matching, the coarsest graph is embedded spectrally and spread over the
+    // device in the orientation that best fits the fixed cells, and each cell is placed around its cluster. Returns
+    // false, keeping the random placement, if there is nothing to cluster
+    bool cluster_seed()
+    {
+        struct SeedGraph
+        {
+            // Connection weights between nodes, and the weights and weighted position sums of their connections to
+            // fixed cells
+            std::vector<std::unordered_map<int, double>> adj;
+            std::vector<double> size, anchor_w, anchor_x, anchor_y;
+
+            void resize(int n)
+            {
+                adj.resize(n);
+                size.resize(n, 0);
+                anchor_w.resize(n, 0);
+                anchor_x.resize(n, 0);
+                anchor_y.resize(n, 0);
+            }
+        };
+        const int max_fanout = 64;
+
+        auto startt = std::chrono::high_resolution_clock::now();
+        int n = int(place_cells.size());
+        if (n < 2)
+            return false;
+        std::vector<SeedGraph> levels(1);
+        levels.front().resize(n);
+        std::unordered_map<IdString, int> node_of;
+        for (int i = 0; i < n; i++) {
+            node_of[place_cells.at(i)->name] = i;
+            levels.front().size.at(i) = 1;
+        }
+        for (auto &chained : chain_root) {
+            auto fnd = node_of.find(chained.second->name);
+            if (fnd == node_of.end())
+                continue;
+            levels.front().size.at(fnd->second) += 1;
+            node_of[chained.first] = fnd->second;
+        }
+
+        // Clique model of each net, skipping clocks and other high fanout nets. Only cells placed by constraints are
+        // used as anchors, as IO buffers without constraints are at random locations
+        SeedGraph &fine = levels.front();
+        std::vector<int> movable;
+        std::vector<std::pair<int, int>> fixed;
+        for (auto net : sorted(ctx->nets)) {
+            NetInfo *ni = net.second;
+            if (ni->driver.cell == nullptr || ni->users.empty() || int(ni->users.size()) > max_fanout)
+                continue;
+            movable.clear();
+            fixed.clear();
+            bool global = false;
+            foreach_port(ni, [&](PortRef &port, int user_idx) {
+                auto fnd = node_of.find(port.cell->name);
+                if (fnd != node_of.end()) {
+                    movable.push_back(fnd->second);
+                    return;
+                }
+                auto loc = cell_locs.find(port.cell->name);
+                if (loc == cell_locs.end() || !loc->second.locked)
+                    return;
+                global |= loc->second.global;
+                if (port.cell->belStrength > STRENGTH_STRONG)
+                    fixed.emplace_back(loc->second.x, loc->second.y);
+            });
+            int pins = int(movable.size() + fixed.size());
+            if (global || movable.empty() || pins < 2)
+                continue;
+            auto fnd_weight = cfg.netWeights.find(ni->name);
+            double weight = ((fnd_weight != cfg.netWeights.end()) ? fnd_weight->second : 1.0) / (pins - 1);
+            for (size_t i = 0; i < movable.size(); i++) {
+                int a = movable.at(i);
+                for (size_t j = i + 1; j < movable.size(); j++) {
+                    int b = movable.at(j);
+                    if (a == b)
+                        continue;
+                    fine.adj.at(a)[b] += weight;
+                    fine.adj.at(b)[a] += weight;
+                }
+                for (auto &f : fixed) {
+                    fine.anchor_w.at(a) += weight;
+                    fine.anchor_x.at(a) += weight * f.first;
+                    fine.anchor_y.at(a) += weight * f.second;
+                }
+            }
+        }
+
+        // Coarsen by heavy-edge matching until there are few enough clusters, or matching stops making progress
+        std::vector<std::vector<int>> coarse_of;
+        while (int(levels.back().size.size()) > cfg.seedClusters) {
+            const SeedGraph &g = levels.back();
+            int gn = int(g.size.size());
+            std::vector<int> order(gn);
+            std::iota(order.begin(), order.end(), 0);
+            ctx->shuffle(order);
+            std::vector<int> map(gn, -1);
+            int cn = 0;
+            for (int u : order) {
+                if (map.at(u) != -1)
+                    continue;
+                int best = -1;
+                double best_score = 0;
+                for (auto &e : g.adj.at(u)) {
+                    if (map.at(e.first) != -1)
+                        continue;
+                    // Normalising by size keeps clusters growing evenly, rather than one absorbing its neighbours
+                    double score = e.second / (g.size.at(u) * g.size.at(e.first));
+                    if (score > best_score) {
+                        best_score = score;
+                        best = e.first;
+                    }
+                }
+                map.at(u) = cn;
+                if (best != -1)
+                    map.at(best) = cn;
+                ++cn;
+            }
+            if (cn > 0.95 * gn)
+                break;
+            SeedGraph next;
+            next.resize(cn);
+            for (int u = 0; u < gn; u++) {
+                int cu = map.at(u);
+                next.size.at(cu) += g.size.at(u);
+                next.anchor_w.at(cu) += g.anchor_w.at(u);
+                next.anchor_x.at(cu) += g.anchor_x.at(u);
+                next.anchor_y.at(cu) += g.anchor_y.at(u);
+                for (auto &e : g.adj.at(u)) {
+                    int cv = map.at(e.first);
+                    if (cv != cu)
+                        next.adj.at(cu)[cv] += e.second;
+                }
+            }
+            coarse_of.push_back(std::move(map));
+            levels.push_back(std::move(next));
+        }
+
+        // Spectral embedding of the coarsest graph: the two leading nontrivial eigenvectors of its normalised
+        // adjacency matrix, found by orthogonal iteration. A weak connection between every pair of clusters, in
+        // proportion to their sizes, keeps the graph connected
+        const SeedGraph &top = levels.back();
+        int m = int(top.size.size());
+        double total_size = 0, total_weight = 0;
+        for (int i = 0; i < m; i++) {
+            total_size += top.size.at(i);
+            for (auto &e : top.adj.at(i))
+                total_weight += e.second;
+        }
+        double reg = std::max(1e-6, 0.01 * total_weight / total_size);
+        std::vector<double> inv_sqrt_deg(m), trivial(m);
+        double trivial_norm = 0;
+        for (int i = 0; i < m; i++) {
+            double deg = reg * top.size.at(i);
+            for (auto &e : top.adj.at(i))
+                deg += e.second;
+            inv_sqrt_deg.at(i) = 1.0 / std::sqrt(deg);
+            trivial.at(i) = std::sqrt(deg);
+            trivial_norm += deg;
+        }
+        for (auto &t : trivial)
+            t /= std::sqrt(trivial_norm);
+        // Multiply by (I + D^-1/2 W D^-1/2) / 2, which has the same eigenvectors with nonnegative eigenvalues
+        std::vector<double> scaled(m);
+        auto multiply = [&](const std::vector<double> &x, std::vector<double> &y) {
+            double size_dot = 0;
+            for (int i = 0; i < m; i++) {
+                scaled.at(i) = inv_sqrt_deg.at(i) * x.at(i);
+                size_dot += top.size.at(i) * scaled.at(i);
+            }
+            for (int i = 0; i < m; i++) {
+                double acc = reg * top.size.at(i) * size_dot / total_size;
+                for (auto &e : top.adj.at(i))
+                    acc += e.second * scaled.at(e.first);
+                y.at(i) = 0.5 * (x.at(i) + inv_sqrt_deg.at(i) * acc);
+            }
+        };
+        auto project_out = [&](std::vector<double> &x, const std::vector<double> &dir) {
+            double dot = 0;
+            for (int i = 0; i < m; i++)
+                dot += x.at(i) * dir.at(i);
+            for (int i = 0; i < m; i++)
+                x.at(i) -= dot * dir.at(i);
+        };
+        auto normalise = [&](std::vector<double> &x) {
+            double norm = 0;
+            for (auto v : x)
+                norm += v * v;
+            norm = std::sqrt(norm);
+            if (norm > 0)
+                for (auto &v : x)
+                    v /= norm;
+        };
+        std::vector<std::vector<double>> vecs(2, std::vector<double>(m));
+        std::vector<double> tmp(m);
+        for (auto &vec : vecs)
+            for (auto &v : vec)
+                v = ctx->rng(10001) / 10000.0 - 0.5;
+        for (int iter = 0; iter < 100; iter++) {
+            for (int k = 0; k < 2; k++) {
+                multiply(vecs.at(k), tmp);
+                vecs.at(k).swap(tmp);
+                project_out(vecs.at(k), trivial);
+                for (int j = 0; j < k; j++)
+                    project_out(vecs.at(k), vecs.at(j));
+                normalise(vecs.at(k));
+            }
+        }
+        for (auto &vec : vecs)
+            for (int i = 0; i < m; i++)
+                vec.at(i) *= inv_sqrt_deg.at(i);
+
+        // Spread the clusters evenly over the device by the rank of their embedded coordinates, in whichever
+        // orientation of the embedding best fits the fixed cells that they connect to
+        auto spread = [&](const std::vector<double> &coord, bool flip, int max_pos) {
+            std::vector<int> order(m);
+            std::iota(order.begin(), order.end(), 0);
+            std::stable_sort(order.begin(), order.end(), [&](int a, int b) {
+                return flip ? coord.at(a) > coord.at(b) : coord.at(a) < coord.at(b);
+            });
+            std::vector<double> pos(m);
+            double acc = 0;
+            for (int i : order) {
+                pos.at(i) = (acc + 0.5 * top.size.at(i)) / total_size * max_pos;
+                acc += top.size.at(i);
+            }
+            return pos;
+        };
+        std::vector<double> px, py;
+        double best_cost = std::numeric_limits<double>::max();
+        for (int orient = 0; orient < 8; orient++) {
+            bool swap = orient & 1;
+            std::vector<double> ox = spread(vecs.at(swap ? 1 : 0), orient & 2, max_x);
+            std::vector<double> oy = spread(vecs.at(swap ? 0 : 1), orient & 4, max_y);
+            double cost = 0;
+            for (int i = 0; i < m; i++)
+                cost += std::abs(top.anchor_w.at(i) * ox.at(i) - top.anchor_x.at(i)) +
+                        std::abs(top.anchor_w.at(i) * oy.at(i) - top.anchor_y.at(i));
+            if (cost < best_cost) {
+                best_cost = cost;
+                px = std::move(ox);
+                py = std::move(oy);
+            }
+        }
+        // A few force-directed relaxation passes, towards connected clusters and fixed cells
+        for (int pass = 0; pass < 3; pass++) {
+            for (int i = 0; i < m; i++) {
+                double w = top.anchor_w.at(i), sx = top.anchor_x.at(i), sy = top.anchor_y.at(i);
+                for (auto &e : top.adj.at(i)) {
+                    w += e.second;
+                    sx += e.second * px.at(e.first);
+                    sy += e.second * py.at(e.first);
+                }
+                if (w > 0) {
+                    px.at(i) = 0.5 * px.at(i) + 0.5 * sx / w;
+                    py.at(i) = 0.5 * py.at(i) + 0.5 * sy / w;
+                }
+            }
+        }
+
+        // Place each cell within the area its cluster would cover
+        double unit_area = double(max_x + 1) * double(max_y + 1) / total_size;
+        for (int i = 0; i < n; i++) {
+            int c = i;
+            for (auto &map : coarse_of)
+                c = map.at(c);
+            double radius = 0.5 * std::sqrt(top.size.at(c) * unit_area);
+            double x = px.at(c) + (ctx->rng(1001) / 500.0 - 1.0) * radius;
+            double y = py.at(c) + (ctx->rng(1001) / 500.0 - 1.0) * radius;
+            CellInfo *ci = place_cells.at(i);
+            auto &cl = cell_locs.at(ci->name);
+            cl.rawx = x;
+            cl.rawy = y;
+            cl.x = limit_to_reg(ci->region, std::max(0, std::min(max_x, int(x + 0.5))), false);
+            cl.y = limit_to_reg(ci->region, std::max(0, std::min(max_y, int(y + 0.5))), true);
+        }
+        auto endt = std::chrono::high_resolution_clock::now();
+        log_info("Clustered %d cells into %d clusters over %d levels for the initial placement (%.02fs).\n", n, m,
+                 int(levels.size()) - 1, std::chrono::duration<double>(endt - startt).count());
+        return true;
+    }
+
     // Setup the cells to be solved, returns the number of rows
     int setup_solve_cells(std::unordered_set<IdString> *celltypes = nullptr)
     {
@@ -683,6 +1051,9 @@ class HeAPPlacer
                 }
             };
 
+            auto fnd_weight = cfg.netWeights.find(ni->name);
+            double net_weight = (fnd_weight != cfg.netWeights.end()) ? fnd_weight->second : 1.0;
+
             // Add all relevant connections to the matrix
             foreach_port(ni, [&](PortRef &port, int user_idx) {
                 int this_pos = cell_pos(port.cell);
@@ -700,6 +1071,8 @@ class HeAPPlacer
                             weight *= (1.0 + cfg.timingWeight *
                                                      std::pow(nc.criticality.at(user_idx), cfg.criticalityExponent));
                     }
+                    if (net_weight != 1.0)
+                        weight *= net_weight;
 
                     // If cell 0 is not fixed, it will stamp +w on its equation and -w on the other end's equation,
                     // if the other end isn't fixed
@@ -725,6 +1098,19 @@ class HeAPPlacer
                 es.add_coeff(row, row, weight);
                 es.add_rhs(row, weight * l_pos);
             }
+            // Pull cells of repeated instances towards the placement of their group's representative
+            for (size_t row = 0; row < solve_cells.size(); row++) {
+                auto fnd = macro_targets.find(solve_cells.at(row)->name);
+                if (fnd == macro_targets.end())
+                    continue;
+                int t_pos = yaxis ? fnd->second.second : fnd->second.first;
+                int c_pos = cell_pos(solve_cells.at(row));
+                double weight =
+                        alpha * iter /
+                        std::max<double>(1, (yaxis ? cfg.hpwl_scale_y : cfg.hpwl_scale_x) * std::abs(t_pos - c_pos));
+                es.add_coeff(row, row, weight);
+                es.add_rhs(row, weight * t_pos);
+            }
         }
     }
 
@@ -752,6 +1138,526 @@ class HeAPPlacer
             }
     }
 
+    // Smooth wirelength models. Each pin is either a variable (the solve row of its cell or chain root, plus the
+    // offset of the cell from that root) or fixed at its current location
+    struct SmoothPin
+    {
+        int row;
+        double off_x, off_y;
+    };
+    struct SmoothNet
+    {
+        std::vector<SmoothPin> pins;
+        double weight;
+    };
+    std::vector<SmoothNet> smooth_nets;
+
+    void setup_smooth_nets()
+    {
+        smooth_nets.clear();
+        for (auto net : sorted(ctx->nets)) {
+            NetInfo *ni = net.second;
+            if (ni->driver.cell == nullptr || ni->users.empty())
+                continue;
+            if (cell_locs.at(ni->driver.cell->name).global)
+                continue;
+            SmoothNet sn;
+            bool any_var = false;
+            foreach_port(ni, [&](PortRef &port, int user_idx) {
+                CellInfo *cell = port.cell;
+                auto &cl = cell_locs.at(cell->name);
+                SmoothPin pin;
+                if (cell->udata != dont_solve) {
+                    pin.row = cell->udata;
+                    CellInfo *root = chain_root.count(cell->name) ? chain_root.at(cell->name) : cell;
+                    pin.off_x = cl.x - cell_locs.at(root->name).x;
+                    pin.off_y = cl.y - cell_locs.at(root->name).y;
+                    any_var = true;
+                } else {
+                    pin.row = -1;
+                    pin.off_x = cl.x;
+                    pin.off_y = cl.y;
+                }
+                sn.pins.push_back(pin);
+            });
+            if (!any_var)
+                continue;
+            sn.weight = 1.0;
+            if (net_crit.count(ni->name)) {
+                double max_crit = 0;
+                for (auto c : net_crit.at(ni->name).criticality)
+                    max_crit = std::max<double>(max_crit, c);
+                sn.weight += cfg.timingWeight * std::pow(max_crit, cfg.criticalityExponent);
+            }
+            auto fnd_weight = cfg.netWeights.find(ni->name);
+            if (fnd_weight != cfg.netWeights.end())
+                sn.weight *= fnd_weight->second;
+            smooth_nets.push_back(std::move(sn));
+        }
+    }
+
+    // Add the gradient of the smooth wirelength along one axis to grad, returning the smooth wirelength
+    double smooth_wirelength_grad(const std::vector<double> &pos, bool yaxis, double gamma, std::vector<double> &grad)
+    {
+        const bool wa = (cfg.netModel != PlacerHeapCfg::NET_MODEL_LSE);
+        const double scale = yaxis ? cfg.hpwl_scale_y : cfg.hpwl_scale_x;
+        double total = 0;
+        std::vector<double> px, ep, en;
+        for (auto &sn : smooth_nets) {
+            size_t n = sn.pins.size();
+            px.resize(n);
+            ep.resize(n);
+            en.resize(n);
+            double xmax = std::numeric_limits<double>::lowest(), xmin = std::numeric_limits<double>::max();
+            for (size_t i = 0; i < n; i++) {
+                auto &pin = sn.pins.at(i);
+                px[i] = (pin.row == -1 ? 0 : pos.at(pin.row)) + (yaxis ? pin.off_y : pin.off_x);
+                xmax = std::max(xmax, px[i]);
+                xmin = std::min(xmin, px[i]);
+            }
+            // Exponents are shifted by the extremes to avoid overflow
+            double sp = 0, sn_ = 0, tp = 0, tn = 0;
+            for (size_t i = 0; i < n; i++) {
+                ep[i] = std::exp((px[i] - xmax) / gamma);
+                en[i] = std::exp((xmin - px[i]) / gamma);
+                sp += ep[i];
+                sn_ += en[i];
+                tp += px[i] * ep[i];
+                tn += px[i] * en[i];
+            }
+            double w = sn.weight * scale;
+            if (wa) {
+                double wa_p = tp / sp, wa_n = tn / sn_;
+                total += w * (wa_p - wa_n);
+                for (size_t i = 0; i < n; i++) {
+                    int row = sn.pins.at(i).row;
+                    if (row == -1)
+                        continue;
+                    grad.at(row) += w * ((ep[i] / sp) * (1 + (px[i] - wa_p) / gamma) -
+                                         (en[i] / sn_) * (1 - (px[i] - wa_n) / gamma));
+                }
+            } else {
+                total += w * gamma * (std::log(sp) + xmax / gamma + std::log(sn_) - xmin / gamma);
+                for (size_t i = 0; i < n; i++) {
+                    int row = sn.pins.at(i).row;
+                    if (row == -1)
+                        continue;
+                    grad.at(row) += w * (ep[i] / sp - en[i] / sn_);
+                }
+            }
+        }
+        return total;
+    }
+
+    // Bilinear bin density penalty sum(max(0, density - capacity)^2), adding its gradient to gx and gy
+    double density_penalty_grad(const std::vector<double> &x, const std::vector<double> &y,
+                                const std::vector<std::vector<double>> &capacity, std::vector<double> &gx,
+                                std::vector<double> &gy)
+    {
+        int w = max_x + 1, h = max_y + 1;
+        std::vector<double> density(w * h, 0.0);
+        auto bin_weights = [&](size_t i, int &x0, int &y0, double &fx, double &fy) {
+            double cx = std::max(0.0, std::min<double>(max_x, x.at(i)));
+            double cy = std::max(0.0, std::min<double>(max_y, y.at(i)));
+            x0 = std::min(max_x - 1, int(cx));
+            y0 = std::min(max_y - 1, int(cy));
+            x0 = std::max(0, x0);
+            y0 = std::max(0, y0);
+            fx = std::max(0.0, std::min(1.0, cx - x0));
+            fy = std::max(0.0, std::min(1.0, cy - y0));
+        };
+        auto bin = [&](int bx, int by) -> int { return std::min(bx, max_x) * h + std::min(by, max_y); };
+        for (size_t i = 0; i < solve_cells.size(); i++) {
+            int x0, y0;
+            double fx, fy;
+            bin_weights(i, x0, y0, fx, fy);
+            double area = chain_size.count(solve_cells.at(i)->name) ? chain_size.at(solve_cells.at(i)->name) : 1;
+            density.at(bin(x0, y0)) += area * (1 - fx) * (1 - fy);
+            density.at(bin(x0 + 1, y0)) += area * fx * (1 - fy);
+            density.at(bin(x0, y0 + 1)) += area * (1 - fx) * fy;
+            density.at(bin(x0 + 1, y0 + 1)) += area * fx * fy;
+        }
+        double penalty = 0;
+        std::vector<double> over(w * h, 0.0);
+        for (int bx = 0; bx < w; bx++)
+            for (int by = 0; by < h; by++) {
+                double o = density.at(bin(bx, by)) - capacity.at(bx).at(by);
+                if (o > 0) {
+                    over.at(bin(bx, by)) = o;
+                    penalty += o * o;
+                }
+            }
+        for (size_t i = 0; i < solve_cells.size(); i++) {
+            int x0, y0;
+            double fx, fy;
+            bin_weights(i, x0, y0, fx, fy);
+            double area = chain_size.count(solve_cells.at(i)->name) ? chain_size.at(solve_cells.at(i)->name) : 1;
+            double o00 = over.at(bin(x0, y0)), o10 = over.at(bin(x0 + 1, y0)), o01 = over.at(bin(x0, y0 + 1)),
+                   o11 = over.at(bin(x0 + 1, y0 + 1));
+            gx.at(i) += 2 * area * ((o10 - o00) * (1 - fy) + (o11 - o01) * fy);
+            gy.at(i) += 2 * area * ((o01 - o00) * (1 - fx) + (o11 - o10) * fx);
+        }
+        return penalty;
+    }
+
+    // Limit continuous positions of solve_cells to the device and their constraint regions
+    void clamp_solve_positions(std::vector<double> &vx, std::vector<double> &vy)
+    {
+        for (size_t i = 0; i < solve_cells.size(); i++) {
+            Region *reg = solve_cells.at(i)->region;
+            vx.at(i) = limit_to_reg(reg, std::max(0.0, std::min<double>(max_x, vx.at(i))), false);
+            vy.at(i) = limit_to_reg(reg, std::max(0.0, std::min<double>(max_y, vy.at(i))), true);
+        }
+    }
+
+    // Minimise smooth wirelength, density penalty and (after the first iteration) pseudo-connections to the last
+    // legal positions with Nesterov's accelerated gradient method, using Barzilai-Borwein step sizes
+    void solve_smooth(int iter)
+    {
+        size_t n = solve_cells.size();
+        if (n == 0)
+            return;
+        setup_smooth_nets();
+        double gamma = std::max(0.5, cfg.smoothGamma / (1.0 + 0.2 * std::max(0, iter)));
+
+        // Capacity of each location for the cell types being solved
+        std::unordered_set<IdString> types;
+        for (auto cell : solve_cells)
+            types.insert(cell->type);
+        std::vector<std::vector<double>> capacity(max_x + 1, std::vector<double>(max_y + 1, 0.0));
+        for (auto type : types) {
+            if (!bel_types.count(type))
+                continue;
+            auto &fb = fast_bels.at(std::get<0>(bel_types.at(type)));
+            for (int x = 0; x < int(fb.size()); x++)
+                for (int y = 0; y < int(fb.at(x).size()); y++)
+                    capacity.at(x).at(y) += cfg.beta * fb.at(x).at(y).size();
+        }
+
+        // Pseudo-connections to the last legal positions and, for cells of repeated instances, to the placement of
+        // their group's representative, weighted as in the quadratic solve
+        std::vector<double> ax(n, 0), ay(n, 0), anchor_x(n, 0), anchor_y(n, 0);
+        std::vector<double> mx(n, 0), my(n, 0), target_x(n, 0), target_y(n, 0);
+        if (iter != -1) {
+            for (size_t i = 0; i < n; i++) {
+                auto &cl = cell_locs.at(solve_cells.at(i)->name);
+                anchor_x.at(i) = cl.legal_x;
+                anchor_y.at(i) = cl.legal_y;
+                ax.at(i) = cfg.alpha * iter / std::max<double>(1, cfg.hpwl_scale_x * std::abs(cl.legal_x - cl.x));
+                ay.at(i) = cfg.alpha * iter / std::max<double>(1, cfg.hpwl_scale_y * std::abs(cl.legal_y - cl.y));
+                auto fnd = macro_targets.find(solve_cells.at(i)->name);
+                if (fnd == macro_targets.end())
+                    continue;
+                target_x.at(i) = fnd->second.first;
+                target_y.at(i) = fnd->second.second;
+                mx.at(i) = cfg.alpha * iter / std::max<double>(1, cfg.hpwl_scale_x * std::abs(target_x.at(i) - cl.x));
+                my.at(i) = cfg.alpha * iter / std::max<double>(1, cfg.hpwl_scale_y * std::abs(target_y.at(i) - cl.y));
+            }
+        }
+
+        std::vector<double> x(n), y(n);
+        for (size_t i = 0; i < n; i++) {
+            x.at(i) = cell_locs.at(solve_cells.at(i)->name).x;
+            y.at(i) = cell_locs.at(solve_cells.at(i)->name).y;
+        }
+
+        double lambda = -1;
+        auto gradient = [&](const std::vector<double> &vx, const std::vector<double> &vy, std::vector<double> &gx,
+                            std::vector<double> &gy) {
+            std::fill(gx.begin(), gx.end(), 0.0);
+            std::fill(gy.begin(), gy.end(), 0.0);
+            smooth_wirelength_grad(vx, false, gamma, gx);
+            smooth_wirelength_grad(vy, true, gamma, gy);
+            std::vector<double> dgx(n, 0.0), dgy(n, 0.0);
+            density_penalty_grad(vx, vy, capacity, dgx, dgy);
+            if (lambda < 0) {
+                // Balance the initial density gradient against the wirelength gradient
+                double wl_norm = 0, d_norm = 0;
+                for (size_t i = 0; i < n; i++) {
+                    wl_norm += std::abs(gx.at(i)) + std::abs(gy.at(i));
+                    d_norm += std::abs(dgx.at(i)) + std::abs(dgy.at(i));
+                }
+                lambda = (d_norm > 0) ? cfg.densityWeight * (1 + std::max(0, iter)) * wl_norm / d_norm : 0;
+            }
+            for (size_t i = 0; i < n; i++) {
+                gx.at(i) += lambda * dgx.at(i) + ax.at(i) * (vx.at(i) - anchor_x.at(i)) +
+                            mx.at(i) * (vx.at(i) - target_x.at(i));
+                gy.at(i) += lambda * dgy.at(i) + ay.at(i) * (vy.at(i) - anchor_y.at(i)) +
+                            my.at(i) * (vy.at(i) - target_y.at(i));
+            }
+        };
+
+        std::vector<double> vx(x), vy(y), gx(n), gy(n), prev_vx, prev_vy, prev_gx, prev_gy;
+        double a = 1;
+        for (int k = 0; k < cfg.smoothIters; k++) {
+            gradient(vx, vy, gx, gy);
+            double step;
+            if (k == 0) {
+                double gmax = 0;
+                for (size_t i = 0; i < n; i++)
+                    gmax = std::max(gmax, std::max(std::abs(gx.at(i)), std::abs(gy.at(i))));
+                step = (gmax > 0) ? 1.0 / gmax : 0;
+            } else {
+                double dxx = 0, dgg = 0;
+                for (size_t i = 0; i < n; i++) {
+                    dxx += (vx.at(i) - prev_vx.at(i)) * (vx.at(i) - prev_vx.at(i)) +
+                           (vy.at(i) - prev_vy.at(i)) * (vy.at(i) - prev_vy.at(i));
+                    dgg += (gx.at(i) - prev_gx.at(i)) * (gx.at(i) - prev_gx.at(i)) +
+                           (gy.at(i) - prev_gy.at(i)) * (gy.at(i) - prev_gy.at(i));
+                }
+                if (dgg <= 0)
+                    break;
+                step = std::sqrt(dxx / dgg);
+            }
+            if (step <= 0)
+                break;
+            prev_vx = vx;
+            prev_vy = vy;
+            prev_gx = gx;
+            prev_gy = gy;
+            std::vector<double> nx(n), ny(n);
+            for (size_t i = 0; i < n; i++) {
+                nx.at(i) = vx.at(i) - step * gx.at(i);
+                ny.at(i) = vy.at(i) - step * gy.at(i);
+            }
+            clamp_solve_positions(nx, ny);
+            double a_next = (1 + std::sqrt(4 * a * a + 1)) / 2;
+            double momentum = (a - 1) / a_next;
+            for (size_t i = 0; i < n; i++) {
+                vx.at(i) = nx.at(i) + momentum * (nx.at(i) - x.at(i));
+                vy.at(i) = ny.at(i) + momentum * (ny.at(i) - y.at(i));
+            }
+            clamp_solve_positions(vx, vy);
+            x.swap(nx);
+            y.swap(ny);
+            a = a_next;
+        }
+
+        for (size_t i = 0; i < n; i++) {
+            auto &cl = cell_locs.at(solve_cells.at(i)->name);
+            cl.rawx = x.at(i);
+            cl.rawy = y.at(i);
+            cl.x = std::min(max_x, std::max(0, int(x.at(i))));
+            cl.y = std::min(max_y, std::max(0, int(y.at(i))));
+        }
+    }
+
+    // Electrostatic global placement, after ePlace. The cells of each type are positive charges in a field of their
+    // own, in which the bels of that type form a background of negative charge; the sum of smooth wirelength and
+    // lambda times the potential energy of all fields is minimised with Nesterov's method, starting from the current
+    // placement. Positions are in tiles, with one bin per tile
+    void electrostatic_place()
+    {
+        setup_solve_cells();
+        size_t n = solve_cells.size();
+        if (n == 0)
+            return;
+        setup_smooth_nets();
+
+        int width = 1, height = 1;
+        while (width < max_x + 1)
+            width <<= 1;
+        while (height < max_y + 1)
+            height <<= 1;
+
+        std::vector<IdString> types;
+        std::unordered_map<IdString, int> type_index;
+        std::vector<int> cell_type(n);
+        std::vector<double> area(n), pins(n, 0.0);
+        for (size_t i = 0; i < n; i++) {
+            CellInfo *cell = solve_cells.at(i);
+            if (!type_index.count(cell->type)) {
+                type_index[cell->type] = int(types.size());
+                types.push_back(cell->type);
+            }
+            cell_type.at(i) = type_index.at(cell->type);
+            area.at(i) = chain_size.count(cell->name) ? chain_size.at(cell->name) : 1;
+        }
+        for (auto &sn : smooth_nets)
+            for (auto &pin : sn.pins)
+                if (pin.row != -1)
+                    pins.at(pin.row) += 1;
+
+        int nt = int(types.size());
+        std::vector<ElectrostaticField> fields(nt, ElectrostaticField(width, height));
+        std::vector<std::vector<double>> capacity(nt, std::vector<double>(width * height, 0.0));
+        std::vector<double> target(nt, 0.0), demand(nt, 0.0);
+        for (int t = 0; t < nt; t++) {
+            double total_cap = 0;
+            if (bel_types.count(types.at(t))) {
+                auto &fb = fast_bels.at(std::get<0>(bel_types.at(types.at(t))));
+                for (int x = 0; x < int(fb.size()); x++)
+                    for (int y = 0; y < int(fb.at(x).size()); y++) {
+                        capacity.at(t).at(x * height + y) = fb.at(x).at(y).size();
+                        total_cap += fb.at(x).at(y).size();
+                    }
+            }
+            for (size_t i = 0; i < n; i++)
+                if (cell_type.at(i) == t)
+                    demand.at(t) += area.at(i);
+            // Cells are spread to a uniform utilisation of the available bels
+            target.at(t) = (total_cap > 0) ? std::min(1.0, demand.at(t) / total_cap) : 0;
+        }
+        double total_demand = std::accumulate(demand.begin(), demand.end(), 0.0);
+
+        // Bilinear weights of a cell position between the centres of the four nearest bins
+        auto bin_weights = [&](double px, double py, int &x0, int &y0, int &x1, int &y1, double &fx, double &fy) {
+            double cx = std::max(0.0, std::min<double>(max_x, px));
+            double cy = std::max(0.0, std::min<double>(max_y, py));
+            x0 = int(cx);
+            y0 = int(cy);
+            x1 = std::min(x0 + 1, width - 1);
+            y1 = std::min(y0 + 1, height - 1);
+            fx = cx - x0;
+            fy = cy - y0;
+        };
+
+        // Set up the charge density of each field, solve them and return the overflowing fraction of cell area
+        auto solve_fields = [&](const std::vector<double> &vx, const std::vector<double> &vy) {
+            std::vector<std::vector<double>> cell_density(nt, std::vector<double>(width * height, 0.0));
+            for (size_t i = 0; i < n; i++) {
+                int x0, y0, x1, y1;
+                double fx, fy;
+                bin_weights(vx.at(i), vy.at(i), x0, y0, x1, y1, fx, fy);
+                auto &d = cell_density.at(cell_type.at(i));
+                double a = area.at(i);
+                d.at(x0 * height + y0) += a * (1 - fx) * (1 - fy);
+                d.at(x1 * height + y0) += a * fx * (1 - fy);
+                d.at(x0 * height + y1) += a * (1 - fx) * fy;
+                d.at(x1 * height + y1) += a * fx * fy;
+            }
+            double overflow = 0;
+            for (int t = 0; t < nt; t++) {
+                auto &f = fields.at(t);
+                for (int b = 0; b < width * height; b++) {
+                    double d = cell_density.at(t).at(b), cap = capacity.at(t).at(b);
+                    f.density.at(b) = d - target.at(t) * cap;
+                    overflow += std::max(0.0, d - cap);
+                }
+                f.solve();
+            }
+            return (total_demand > 0) ? overflow / total_demand : 0;
+        };
+
+        // Gradients of wirelength and of potential energy (-q * E)
+        auto gradients = [&](const std::vector<double> &vx, const std::vector<double> &vy, double gamma,
+                             std::vector<double> &wgx, std::vector<double> &wgy, std::vector<double> &dgx,
+                             std::vector<double> &dgy) {
+            std::fill(wgx.begin(), wgx.end(), 0.0);
+            std::fill(wgy.begin(), wgy.end(), 0.0);
+            double wl = smooth_wirelength_grad(vx, false, gamma, wgx) + smooth_wirelength_grad(vy, true, gamma, wgy);
+            for (size_t i = 0; i < n; i++) {
+                int x0, y0, x1, y1;
+                double fx, fy;
+                bin_weights(vx.at(i), vy.at(i), x0, y0, x1, y1, fx, fy);
+                auto &f = fields.at(cell_type.at(i));
+                auto sample = [&](const std::vector<double> &e) {
+                    return e.at(x0 * height + y0) * (1 - fx) * (1 - fy) + e.at(x1 * height + y0) * fx * (1 - fy) +
+                           e.at(x0 * height + y1) * (1 - fx) * fy + e.at(x1 * height + y1) * fx * fy;
+                };
+                dgx.at(i) = -area.at(i) * sample(f.field_x);
+                dgy.at(i) = -area.at(i) * sample(f.field_y);
+            }
+            return wl;
+        };
+
+        // Smoothing parameter as a function of overflow, from ePlace: coarse while cells are clumped, fine once they
+        // have been spread
+        auto gamma_for = [&](double overflow) {
+            return std::max(0.25, cfg.smoothGamma * std::pow(10.0, (20.0 * overflow - 11.0) / 9.0));
+        };
+
+        std::vector<double> ux(n), uy(n);
+        for (size_t i = 0; i < n; i++) {
+            auto &cl = cell_locs.at(solve_cells.at(i)->name);
+            ux.at(i) = cl.rawx;
+            uy.at(i) = cl.rawy;
+        }
+        clamp_solve_positions(ux, uy);
+
+        std::vector<double> vx(ux), vy(uy), wgx(n), wgy(n), dgx(n), dgy(n), gx(n), gy(n);
+        std::vector<double> prev_vx, prev_vy, prev_gx, prev_gy;
+        double overflow = solve_fields(vx, vy);
+        double gamma = gamma_for(overflow);
+        double lambda = -1, a = 1, step = 0, wl = 0;
+        log_info("Running electrostatic global placement on a %dx%d grid for %d cells.\n", width, height, int(n));
+        int iter = 0;
+        for (; iter < cfg.eplaceMaxIters && overflow > cfg.eplaceTargetOverflow; iter++) {
+            wl = gradients(vx, vy, gamma, wgx, wgy, dgx, dgy);
+            if (lambda < 0) {
+                double wl_norm = 0, d_norm = 0;
+                for (size_t i = 0; i < n; i++) {
+                    wl_norm += std::abs(wgx.at(i)) + std::abs(wgy.at(i));
+                    d_norm += std::abs(dgx.at(i)) + std::abs(dgy.at(i));
+                }
+                lambda = (d_norm > 0) ? wl_norm / d_norm : 1;
+            }
+            // Jacobi preconditioning by pin count and charge, as in ePlace
+            double gmax = 0;
+            for (size_t i = 0; i < n; i++) {
+                double precond = std::max(1.0, pins.at(i) + lambda * area.at(i));
+                gx.at(i) = (wgx.at(i) + lambda * dgx.at(i)) / precond;
+                gy.at(i) = (wgy.at(i) + lambda * dgy.at(i)) / precond;
+                gmax = std::max(gmax, std::max(std::abs(gx.at(i)), std::abs(gy.at(i))));
+            }
+            if (gmax == 0)
+                break;
+            if (iter == 0) {
+                step = 1.0 / gmax;
+            } else {
+                double dxx = 0, dgg = 0;
+                for (size_t i = 0; i < n; i++) {
+                    dxx += (vx.at(i) - prev_vx.at(i)) * (vx.at(i) - prev_vx.at(i)) +
+                           (vy.at(i) - prev_vy.at(i)) * (vy.at(i) - prev_vy.at(i));
+                    dgg += (gx.at(i) - prev_gx.at(i)) * (gx.at(i) - prev_gx.at(i)) +
+                           (gy.at(i) - prev_gy.at(i)) * (gy.at(i) - prev_gy.at(i));
+                }
+                // Barzilai-Borwein step, limited to moving any cell by a few tiles
+                if (dgg > 0)
+                    step = std::min(std::sqrt(dxx / dgg), 4.0 / gmax);
+            }
+            prev_vx = vx;
+            prev_vy = vy;
+            prev_gx = gx;
+            prev_gy = gy;
+
+            std::vector<double> nx(n), ny(n);
+            for (size_t i = 0; i < n; i++) {
+                nx.at(i) = vx.at(i) - step * gx.at(i);
+                ny.at(i) = vy.at(i) - step * gy.at(i);
+            }
+            clamp_solve_positions(nx, ny);
+            double a_next = (1 + std::sqrt(4 * a * a + 1)) / 2;
+            double momentum = (a - 1) / a_next;
+            for (size_t i = 0; i < n; i++) {
+                vx.at(i) = nx.at(i) + momentum * (nx.at(i) - ux.at(i));
+                vy.at(i) = ny.at(i) + momentum * (ny.at(i) - uy.at(i));
+            }
+            clamp_solve_positions(vx, vy);
+            ux.swap(nx);
+            uy.swap(ny);
+            a = a_next;
+
+            overflow = solve_fields(vx, vy);
+            gamma = gamma_for(overflow);
+            lambda *= 1.05;
+            if (iter % 50 == 0)
+                log_info("    at electrostatic iter %d, overflow = %.03f, smooth wirelen = %.0f\n", iter, overflow,
+                         wl);
+            ctx->yield();
+        }
+        log_info("    electrostatic placement finished after %d iterations, overflow = %.03f\n", iter, overflow);
+
+        for (size_t i = 0; i < n; i++) {
+            auto &cl = cell_locs.at(solve_cells.at(i)->name);
+            cl.rawx = ux.at(i);
+            cl.rawy = uy.at(i);
+            cl.x = std::min(max_x, std::max(0, int(ux.at(i) + 0.5)));
+            cl.y = std::min(max_y, std::max(0, int(uy.at(i) + 0.5)));
+        }
+        update_all_chains();
+    }
+
     // Compute HPWL
     wirelen_t total_hpwl()
     {
@@ -776,6 +1682,294 @@ class HeAPPlacer
         return hpwl;
     }
 
+    // Collect the leaf cells of a hierarchical cell and its children, with names relative to it
+    void collect_hier_cells(IdString path, const std::string &prefix,
+                            std::vector<std::pair<std::string, CellInfo *>> &out)
+    {
+        auto &hc = ctx->hierarchy.at(path);
+        for (auto &lc : sorted_ref(hc.leaf_cells)) {
+            auto fnd = ctx->cells.find(lc.second);
+            if (fnd != ctx->cells.end())
+                out.emplace_back(prefix + lc.first.str(ctx), fnd->second.get());
+        }
+        for (auto &sc : sorted_ref(hc.hier_cells))
+            if (ctx->hierarchy.count(sc.second))
+                collect_hier_cells(sc.second, prefix + sc.first.str(ctx) + "/", out);
+    }
+
+    // Find groups of hierarchical instances with identical contents and internal connectivity
+    void find_repeated_instances()
+    {
+        ctx->fixupHierarchy();
+        std::unordered_map<IdString, std::string> signatures;
+        std::unordered_map<std::string, int> signature_count;
+        std::unordered_map<IdString, std::vector<CellInfo *>> contents;
+        std::unordered_map<CellInfo *, int> cell_index;
+        for (auto &h : sorted_ref(ctx->hierarchy)) {
+            if (h.first == ctx->top_module)
+                continue;
+            std::vector<std::pair<std::string, CellInfo *>> cells;
+            collect_hier_cells(h.first, "", cells);
+            // Instances containing cells placed before the analytic placer (by constraints, or as IO) cannot be moved
+            // as a unit, so all the cells counted here are movable
+            if (std::any_of(cells.begin(), cells.end(),
+                            [](const std::pair<std::string, CellInfo *> &c) { return c.second->bel != BelId(); }))
+                continue;
+            if (int(cells.size()) < cfg.reuseHierarchyMinCells)
+                continue;
+            std::sort(cells.begin(), cells.end(),
+                      [](const std::pair<std::string, CellInfo *> &a, const std::pair<std::string, CellInfo *> &b) {
+                          return a.first < b.first;
+                      });
+            cell_index.clear();
+            for (int i = 0; i < int(cells.size()); i++)
+                cell_index[cells.at(i).second] = i;
+            // Instances are moved by a fixed offset, which would break the relative constraints of a macro (such as
+            // a carry chain) that crosses the instance boundary
+            if (std::any_of(cells.begin(), cells.end(), [&](const std::pair<std::string, CellInfo *> &c) {
+                    return (c.second->constr_parent != nullptr && !cell_index.count(c.second->constr_parent)) ||
+                           std::any_of(c.second->constr_children.begin(), c.second->constr_children.end(),
+                                       [&](CellInfo *child) { return !cell_index.count(child); });
+                }))
+                continue;
+            // The signature covers the module type, relative names and types of cells and their macro constraints
+            // and, for every port, whether it connects to the same relative driver inside the instance
+            std::string sig = h.second.type.str(ctx);
+            for (auto &c : cells) {
+                sig += "|" + c.first + ":" + c.second->type.str(ctx);
+                if (c.second->constr_parent != nullptr)
+                    sig += " @" + std::to_string(cell_index.at(c.second->constr_parent)) + "," +
+                           std::to_string(c.second->constr_x) + "," + std::to_string(c.second->constr_y) + "," +
+                           std::to_string(c.second->constr_z) + (c.second->constr_abs_z ? "a" : "");
+                for (auto &port : sorted_ref(c.second->ports)) {
+                    NetInfo *ni = port.second.net;
+                    sig += " " + port.first.str(ctx) + "=";
+                    if (ni == nullptr) {
+                        sig += "-";
+                    } else if (ni->driver.cell != nullptr && cell_index.count(ni->driver.cell)) {
+                        sig += std::to_string(cell_index.at(ni->driver.cell)) + "." + ni->driver.port.str(ctx);
+                    } else {
+                        sig += "x";
+                    }
+                }
+            }
+            signature_count[sig]++;
+            signatures[h.first] = sig;
+            auto &cv = contents[h.first];
+            for (auto &c : cells)
+                cv.push_back(c.second);
+        }
+
+        // Take the outermost repeated instances, descending into the hierarchy only where no match was found
+        std::map<std::string, std::vector<RepeatedInstance>> groups;
+        std::queue<IdString> visit;
+        visit.push(ctx->top_module);
+        while (!visit.empty()) {
+            IdString path = visit.front();
+            visit.pop();
+            auto fnd = signatures.find(path);
+            if (fnd != signatures.end() && signature_count.at(fnd->second) > 1) {
+                RepeatedInstance inst;
+                inst.path = path;
+                inst.cells = contents.at(path);
+                groups[fnd->second].push_back(inst);
+                continue;
+            }
+            for (auto &sc : sorted_ref(ctx->hierarchy.at(path).hier_cells))
+                if (ctx->hierarchy.count(sc.second))
+                    visit.push(sc.second);
+        }
+        int total_instances = 0;
+        for (auto &g : groups) {
+            if (g.second.size() < 2)
+                continue;
+            total_instances += int(g.second.size());
+            repeated_groups.push_back(g.second);
+            group_representative.push_back(0);
+        }
+        if (!repeated_groups.empty())
+            log_info("Found %d groups of repeated hierarchical instances (%d instances in total).\n",
+                     int(repeated_groups.size()), total_instances);
+    }
+
+    // Get the mean location and bounding box half perimeter of an instance, from cell_locs
+    std::pair<int, int> instance_anchor(const RepeatedInstance &inst, int *spread = nullptr)
+    {
+        int64_t sx = 0, sy = 0;
+        int x0 = std::numeric_limits<int>::max(), y0 = x0, x1 = std::numeric_limits<int>::min(), y1 = x1;
+        for (auto cell : inst.cells) {
+            auto &cl = cell_locs.at(cell->name);
+            sx += cl.x;
+            sy += cl.y;
+            x0 = std::min(x0, cl.x);
+            x1 = std::max(x1, cl.x);
+            y0 = std::min(y0, cl.y);
+            y1 = std::max(y1, cl.y);
+        }
+        if (inst.cells.empty()) {
+            if (spread != nullptr)
+                *spread = 0;
+            return std::make_pair(0, 0);
+        }
+        if (spread != nullptr)
+            *spread = cfg.hpwl_scale_x * (x1 - x0) + cfg.hpwl_scale_y * (y1 - y0);
+        int n = int(inst.cells.size());
+        return std::make_pair(int(sx / n), int(sy / n));
+    }
+
+    // After legalisation, pick the most compact instance of each group as its representative, and set the soft
+    // macro targets of all other instances to the representative's relative placement around their own anchor
+    void update_macro_targets()
+    {
+        macro_targets.clear();
+        for (size_t g = 0; g < repeated_groups.size(); g++) {
+            auto &group = repeated_groups.at(g);
+            int best_spread = std::numeric_limits<int>::max();
+            for (int i = 0; i < int(group.size()); i++) {
+                int spread;
+                instance_anchor(group.at(i), &spread);
+                if (spread < best_spread) {
+                    best_spread = spread;
+                    group_representative.at(g) = i;
+                }
+            }
+            auto &rep = group.at(group_representative.at(g));
+            auto rep_anchor = instance_anchor(rep);
+            for (int i = 0; i < int(group.size()); i++) {
+                if (i == group_representative.at(g))
+                    continue;
+                auto &inst = group.at(i);
+                auto anchor = instance_anchor(inst);
+                for (size_t j = 0; j < inst.cells.size(); j++) {
+                    auto &rl = cell_locs.at(rep.cells.at(j)->name);
+                    macro_targets[inst.cells.at(j)->name] =
+                            std::make_pair(std::max(0, std::min(max_x, anchor.first + rl.x - rep_anchor.first)),
+                                           std::max(0, std::min(max_y, anchor.second + rl.y - rep_anchor.second)));
+                }
+            }
+        }
+    }
+
+    // HPWL of a net, from the bound bels of its cells
+    wirelen_t bound_net_hpwl(NetInfo *ni)
+    {
+        if (ni->driver.cell == nullptr || ni->driver.cell->bel == BelId() || ctx->getBelGlobalBuf(ni->driver.cell->bel))
+            return 0;
+        Loc dl = ctx->getBelLocation(ni->driver.cell->bel);
+        int xmin = dl.x, xmax = dl.x, ymin = dl.y, ymax = dl.y;
+        for (auto &user : ni->users) {
+            if (user.cell->bel == BelId())
+                continue;
+            Loc ul = ctx->getBelLocation(user.cell->bel);
+            xmin = std::min(xmin, ul.x);
+            xmax = std::max(xmax, ul.x);
+            ymin = std::min(ymin, ul.y);
+            ymax = std::max(ymax, ul.y);
+        }
+        return cfg.hpwl_scale_x * (xmax - xmin) + cfg.hpwl_scale_y * (ymax - ymin);
+    }
+
+    // Try to move an instance to an exact copy of the representative's relative placement, at the given anchor.
+    // Only free bels are used; the move is undone if it is invalid or increases wirelength too much.
+    bool try_replicate(const RepeatedInstance &rep, Loc rep_anchor, const RepeatedInstance &inst, Loc anchor,
+                       const std::vector<NetInfo *> &nets)
+    {
+        std::unordered_set<CellInfo *> inst_cells(inst.cells.begin(), inst.cells.end());
+        std::vector<BelId> targets;
+        for (size_t i = 0; i < inst.cells.size(); i++) {
+            CellInfo *ci = inst.cells.at(i);
+            Loc rl = ctx->getBelLocation(rep.cells.at(i)->bel);
+            Loc tl(anchor.x + rl.x - rep_anchor.x, anchor.y + rl.y - rep_anchor.y, rl.z);
+            if (tl.x < 0 || tl.x > max_x || tl.y < 0 || tl.y > max_y)
+                return false;
+            BelId bel = ctx->getBelByLocation(tl);
+            if (bel == BelId() || ctx->getBelType(bel) != ci->type)
+                return false;
+            CellInfo *bound = ctx->getBoundBelCell(bel);
+            if (bound != nullptr && !inst_cells.count(bound))
+                return false;
+            if (ci->region != nullptr && ci->region->constr_bels && !ctx->isBelInRegion(ci->region, bel))
+                return false;
+            targets.push_back(bel);
+        }
+        wirelen_t old_wirelen = 0, new_wirelen = 0;
+        for (auto ni : nets)
+            old_wirelen += bound_net_hpwl(ni);
+        std::vector<std::pair<BelId, PlaceStrength>> old_bels;
+        for (auto ci : inst.cells) {
+            old_bels.emplace_back(ci->bel, ci->belStrength);
+            ctx->unbindBel(ci->bel);
+        }
+        for (size_t i = 0; i < inst.cells.size(); i++)
+            ctx->bindBel(targets.at(i), inst.cells.at(i), old_bels.at(i).second);
+        bool valid = true;
+        for (size_t i = 0; i < inst.cells.size() && valid; i++)
+            valid = ctx->isBelLocationValid(targets.at(i)) && ctx->isBelLocationValid(old_bels.at(i).first);
+        if (valid) {
+            for (auto ni : nets)
+                new_wirelen += bound_net_hpwl(ni);
+            // Regularity is worth a small wirelength penalty
+            valid = new_wirelen <= old_wirelen + old_wirelen / 10;
+        }
+        if (!valid) {
+            for (auto ci : inst.cells)
+                ctx->unbindBel(ci->bel);
+            for (size_t i = 0; i < inst.cells.size(); i++)
+                ctx->bindBel(old_bels.at(i).first, inst.cells.at(i), old_bels.at(i).second);
+            return false;
+        }
+        for (auto ci : inst.cells) {
+            Loc loc = ctx->getBelLocation(ci->bel);
+            cell_locs[ci->name].x = loc.x;
+            cell_locs[ci->name].y = loc.y;
+        }
+        return true;
+    }
+
+    // Replicate the legal placement of each group's representative onto the other instances, near the locations
+    // the analytic placer chose for them
+    void replicate_instances()
+    {
+        for (auto cell : sorted(ctx->cells)) {
+            Loc loc = ctx->getBelLocation(cell.second->bel);
+            cell_locs[cell.first].x = loc.x;
+            cell_locs[cell.first].y = loc.y;
+        }
+        update_macro_targets();
+        int replicated = 0, total = 0;
+        for (size_t g = 0; g < repeated_groups.size(); g++) {
+            auto &group = repeated_groups.at(g);
+            auto &rep = group.at(group_representative.at(g));
+            auto ra = instance_anchor(rep);
+            Loc rep_anchor(ra.first, ra.second, 0);
+            for (int i = 0; i < int(group.size()); i++) {
+                if (i == group_representative.at(g))
+                    continue;
+                ++total;
+                auto &inst = group.at(i);
+                std::set<NetInfo *> net_set;
+                for (auto ci : inst.cells)
+                    for (auto &port : ci->ports)
+                        if (port.second.net != nullptr)
+                            net_set.insert(port.second.net);
+                std::vector<NetInfo *> nets(net_set.begin(), net_set.end());
+                auto a = instance_anchor(inst);
+                // Search outwards from the anchor for a free footprint
+                bool done = false;
+                for (int r = 0; r <= 2 && !done; r++)
+                    for (int dx = -r; dx <= r && !done; dx++)
+                        for (int dy = -r; dy <= r && !done; dy++) {
+                            if (std::max(std::abs(dx), std::abs(dy)) != r)
+                                continue;
+                            done = try_replicate(rep, rep_anchor, inst, Loc(a.first + dx, a.second + dy, 0), nets);
+                        }
+                if (done)
+                    ++replicated;
+            }
+        }
+        log_info("Replicated representative placement onto %d/%d repeated instances.\n", replicated, total);
+    }
+
     // Strict placement legalisation, performed after the initial HeAP spreading
     void legalise_placement_strict(bool require_validity = false)
     {
@@ -910,7 +2104,7 @@ class HeAPPlacer
 
                 if (ci->constr_children.empty() && !ci->constr_abs_z) {
                     for (auto sz : fb.at(nx).at(ny)) {
-                        if (ci->region != nullptr && ci->region->constr_bels && !ci->region->bels.count(sz))
+                        if (ci->region != nullptr && ci->region->constr_bels && !ctx->isBelInRegion(ci->region, sz))
                             continue;
                         if (ctx->checkBelAvail(sz) || (radius > ripup_radius || ctx->rng(20000) < 10)) {
                             CellInfo *bound = ctx->getBoundBelCell(sz);
@@ -974,11 +2168,12 @@ class HeAPPlacer
                             Loc ploc = visit.front().second;
                             visit.pop();
                             BelId target = ctx->getBelByLocation(ploc);
-                            if (vc->region != nullptr && vc->region->constr_bels && !vc->region->bels.count(target))
-                                goto fail;
                             CellInfo *bound;
                             if (target == BelId() || ctx->getBelType(target) != vc->type)
                                 goto fail;
+                            if (vc->region != nullptr && vc->region->constr_bels &&
+                                !ctx->isBelInRegion(vc->region, target))
+                                goto fail;
                             bound = ctx->getBoundBelCell(target);
                             // Chains cannot overlap
                             if (bound != nullptr)
@@ -1728,6 +2923,12 @@ int HeAPPlacer::CutSpreader::seq = 0;
 
 bool placer_heap(Context *ctx, PlacerHeapCfg cfg) { return HeAPPlacer(ctx, cfg).place(); }
 
+bool placer_eplace(Context *ctx, PlacerHeapCfg cfg)
+{
+    cfg.electrostatic = true;
+    return HeAPPlacer(ctx, cfg).place();
+}
+
 PlacerHeapCfg::PlacerHeapCfg(Context *ctx)
 {
     alpha = ctx->setting<float>("placerHeap/alpha", 0.1);
@@ -1742,6 +2943,45 @@ PlacerHeapCfg::PlacerHeapCfg(Context *ctx)
     hpwl_scale_y = 1;
     spread_scale_x = 1;
     spread_scale_y = 1;
+
+    std::string net_model = str_or_default(ctx->settings, ctx->id("placerHeap/netModel"), "b2b");
+    if (net_model == "b2b")
+        netModel = NET_MODEL_B2B;
+    else if (net_model == "wa")
+        netModel = NET_MODEL_WA;
+    else if (net_model == "lse")
+        netModel = NET_MODEL_LSE;
+    else
+        log_error("HeAP net model '%s' is not supported (available options: b2b, wa, lse)\n", net_model.c_str());
+    smoothGamma = ctx->setting<float>("placerHeap/smoothGamma", 4.0);
+    smoothIters = ctx->setting<int>("placerHeap/smoothIters", 50);
+    densityWeight = ctx->setting<float>("placerHeap/densityWeight", 0.1);
+
+    electrostatic = false;
+    std::string refine_mode = str_or_default(ctx->settings, ctx->id("placerHeap/refine"), "sa");
+    if (refine_mode == "sa")
+        refine = REFINE_SA;
+    else if (refine_mode == "detail")
+        refine = REFINE_DETAIL;
+    else if (refine_mode == "none")
+        refine = REFINE_NONE;
+    else
+        log_error("HeAP refinement '%s' is not supported (available options: sa, detail, none)\n",
+                  refine_mode.c_str());
+    eplaceMaxIters = ctx->setting<int>("placerEplace/maxIters", 1000);
+    eplaceTargetOverflow = ctx->setting<float>("placerEplace/targetOverflow", 0.1);
+
+    std::string seed_mode = str_or_default(ctx->settings, ctx->id("placerHeap/seed"), "random");
+    if (seed_mode == "random")
+        seed = SEED_RANDOM;
+    else if (seed_mode == "cluster")
+        seed = SEED_CLUSTER;
+    else
+        log_error("HeAP seed '%s' is not supported (available options: random, cluster)\n", seed_mode.c_str());
+    seedClusters = ctx->setting<int>("placerHeap/seedClusters", 500);
+
+    reuseHierarchy = ctx->setting<bool>("placerHeap/reuseHierarchy", false);
+    reuseHierarchyMinCells = ctx->setting<int>("placerHeap/reuseHierarchyMinCells", 16);
 }
 
 NEXTPNR_NAMESPACE_END
@@ -1759,6 +2999,12 @@ bool placer_heap(Context *ctx, PlacerHeapCfg cfg)
     return false;
 }
 
+bool placer_eplace(Context *ctx, PlacerHeapCfg cfg)
+{
+    log_error("nextpnr was built without the HeAP placer\n");
+    return false;
+}
+
 PlacerHeapCfg::PlacerHeapCfg(Context *ctx) {}
 
 NEXTPNR_NAMESPACE_END
@@ -46,13 +46,65 @@ struct PlacerHeapCfg
     int hpwl_scale_x, hpwl_scale_y;
     int spread_scale_x, spread_scale_y;
 
+    // Wirelength model used for the analytic solve. B2B is the bound-to-bound quadratic model solved with CG; WA
+    // (weighted-average) and LSE (log-sum-exp) are smooth models minimised by Nesterov's method with a density
+    // penalty
+    enum NetModel
+    {
+        NET_MODEL_B2B,
+        NET_MODEL_WA,
+        NET_MODEL_LSE
+    } netModel;
+    // Smoothing parameter of the WA and LSE models, in tiles
+    float smoothGamma;
+    // Gradient steps per solve for the WA and LSE models
+    int smoothIters;
+    // Weight of the density penalty relative to wirelength, for the WA and LSE models
+    float densityWeight;
+
+    // Use electrostatic (ePlace-style) global placement in place of the iterative solve and spread loop; the result
+    // is legalised with the HeAP spreader and legaliser
+    bool electrostatic;
+    // Maximum number of Nesterov iterations of electrostatic placement
+    int eplaceMaxIters;
+    // Electrostatic placement stops once the fraction of overflowing cell area drops below this
+    float eplaceTargetOverflow;
+
+    // Refinement of the legalised placement: simulated annealing (placer1), the detailed placer, or none
+    enum Refine
+    {
+        REFINE_SA,
+        REFINE_DETAIL,
+        REFINE_NONE
+    } refine;
+
+    // Initial placement of the movable cells: random, or clustered from the connectivity of the netlist. A clustered
+    // seed is already spread, so the unconstrained initial solves are skipped and the first solve is anchored to it
+    enum Seed
+    {
+        SEED_RANDOM,
+        SEED_CLUSTER
+    } seed;
+    // Number of clusters that the netlist is coarsened to for the clustered seed
+    int seedClusters;
+
+    // Place repeated instances of the same hierarchical module with a common
+    // relative placement
+    bool reuseHierarchy;
+    // Minimum number of cells in a hierarchical instance for reuse
+    int reuseHierarchyMinCells;
+
     // These cell types will be randomly locked to prevent singular matrices
     std::unordered_set<IdString> ioBufTypes;
     // These cell types are part of the same unit (e.g. slices split into
     // components) so will always be spread together
     std::vector<std::unordered_set<IdString>> cellGroups;
+    // Extra weight of each net's connections, on top of timing (e.g. for power-driven placement); nets not listed
+    // have a weight of 1
+    std::unordered_map<IdString, float> netWeights;
 };
 
 extern bool placer_heap(Context *ctx, PlacerHeapCfg cfg);
+extern bool placer_eplace(Context *ctx, PlacerHeapCfg cfg);
 NEXTPNR_NAMESPACE_END
 #endif
@@ -106,6 +106,8 @@ struct Router1
 
     std::unordered_map<WireId, int> wireScores;
     std::unordered_map<NetInfo *, int> netScores;
+    // Regions whose routing constraints nets must follow, for the nets that have one
+    std::unordered_map<NetInfo *, const Region *> netRegions;
 
     int arcs_with_ripup = 0;
     int arcs_without_ripup = 0;
@@ -352,6 +354,7 @@ struct Router1
             net_names.push_back(net_it.first);
 
         ctx->sorted_shuffle(net_names);
+        ctx->prepareRegionRouting();
 
         for (IdString net_name : net_names) {
             NetInfo *net_info = ctx->nets.at(net_name).get();
@@ -359,6 +362,10 @@ struct Router1
             if (skip_net(net_info))
                 continue;
 
+            const Region *region = ctx->getNetRoutingRegion(net_info);
+            if (region != nullptr)
+                netRegions[net_info] = region;
+
             auto src_wire = ctx->getNetinfoSourceWire(net_info);
 
             if (src_wire == WireId())
@@ -457,6 +464,8 @@ struct Router1
         }
 
         ArcBounds bounds = ctx->getRouteBoundingBox(src_wire, dst_wire);
+        auto region_it = netRegions.find(net_info);
+        const Region *region = (region_it != netRegions.end()) ? region_it->second : nullptr;
 
         // unbind wires that are currently used exclusively by this arc
 
@@ -511,6 +520,9 @@ struct Router1
             queue.pop();
 
             for (auto pip : ctx->getPipsDownhill(qw.wire)) {
+                if (region != nullptr && !ctx->isPipInRegion(region, pip))
+                    continue;
+
                 delay_t next_delay = qw.delay + ctx->getPipDelay(pip).maxDelay();
                 delay_t next_penalty = qw.penalty;
                 delay_t next_bonus = qw.bonus;
@@ -826,6 +838,8 @@ bool router1(Context *ctx, const Router1Cfg &cfg)
         router.check();
 #endif
 
+        if (!router.netRegions.empty())
+            log_info("Constraining routing of %d nets to their regions.\n", int(router.netRegions.size()));
         log_info("Routing %d arcs.\n", int(router.arc_queue.size()));
 
         int iter_cnt = 0;
@@ -859,7 +873,12 @@ bool router1(Context *ctx, const Router1Cfg &cfg)
             arc_key arc = router.arc_queue_pop();
 
             if (!router.route_arc(arc, true)) {
-                log_warning("Failed to find a route for arc %d of net %s.\n", arc.user_idx, ctx->nameOf(arc.net_info));
+                if (router.netRegions.count(arc.net_info))
+                    log_warning("Failed to find a route for arc %d of net %s inside region '%s'.\n", arc.user_idx,
+                                ctx->nameOf(arc.net_info), ctx->nameOf(router.netRegions.at(arc.net_info)->name));
+                else
+                    log_warning("Failed to find a route for arc %d of net %s.\n", arc.user_idx,
+                                ctx->nameOf(arc.net_info));
 #ifndef NDEBUG
                 router.check();
                 ctx->check();
@@ -876,6 +895,9 @@ bool router1(Context *ctx, const Router1Cfg &cfg)
                  std::chrono::duration<float>(rend - rstart).count());
         log_info("Routing complete.\n");
         ctx->yield();
+        int region_violations = ctx->checkRegionRouting();
+        if (region_violations > 0)
+            log_error("%d nets were routed outside of their regions.\n", region_violations);
         log_info("Router1 time %.02fs\n", std::chrono::duration<float>(rend - rstart).count());
 
 #ifndef NDEBUG
@@ -28,6 +28,7 @@
 
 #include "router2.h"
 #include <algorithm>
+#include <array>
 #include <boost/container/flat_map.hpp>
 #include <chrono>
 #include <deque>
@@ -52,6 +53,8 @@ struct Router2
         ArcBounds bb;
         bool routed = false;
         float arc_crit = 0;
+        // Minimum routing delay, set by hold fixing
+        delay_t min_delay = 0;
     };
 
     // As we allow overlap at first; the nextpnr bind functions can't be used
@@ -66,6 +69,11 @@ struct Router2
         int total_route_us = 0;
         float max_crit = 0;
         int fail_count = 0;
+        // Number of pips rejected for being outside bb, to the left, right, below and above it; used to grow the
+        // bounding box in the directions where routing was actually blocked
+        int bb_blocked[4] = {0, 0, 0, 0};
+        // Region whose routing constraints the net must follow, or nullptr
+        const Region *region = nullptr;
     };
 
     struct WireScore
@@ -131,6 +139,8 @@ struct Router2
         // Populate per-net and per-arc structures at start of routing
         nets.resize(ctx->nets.size());
         nets_by_udata.resize(ctx->nets.size());
+        ctx->prepareRegionRouting();
+        int region_nets = 0;
         size_t i = 0;
         for (auto net : sorted(ctx->nets)) {
             NetInfo *ni = net.second;
@@ -145,6 +155,9 @@ struct Router2
             nets.at(i).bb.y1 = std::numeric_limits<int>::min();
             nets.at(i).cx = 0;
             nets.at(i).cy = 0;
+            nets.at(i).region = ctx->getNetRoutingRegion(ni);
+            if (nets.at(i).region != nullptr)
+                ++region_nets;
 
             if (ni->driver.cell != nullptr) {
                 Loc drv_loc = ctx->getBelLocation(ni->driver.cell->bel);
@@ -199,6 +212,8 @@ struct Router2
             nets.at(i).bb.y1 = std::min(nets.at(i).bb.y1 + cfg.bb_margin_y, ctx->getGridDimY());
             i++;
         }
+        if (region_nets > 0)
+            log_info("Constraining routing of %d nets to their regions.\n", region_nets);
     }
 
     dict<WireId, int> wire_to_idx;
@@ -255,6 +270,35 @@ struct Router2
 
     bool hit_test_pip(ArcBounds &bb, Loc l) { return l.x >= bb.x0 && l.x <= bb.x1 && l.y >= bb.y0 && l.y <= bb.y1; }
 
+    // Arcs that fail inside the net bounding box are retried with the box grown to twice and then four times its
+    // size, and finally without any bounding box
+    enum
+    {
+        BB_LEVEL_FULL = 3
+    };
+
+    ArcBounds escalated_bb(const ArcBounds &bb, int level)
+    {
+        if (level == 0)
+            return bb;
+        int scale = 1 << level;
+        int mx = (std::max(bb.x1 - bb.x0, 2) * (scale - 1)) / 2, my = (std::max(bb.y1 - bb.y0, 2) * (scale - 1)) / 2;
+        return ArcBounds(std::max(bb.x0 - mx, 0), std::max(bb.y0 - my, 0), std::min(bb.x1 + mx, ctx->getGridDimX()),
+                         std::min(bb.y1 + my, ctx->getGridDimY()));
+    }
+
+    void note_bb_blocked(PerNetData &nd, Loc l)
+    {
+        if (l.x < nd.bb.x0)
+            ++nd.bb_blocked[0];
+        else if (l.x > nd.bb.x1)
+            ++nd.bb_blocked[1];
+        if (l.y < nd.bb.y0)
+            ++nd.bb_blocked[2];
+        else if (l.y > nd.bb.y1)
+            ++nd.bb_blocked[3];
+    }
+
     double curr_cong_weight, hist_cong_weight, estimate_weight;
 
     struct ThreadContext
@@ -278,6 +322,9 @@ struct Router2
         // Thread bounding box
         ArcBounds bb;
 
+        // Number of arcs routed at each bounding box level, and that failed at all levels this thread could try
+        std::array<int, BB_LEVEL_FULL + 2> arcs_by_bb_level{};
+
         DeterministicRNG rng;
     };
 
@@ -382,6 +429,18 @@ struct Router2
         return (ctx->getDelayNS(ctx->estimateDelay(wd.w, sink)) / (1 + source_uses)) + cfg.ipin_cost_adder;
     }
 
+    // Penalty for an arc with a hold requirement, for the delay it is expected to fall short by if routed through
+    // the given wire
+    float hold_deficit_cost(const PerArcData &ad, delay_t delay, int wire, WireId sink)
+    {
+        if (ad.min_delay <= 0)
+            return 0;
+        delay_t expected = delay + (flat_wires[wire].w == sink ? 0 : ctx->estimateDelay(flat_wires[wire].w, sink));
+        if (expected >= ad.min_delay)
+            return 0;
+        return cfg.hold_weight * ctx->getDelayNS(ad.min_delay - expected);
+    }
+
     bool check_arc_routing(NetInfo *net, size_t usr)
     {
         auto &ad = nets.at(net->udata).arcs.at(usr);
@@ -652,8 +711,9 @@ struct Router2
     }
 #endif
 
-    ArcRouteResult route_arc(ThreadContext &t, NetInfo *net, size_t i, bool is_mt, bool is_bb = true)
+    ArcRouteResult route_arc(ThreadContext &t, NetInfo *net, size_t i, bool is_mt, int bb_level = 0)
     {
+        bool is_bb = bb_level < BB_LEVEL_FULL;
 
         auto &nd = nets[net->udata];
         auto &ad = nd.arcs[i];
@@ -698,6 +758,9 @@ struct Router2
         int backwards_limit = ctx->getBelGlobalBuf(net->driver.cell->bel)
                                       ? cfg.global_backwards_max_iter
                                       : (net->users.size() > 40 ? 20 * cfg.backwards_max_iter : cfg.backwards_max_iter);
+        // Backwards routing takes the first path found, which is no good for arcs that need a detour to meet hold
+        if (ad.min_delay > 0)
+            backwards_limit = 0;
         t.backwards_queue.push(wire_to_idx.at(dst_wire));
         while (!t.backwards_queue.empty() && backwards_iter < backwards_limit) {
             int cursor = t.backwards_queue.front();
@@ -734,6 +797,8 @@ struct Router2
                 did_something = true;
                 if (!ctx->checkPipAvail(uh) && ctx->getBoundPipNet(uh) != net)
                     continue;
+                if (nd.region != nullptr && !ctx->isPipInRegion(nd.region, uh))
+                    continue;
                 if (cpip != PipId() && cpip != uh)
                     continue; // don't allow multiple pips driving a wire with a net
                 int next = wire_to_idx.at(ctx->getPipSrcWire(uh));
@@ -781,14 +846,18 @@ struct Router2
         WireScore base_score;
         base_score.cost = 0;
         base_score.delay = ctx->getWireDelay(src_wire).maxDelay();
-        base_score.togo_cost = get_togo_cost(net, i, src_wire_idx, dst_wire);
+        base_score.togo_cost = get_togo_cost(net, i, src_wire_idx, dst_wire) +
+                               hold_deficit_cost(ad, base_score.delay, src_wire_idx, dst_wire);
 
         // Add source wire to queue
         t.queue.push(QueuedWire(src_wire_idx, PipId(), Loc(), base_score));
         set_visited(t, src_wire_idx, PipId(), base_score);
 
-        int toexplore = 250000 * std::max(1, (ad.bb.x1 - ad.bb.x0) + (ad.bb.y1 - ad.bb.y0));
-        int iter = 0;
+        ArcBounds search_bb = escalated_bb(nd.bb, is_bb ? bb_level : 0);
+        // In 64 bits, as the limit for a wide arc at a high escalation level doesn't fit in an int
+        int64_t toexplore =
+                int64_t(250000) * std::max(1, (ad.bb.x1 - ad.bb.x0) + (ad.bb.y1 - ad.bb.y0)) * (int64_t(1) << bb_level);
+        int64_t iter = 0;
         int explored = 1;
         bool debug_arc = /*usr.cell->type.str(ctx).find("RAMB") != std::string::npos && (usr.port ==
                             ctx->id("ADDRATIEHIGH0") || usr.port == ctx->id("ADDRARDADDRL0"))*/
@@ -823,10 +892,19 @@ struct Router2
                 if (is_bb && !hit_test_pip(ad.bb, ctx->getPipLocation(dh)) && wire_intent != ID_PSEUDO_GND && wire_intent != ID_PSEUDO_VCC)
                     continue;
 #else
-                if (is_bb && !hit_test_pip(nd.bb, ctx->getPipLocation(dh)))
-                    continue;
+                if (is_bb) {
+                    Loc pip_loc = ctx->getPipLocation(dh);
+                    if (!hit_test_pip(search_bb, pip_loc)) {
+                        if (bb_level == 0)
+                            note_bb_blocked(nd, pip_loc);
+                        continue;
+                    }
+                }
                 if (!ctx->checkPipAvail(dh) && ctx->getBoundPipNet(dh) != net)
                     continue;
+                // Keep the routing of nets inside a region with routing constraints
+                if (nd.region != nullptr && !ctx->isPipInRegion(nd.region, dh))
+                    continue;
 #endif
                 // Evaluate score of next wire
                 WireId next = ctx->getPipDstWire(dh);
@@ -850,7 +928,8 @@ struct Router2
                 next_score.cost = curr.score.cost + score_wire_for_arc(net, i, next, dh);
                 next_score.delay =
                         curr.score.delay + ctx->getPipDelay(dh).maxDelay() + ctx->getWireDelay(next).maxDelay();
-                next_score.togo_cost = cfg.estimate_weight * get_togo_cost(net, i, next_idx, dst_wire);
+                next_score.togo_cost = cfg.estimate_weight * get_togo_cost(net, i, next_idx, dst_wire) +
+                                       hold_deficit_cost(ad, next_score.delay, next_idx, dst_wire);
                 const auto &v = nwd.visit;
                 if (!v.visited || (v.score.total() > next_score.total())) {
                     ++explored;
@@ -862,7 +941,9 @@ struct Router2
                     t.queue.push(QueuedWire(next_idx, dh, ctx->getPipLocation(dh), next_score, t.rng.rng()));
                     set_visited(t, next_idx, dh, next_score);
                     if (next == dst_wire) {
-                        toexplore = std::min(toexplore, iter + 5);
+                        // Arcs with a hold requirement keep searching for a while, for a detour that removes the
+                        // deficit
+                        toexplore = std::min<int64_t>(toexplore, iter + (ad.min_delay > 0 ? 5000 : 5));
                         must_drain_queue = false;
                     }
                 }
@@ -933,24 +1014,38 @@ struct Router2
             t.route_arcs.push_back(i);
         }
         for (auto i : t.route_arcs) {
-            auto res1 = route_arc(t, net, i, is_mt, true);
+            auto res1 = route_arc(t, net, i, is_mt, 0);
             if (res1 == ARC_FATAL)
                 return false; // Arc failed irrecoverably
             else if (res1 == ARC_RETRY_WITHOUT_BB) {
                 if (is_mt) {
                     // Can't break out of bounding box in multi-threaded mode, so mark this arc as a failure
                     have_failures = true;
+                    ++t.arcs_by_bb_level.at(BB_LEVEL_FULL + 1);
                 } else {
-                    // Attempt a re-route without the bounding box constraint
-                    ROUTE_LOG_DBG("Rerouting arc %d of net '%s' without bounding box, possible tricky routing...\n",
-                                  int(i), ctx->nameOf(net));
-                    auto res2 = route_arc(t, net, i, is_mt, false);
+                    // Escalate the bounding box stepwise, only searching the whole device as a last resort
+                    auto res2 = res1;
+                    int level = 1;
+                    for (; level <= BB_LEVEL_FULL && res2 == ARC_RETRY_WITHOUT_BB; level++) {
+                        ROUTE_LOG_DBG("Rerouting arc %d of net '%s' with bounding box level %d, possible tricky "
+                                      "routing...\n",
+                                      int(i), ctx->nameOf(net), level);
+                        res2 = route_arc(t, net, i, is_mt, level);
+                    }
                     // If this also fails, no choice but to give up
-                    if (res2 != ARC_SUCCESS)
+                    if (res2 != ARC_SUCCESS && nets.at(net->udata).region != nullptr)
+                        log_error("Failed to route arc %d of net '%s', from %s to %s, inside region '%s'.\n",
+                                  int(i), ctx->nameOf(net), ctx->nameOfWire(ctx->getNetinfoSourceWire(net)),
+                                  ctx->nameOfWire(ctx->getNetinfoSinkWire(net, net->users.at(i))),
+                                  ctx->nameOf(nets.at(net->udata).region->name));
+                    else if (res2 != ARC_SUCCESS)
                         log_error("Failed to route arc %d of net '%s', from %s to %s.\n", int(i), ctx->nameOf(net),
                                   ctx->nameOfWire(ctx->getNetinfoSourceWire(net)),
                                   ctx->nameOfWire(ctx->getNetinfoSinkWire(net, net->users.at(i))));
+                    ++t.arcs_by_bb_level.at(level - 1);
                 }
+            } else {
+                ++t.arcs_by_bb_level.at(0);
             }
         }
         if (cfg.perf_profile) {
@@ -989,11 +1084,21 @@ struct Router2
             auto &net_data = nets.at(n);
             ++net_data.fail_count;
             if ((net_data.fail_count % 10) == 0) {
-                // Every ten times a net fails to route, expand the bounding box to increase the search space
-                net_data.bb.x0 = std::max(net_data.bb.x0 - 1, 0);
-                net_data.bb.y0 = std::max(net_data.bb.y0 - 1, 0);
-                net_data.bb.x1 = std::min(net_data.bb.x1 + 1, ctx->getGridDimX());
-                net_data.bb.y1 = std::min(net_data.bb.y1 + 1, ctx->getGridDimY());
+                // Every ten times a net fails to route, expand the bounding box to increase the search space. Only
+                // the sides where the search was blocked are grown, by two tiles on the most blocked side. If it was
+                // never blocked (e.g. it failed on congestion inside the box) every side is grown by one
+                int *blocked = net_data.bb_blocked;
+                int most = *std::max_element(blocked, blocked + 4);
+                auto grow = [&](int side) {
+                    if (most == 0)
+                        return 1;
+                    return blocked[side] == 0 ? 0 : (blocked[side] == most ? 2 : 1);
+                };
+                net_data.bb.x0 = std::max(net_data.bb.x0 - grow(0), 0);
+                net_data.bb.x1 = std::min(net_data.bb.x1 + grow(1), ctx->getGridDimX());
+                net_data.bb.y0 = std::max(net_data.bb.y0 - grow(2), 0);
+                net_data.bb.y1 = std::min(net_data.bb.y1 + grow(3), ctx->getGridDimY());
+                std::fill(blocked, blocked + 4, 0);
             }
         }
     }
@@ -1196,8 +1301,19 @@ struct Router2
         }
     }
 
+    // Arcs routed at each bounding box level in the current iteration; the last entry counts arcs deferred from
+    // multi-threaded routing
+    std::array<int, BB_LEVEL_FULL + 2> arcs_by_bb_level{};
+
+    void add_bb_level_stats(const ThreadContext &t)
+    {
+        for (size_t i = 0; i < arcs_by_bb_level.size(); i++)
+            arcs_by_bb_level.at(i) += t.arcs_by_bb_level.at(i);
+    }
+
     void do_route()
     {
+        arcs_by_bb_level.fill(0);
         // Don't multithread if fewer than 200 nets (heuristic)
         if (route_queue.size() < 200) {
             ThreadContext st;
@@ -1206,6 +1322,7 @@ struct Router2
             for (size_t j = 0; j < route_queue.size(); j++) {
                 route_net(st, nets_by_udata[route_queue[j]], false);
             }
+            add_bb_level_stats(st);
             return;
         }
         const int Nq = 4, Nv = 2, Nh = 2;
@@ -1290,6 +1407,8 @@ struct Router2
         for (int i = 0; i < N; i++)
             for (auto fail : tcs.at(i).failed_nets)
                 route_net(tcs.at(N), fail, false);
+        for (auto &tc : tcs)
+            add_bb_level_stats(tc);
     }
 
     //#define ROUTER2_STATISTICS
@@ -1323,25 +1442,9 @@ struct Router2
 #endif
     }
 
-    void operator()()
+    // Negotiated congestion routing of the nets in route_queue, until the design is legally routed
+    void route_loop(int &iter)
     {
-        log_info("Running router2...\n");
-        log_info("Setting up routing resources...\n");
-        auto rstart = std::chrono::high_resolution_clock::now();
-        setup_nets();
-        setup_wires();
-        find_all_reserved_wires();
-        partition_nets();
-        curr_cong_weight = cfg.init_curr_cong_weight;
-        hist_cong_weight = cfg.hist_cong_weight;
-        ThreadContext st;
-        int iter = 1;
-
-        for (size_t i = 0; i < nets_by_udata.size(); i++)
-            route_queue.push_back(i);
-
-        timing_driven = ctx->setting<bool>("timing_driven");
-        log_info("Running main router loop...\n");
         do {
             ctx->sorted_shuffle(route_queue);
 
@@ -1392,10 +1495,233 @@ struct Router2
                 route_queue.push_back(cn);
             log_info("    iter=%d wires=%d overused=%d overuse=%d archfail=%s\n", iter, total_wire_use, overused_wires,
                      total_overuse, overused_wires > 0 ? "NA" : std::to_string(arch_fail).c_str());
+            if (arcs_by_bb_level.at(1) + arcs_by_bb_level.at(2) + arcs_by_bb_level.at(BB_LEVEL_FULL) > 0 ||
+                ctx->verbose)
+                log_info("        arcs routed in bb: 1x=%d 2x=%d 4x=%d full=%d (deferred from threads: %d)\n",
+                         arcs_by_bb_level.at(0), arcs_by_bb_level.at(1), arcs_by_bb_level.at(2),
+                         arcs_by_bb_level.at(BB_LEVEL_FULL), arcs_by_bb_level.at(BB_LEVEL_FULL + 1));
             ++iter;
             if (curr_cong_weight < 1e9)
                 curr_cong_weight += cfg.curr_cong_mult;
         } while (!failed_nets.empty());
+    }
+
+    // Reroute arcs that violate hold with a cost for routing delay below the requirement, then route the design
+    // legal again. Requirements are kept, so later rerouting for congestion still respects them
+    void fix_hold(int &iter)
+    {
+        struct HoldViolation
+        {
+            NetInfo *net;
+            size_t user;
+            delay_t route_delay, min_delay;
+        };
+        std::vector<HoldViolation> violations;
+        auto find_violations = [&]() {
+            violations.clear();
+            NetHoldMap net_hold;
+            get_hold_requirements(ctx, &net_hold);
+            for (auto &nh : net_hold) {
+                NetInfo *net = ctx->nets.at(nh.first).get();
+                if (net->udata < 0 || net->udata >= int(nets_by_udata.size()) || nets_by_udata.at(net->udata) != net)
+                    continue;
+                for (size_t i = 0; i < nh.second.min_delay.size(); i++) {
+                    delay_t route = nh.second.route_delay.at(i), req = nh.second.min_delay.at(i);
+                    if (route >= req)
+                        continue;
+                    violations.push_back(HoldViolation{net, i, route, req});
+                    auto &ad = nets.at(net->udata).arcs.at(i);
+                    ad.min_delay = std::max(ad.min_delay, req + ctx->getDelayEpsilon());
+                }
+            }
+        };
+        auto report = [&]() {
+            for (auto &v : violations) {
+                auto &usr = v.net->users.at(v.user);
+                log_info("        %s.%s: route delay %.03fns, hold requires %.03fns\n", ctx->nameOf(usr.cell),
+                         ctx->nameOf(usr.port), ctx->getDelayNS(v.route_delay), ctx->getDelayNS(v.min_delay));
+            }
+        };
+        for (int hold_iter = 1; hold_iter <= cfg.hold_fix_iters; hold_iter++) {
+            find_violations();
+            if (violations.empty())
+                return;
+            log_info("Hold fixing iteration %d: %d arcs violate hold\n", hold_iter, int(violations.size()));
+            if (ctx->verbose)
+                report();
+            route_queue.clear();
+            std::set<int> to_route;
+            for (auto &v : violations) {
+                ripup_arc(v.net, v.user);
+                to_route.insert(v.net->udata);
+            }
+            route_queue.insert(route_queue.end(), to_route.begin(), to_route.end());
+            route_loop(iter);
+        }
+        if (cfg.hold_fix_iters > 0) {
+            find_violations();
+            if (!violations.empty()) {
+                log_warning("%d arcs still violate hold after hold fixing:\n", int(violations.size()));
+                report();
+            }
+        }
+    }
+
+    // Historical congestion files store the final hist_cong_cost of every wire where it is above the initial value,
+    // keyed by index into flat_wires (which follows the chipdb's wire order). Entries are delta-coded indices and
+    // costs in 1/256 units, both as varints. A header identifies the chipdb and records the iterations and runtime of
+    // the run that wrote it
+    static constexpr uint32_t hist_cong_magic = 0x4843504e; // "NPCH"
+    static constexpr uint32_t hist_cong_version = 1;
+
+    uint64_t wire_fingerprint()
+    {
+        // Hash a sample of wire names, which catches a different device or chipdb version without naming every wire
+        uint64_t hash = flat_wires.size();
+        size_t step = std::max<size_t>(1, flat_wires.size() / 256);
+        for (size_t i = 0; i < flat_wires.size(); i += step)
+            for (char c : ctx->getWireName(flat_wires.at(i).w).str(ctx))
+                hash = (hash ^ uint8_t(c)) * 0x100000001b3ULL;
+        return hash;
+    }
+
+    static void write_varint(std::ostream &out, uint64_t val)
+    {
+        do {
+            uint8_t b = val & 0x7F;
+            val >>= 7;
+            out.put(char(b | (val ? 0x80 : 0)));
+        } while (val);
+    }
+
+    static bool read_varint(std::istream &in, uint64_t &val)
+    {
+        val = 0;
+        for (int shift = 0; shift < 64; shift += 7) {
+            int c = in.get();
+            if (c == EOF)
+                return false;
+            val |= uint64_t(c & 0x7F) << shift;
+            if (!(c & 0x80))
+                return true;
+        }
+        return false;
+    }
+
+    template <typename T> static void write_raw(std::ostream &out, T val)
+    {
+        out.write(reinterpret_cast<const char *>(&val), sizeof(T));
+    }
+
+    template <typename T> static bool read_raw(std::istream &in, T &val)
+    {
+        return bool(in.read(reinterpret_cast<char *>(&val), sizeof(T)));
+    }
+
+    void save_hist_cong(const std::string &filename, int iterations, float runtime)
+    {
+        std::ofstream out(filename, std::ios::binary);
+        if (!out)
+            log_error("Failed to open historical congestion file '%s' for writing.\n", filename.c_str());
+        std::string chip = ctx->getChipName();
+        write_raw(out, hist_cong_magic);
+        write_raw(out, hist_cong_version);
+        write_varint(out, chip.size());
+        out.write(chip.data(), chip.size());
+        write_raw(out, uint64_t(flat_wires.size()));
+        write_raw(out, wire_fingerprint());
+        write_raw(out, int32_t(iterations));
+        write_raw(out, runtime);
+        size_t count = 0;
+        for (auto &wd : flat_wires)
+            if (wd.hist_cong_cost > 1.0f)
+                ++count;
+        write_varint(out, count);
+        size_t last = 0;
+        for (size_t i = 0; i < flat_wires.size(); i++) {
+            float cost = flat_wires.at(i).hist_cong_cost;
+            if (cost <= 1.0f)
+                continue;
+            write_varint(out, i - last);
+            write_varint(out, uint64_t(std::lround((cost - 1.0f) * 256.0f)));
+            last = i;
+        }
+        log_info("Wrote historical congestion of %d wires to '%s'.\n", int(count), filename.c_str());
+    }
+
+    // Returns false, leaving costs untouched, if the file is not for this chipdb or is malformed
+    bool load_hist_cong(const std::string &filename)
+    {
+        std::ifstream in(filename, std::ios::binary);
+        if (!in)
+            log_error("Failed to open historical congestion file '%s'.\n", filename.c_str());
+        uint32_t magic, version;
+        uint64_t chip_len, wire_count, fingerprint, count;
+        if (!read_raw(in, magic) || magic != hist_cong_magic || !read_raw(in, version) ||
+            version != hist_cong_version || !read_varint(in, chip_len) || chip_len > 1024) {
+            log_warning("'%s' is not a historical congestion file, ignoring it.\n", filename.c_str());
+            return false;
+        }
+        std::string chip(chip_len, '\0');
+        in.read(&chip[0], chip_len);
+        if (!in || !read_raw(in, wire_count) || !read_raw(in, fingerprint) || !read_raw(in, seed_iterations) ||
+            !read_raw(in, seed_runtime) || !read_varint(in, count)) {
+            log_warning("Historical congestion file '%s' is truncated, ignoring it.\n", filename.c_str());
+            return false;
+        }
+        if (chip != ctx->getChipName() || wire_count != flat_wires.size() || fingerprint != wire_fingerprint()) {
+            log_warning("Historical congestion file '%s' was written for a different device or chipdb (%s), "
+                        "ignoring it.\n",
+                        filename.c_str(), chip.c_str());
+            return false;
+        }
+        std::vector<std::pair<size_t, float>> costs;
+        size_t idx = 0;
+        for (uint64_t i = 0; i < count; i++) {
+            uint64_t delta, cost;
+            if (!read_varint(in, delta) || !read_varint(in, cost) || idx + delta >= flat_wires.size()) {
+                log_warning("Historical congestion file '%s' is corrupt, ignoring it.\n", filename.c_str());
+                return false;
+            }
+            idx += delta;
+            costs.emplace_back(idx, 1.0f + cost / 256.0f);
+        }
+        for (auto &c : costs)
+            flat_wires.at(c.first).hist_cong_cost = c.second;
+        log_info("Seeded historical congestion of %d wires from '%s' (written after %d iterations, %.02fs).\n",
+                 int(costs.size()), filename.c_str(), int(seed_iterations), seed_runtime);
+        return true;
+    }
+
+    // Iterations and router runtime of the run that wrote the loaded historical congestion file
+    int32_t seed_iterations = -1;
+    float seed_runtime = 0;
+
+    void operator()()
+    {
+        log_info("Running router2...\n");
+        log_info("Setting up routing resources...\n");
+        auto rstart = std::chrono::high_resolution_clock::now();
+        setup_nets();
+        setup_wires();
+        find_all_reserved_wires();
+        partition_nets();
+        curr_cong_weight = cfg.init_curr_cong_weight;
+        hist_cong_weight = cfg.hist_cong_weight;
+        bool seeded = !cfg.hist_cong_in.empty() && load_hist_cong(cfg.hist_cong_in);
+        ThreadContext st;
+        int iter = 1;
+
+        for (size_t i = 0; i < nets_by_udata.size(); i++)
+            route_queue.push_back(i);
+
+        timing_driven = ctx->setting<bool>("timing_driven");
+        log_info("Running main router loop...\n");
+        route_loop(iter);
+        fix_hold(iter);
+        int region_violations = ctx->checkRegionRouting();
+        if (region_violations > 0)
+            log_error("%d nets were routed outside of their regions.\n", region_violations);
         if (cfg.perf_profile) {
             std::vector<std::pair<int, IdString>> nets_by_runtime;
             for (auto &n : nets_by_udata) {
@@ -1410,7 +1736,13 @@ struct Router2
             }
         }
         auto rend = std::chrono::high_resolution_clock::now();
-        log_info("Router2 time %.02fs\n", std::chrono::duration<float>(rend - rstart).count());
+        float runtime = std::chrono::duration<float>(rend - rstart).count();
+        log_info("Router2 time %.02fs\n", runtime);
+        if (seeded)
+            log_info("Warm start took %d iterations and %.02fs, against %d iterations and %.02fs for the seeding run.\n",
+                     iter - 1, runtime, int(seed_iterations), seed_runtime);
+        if (!cfg.hist_cong_out.empty())
+            save_hist_cong(cfg.hist_cong_out, iter - 1, runtime);
 
         log_info("Running router1 to check that route is legal...\n");
 
@@ -1439,6 +1771,10 @@ Router2Cfg::Router2Cfg(Context *ctx)
     curr_cong_mult = ctx->setting<float>("router2/currCongWeightMult", 2.0f);
     estimate_weight = ctx->setting<float>("router2/estimateWeight", 1.75f);
     perf_profile = ctx->setting<float>("router2/perfProfile", false);
+    hist_cong_in = str_or_default(ctx->settings, ctx->id("router2/histCongIn"), "");
+    hist_cong_out = str_or_default(ctx->settings, ctx->id("router2/histCongOut"), "");
+    hold_fix_iters = ctx->setting<int>("router2/holdFixIters", 0);
+    hold_weight = ctx->setting<float>("router2/holdWeight", 10.0f);
 }
 
 NEXTPNR_NAMESPACE_END
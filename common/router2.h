@@ -47,6 +47,16 @@ struct Router2Cfg
     // of choosing a less congestion/delay-optimal route
     float estimate_weight;
 
+    // Maximum number of hold fixing iterations after routing, zero (the default) to disable
+    int hold_fix_iters;
+    // Cost per ns of routing delay below an arc's hold requirement
+    float hold_weight;
+
+    // If set, seed historical congestion costs from this file, as written by a previous run with hist_cong_out
+    std::string hist_cong_in;
+    // If set, write the final historical congestion costs to this file
+    std::string hist_cong_out;
+
     // Print additional performance profiling information
     bool perf_profile = false;
 };
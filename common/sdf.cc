@@ -17,6 +17,7 @@
  *
  */
 
+#include "design_utils.h"
 #include "nextpnr.h"
 #include "util.h"
 
@@ -120,6 +121,16 @@ struct SDFWriter
         }
     }
 
+    // Bus bits are written as a bit select of the escaped bus name
+    std::string escape_port(const std::string &name)
+    {
+        size_t open = name.find_last_of('[');
+        if (name.empty() || name.back() != ']' || open == std::string::npos || open == 0 ||
+            name.find_first_not_of("0123456789", open + 1) != name.size() - 1)
+            return escape_name(name);
+        return escape_name(name.substr(0, open)) + name.substr(open);
+    }
+
     void write_delay(std::ostream &out, const RiseFallDelay &delay)
     {
         write_delay(out, delay.rise);
@@ -137,15 +148,12 @@ struct SDFWriter
 
     void write_port(std::ostream &out, const CellPort &port)
     {
-        if (cvc_mode)
-            out << escape_name(port.cell) + "." + escape_name(port.port);
-        else
-            out << escape_name(port.cell + "/" + port.port);
+        out << escape_name(port.cell) << (cvc_mode ? "." : "/") << escape_port(port.port);
     }
 
     void write_portedge(std::ostream &out, const PortAndEdge &pe)
     {
-        out << "(" << (pe.edge == RISING_EDGE ? "posedge" : "negedge") << " " << escape_name(pe.port) << ")";
+        out << "(" << (pe.edge == RISING_EDGE ? "posedge" : "negedge") << " " << escape_port(pe.port) << ")";
     }
 
     void write(std::ostream &out)
@@ -186,7 +194,7 @@ struct SDFWriter
                 out << "    (DELAY" << std::endl;
                 out << "      (ABSOLUTE" << std::endl;
                 for (auto &path : cell.iopaths) {
-                    out << "        (IOPATH " << escape_name(path.from) << " " << escape_name(path.to) << " ";
+                    out << "        (IOPATH " << escape_port(path.from) << " " << escape_port(path.to) << " ";
                     write_delay(out, path.delay);
                     out << ")" << std::endl;
                 }
@@ -254,11 +262,13 @@ void Context::writeSDF(std::ostream &out, bool cvc_mode) const
         return rf;
     };
 
+    // Cells and ports are written with the names they had before packing, where the architecture records these,
+    // so that the file annotates a netlist of the original primitives
     for (auto cell : sorted(cells)) {
         Cell sc;
         const CellInfo *ci = cell.second;
         sc.instance = ci->name.str(this);
-        sc.celltype = ci->type.str(this);
+        sc.celltype = logical_cell_type(this, ci);
         for (auto port : ci->ports) {
             int clockCount = 0;
             TimingPortClass cls = getPortTimingClass(ci, port.first, clockCount);
@@ -266,6 +276,7 @@ void Context::writeSDF(std::ostream &out, bool cvc_mode) const
                 continue;
             if (port.second.net == nullptr)
                 continue; // Ignore disconnected ports
+            std::vector<std::string> port_names = logical_port_names(this, ci, port.first);
             if (port.second.type != PORT_IN) {
                 // Add combinational paths to this output (or inout)
                 for (auto other : ci->ports) {
@@ -276,37 +287,46 @@ void Context::writeSDF(std::ostream &out, bool cvc_mode) const
                     DelayInfo dly;
                     if (!getCellDelay(ci, other.first, port.first, dly))
                         continue;
-                    IOPath iop;
-                    iop.from = other.first.str(this);
-                    iop.to = port.first.str(this);
-                    iop.delay = convert_delay(dly);
-                    sc.iopaths.push_back(iop);
+                    for (auto &from : logical_port_names(this, ci, other.first))
+                        for (auto &to : port_names) {
+                            IOPath iop;
+                            iop.from = from;
+                            iop.to = to;
+                            iop.delay = convert_delay(dly);
+                            sc.iopaths.push_back(iop);
+                        }
                 }
                 // Add clock-to-output delays, also as IOPaths
                 if (cls == TMG_REGISTER_OUTPUT)
                     for (int i = 0; i < clockCount; i++) {
                         auto clkInfo = getPortClockingInfo(ci, port.first, i);
-                        IOPath cqp;
-                        cqp.from = clkInfo.clock_port.str(this);
-                        cqp.to = port.first.str(this);
-                        cqp.delay = convert_delay(clkInfo.clockToQ);
-                        sc.iopaths.push_back(cqp);
+                        for (auto &clk : logical_port_names(this, ci, clkInfo.clock_port))
+                            for (auto &to : port_names) {
+                                IOPath cqp;
+                                cqp.from = clk;
+                                cqp.to = to;
+                                cqp.delay = convert_delay(clkInfo.clockToQ);
+                                sc.iopaths.push_back(cqp);
+                            }
                     }
             }
             if (port.second.type != PORT_OUT && cls == TMG_REGISTER_INPUT) {
                 // Add setup/hold checks
                 for (int i = 0; i < clockCount; i++) {
                     auto clkInfo = getPortClockingInfo(ci, port.first, i);
-                    TimingCheck chk;
-                    chk.from.edge = RISING_EDGE; // Add setup/hold checks equally for rising and falling edges
-                    chk.from.port = port.first.str(this);
-                    chk.to.edge = clkInfo.edge;
-                    chk.to.port = clkInfo.clock_port.str(this);
-                    chk.type = TimingCheck::SETUPHOLD;
-                    chk.delay = convert_setuphold(clkInfo.setup, clkInfo.hold);
-                    sc.checks.push_back(chk);
-                    chk.from.edge = FALLING_EDGE;
-                    sc.checks.push_back(chk);
+                    for (auto &clk : logical_port_names(this, ci, clkInfo.clock_port))
+                        for (auto &from : port_names) {
+                            TimingCheck chk;
+                            chk.from.edge = RISING_EDGE; // Add setup/hold checks equally for rising and falling edges
+                            chk.from.port = from;
+                            chk.to.edge = clkInfo.edge;
+                            chk.to.port = clk;
+                            chk.type = TimingCheck::SETUPHOLD;
+                            chk.delay = convert_setuphold(clkInfo.setup, clkInfo.hold);
+                            sc.checks.push_back(chk);
+                            chk.from.edge = FALLING_EDGE;
+                            sc.checks.push_back(chk);
+                        }
                 }
             }
         }
@@ -318,14 +338,18 @@ void Context::writeSDF(std::ostream &out, bool cvc_mode) const
         if (ni->driver.cell == nullptr)
             continue;
         for (auto &usr : ni->users) {
-            Interconnect ic;
-            ic.from.cell = ni->driver.cell->name.str(this);
-            ic.from.port = ni->driver.port.str(this);
-            ic.to.cell = usr.cell->name.str(this);
-            ic.to.port = usr.port.str(this);
             // FIXME: min/max routing delay - or at least constructing DelayInfo here
-            ic.delay = convert_delay(getDelayFromNS(getDelayNS(getNetinfoRouteDelay(ni, usr))));
-            wr.conn.push_back(ic);
+            RiseFallDelay delay = convert_delay(getDelayFromNS(getDelayNS(getNetinfoRouteDelay(ni, usr))));
+            for (auto &from : logical_port_names(this, ni->driver.cell, ni->driver.port))
+                for (auto &to : logical_port_names(this, usr.cell, usr.port)) {
+                    Interconnect ic;
+                    ic.from.cell = ni->driver.cell->name.str(this);
+                    ic.from.port = from;
+                    ic.to.cell = usr.cell->name.str(this);
+                    ic.to.port = to;
+                    ic.delay = delay;
+                    wr.conn.push_back(ic);
+                }
         }
     }
     wr.write(out);
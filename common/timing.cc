@@ -24,6 +24,7 @@
 #include <deque>
 #include <map>
 #include <unordered_map>
+#include <unordered_set>
 #include <utility>
 #include "log.h"
 #include "util.h"
@@ -83,6 +84,8 @@ struct CriticalPath
     PortRefVector ports;
     delay_t path_delay;
     delay_t path_period;
+    // Arrival of the capture clock at the endpoint, already taken off path_delay
+    delay_t capture_clock = 0;
 };
 
 typedef std::unordered_map<ClockPair, CriticalPath> CriticalPathMap;
@@ -97,13 +100,21 @@ struct Timing
     CriticalPathMap *crit_path;
     DelayFrequency *slack_histogram;
     NetCriticalityMap *net_crit;
+    NetHoldMap *net_hold = nullptr;
     IdString async_clock;
+    // Whether to time paths from the arrival of the clock at each register, rather than from zero
+    bool clock_skew;
 
     struct TimingData
     {
         TimingData() : max_arrival(), max_path_length(), min_remaining_budget() {}
-        TimingData(delay_t max_arrival) : max_arrival(max_arrival), max_path_length(), min_remaining_budget() {}
+        TimingData(delay_t max_arrival, delay_t min_arrival)
+                : max_arrival(max_arrival), min_arrival(min_arrival), max_path_length(), min_remaining_budget()
+        {
+        }
         delay_t max_arrival;
+        // Earliest arrival, for hold analysis
+        delay_t min_arrival = std::numeric_limits<delay_t>::max();
         unsigned max_path_length = 0;
         delay_t min_remaining_budget;
         bool false_startpoint = false;
@@ -115,8 +126,66 @@ struct Timing
            DelayFrequency *slack_histogram = nullptr, NetCriticalityMap *net_crit = nullptr)
             : ctx(ctx), net_delays(net_delays), update(update), min_slack(1.0e12 / ctx->setting<float>("target_freq")),
               crit_path(crit_path), slack_histogram(slack_histogram), net_crit(net_crit),
-              async_clock(ctx->id("$async$"))
+              async_clock(ctx->id("$async$")), clock_skew(net_delays && ctx->setting<bool>("timing/clockSkew", true))
+    {
+    }
+
+    std::unordered_map<const NetInfo *, delay_t> clock_source_arrival;
+    std::unordered_map<const CellInfo *, std::unordered_map<IdString, delay_t>> clock_pin_arrival;
+    std::unordered_set<const NetInfo *> clock_nets_done;
+
+    // Delay of a clock net to one of its sinks. Global clocks are balanced, so until they are routed they are taken to
+    // arrive everywhere at once; other clocks use the routed or predicted delay like any other net
+    delay_t clock_net_delay(const NetInfo *net, const PortRef &sink)
+    {
+        const CellInfo *drv = net->driver.cell;
+        if (net->wires.empty() && drv != nullptr && drv->bel != BelId() && ctx->getBelGlobalBuf(drv->bel))
+            return 0;
+        return ctx->getNetinfoRouteDelay(net, sink);
+    }
+
+    // Arrival of a clock at the driver of a net, following it back through buffers to the root of the clock tree
+    delay_t clock_source_delay(const NetInfo *net, int depth = 0)
+    {
+        auto found = clock_source_arrival.find(net);
+        if (found != clock_source_arrival.end())
+            return found->second;
+        delay_t arrival = 0;
+        CellInfo *drv = net->driver.cell;
+        if (drv != nullptr && depth < 8) {
+            for (auto &port : drv->ports) {
+                if (port.second.type != PORT_IN || port.second.net == nullptr)
+                    continue;
+                DelayInfo comb_delay;
+                if (!ctx->getCellDelay(drv, port.first, net->driver.port, comb_delay))
+                    continue;
+                const NetInfo *in = port.second.net;
+                for (auto &usr : in->users)
+                    if (usr.cell == drv && usr.port == port.first) {
+                        arrival = std::max(arrival, clock_source_delay(in, depth + 1) + clock_net_delay(in, usr) +
+                                                            comb_delay.maxDelay());
+                        break;
+                    }
+            }
+        }
+        clock_source_arrival[net] = arrival;
+        return arrival;
+    }
+
+    // Arrival of the clock at a clock pin of a cell, relative to the root of its clock tree
+    delay_t clock_arrival(CellInfo *cell, IdString port)
     {
+        if (!clock_skew)
+            return 0;
+        const NetInfo *clknet = get_net_or_empty(cell, port);
+        if (clknet == nullptr)
+            return 0;
+        if (clock_nets_done.insert(clknet).second) {
+            delay_t source = clock_source_delay(clknet);
+            for (auto &usr : clknet->users)
+                clock_pin_arrival[usr.cell][usr.port] = source + clock_net_delay(clknet, usr);
+        }
+        return clock_pin_arrival.at(cell).at(port);
     }
 
     delay_t walk_paths()
@@ -155,8 +224,9 @@ struct Timing
                         TimingClockingInfo clkInfo = ctx->getPortClockingInfo(cell.second.get(), o->name, i);
                         const NetInfo *clknet = get_net_or_empty(cell.second.get(), clkInfo.clock_port);
                         IdString clksig = clknet ? clknet->name : async_clock;
+                        delay_t launch = clock_arrival(cell.second.get(), clkInfo.clock_port);
                         net_data[o->net][ClockEvent{clksig, clknet ? clkInfo.edge : RISING_EDGE}] =
-                                TimingData{clkInfo.clockToQ.maxDelay()};
+                                TimingData{launch + clkInfo.clockToQ.maxDelay(), launch + clkInfo.clockToQ.minDelay()};
                     }
 
                 } else {
@@ -165,6 +235,7 @@ struct Timing
                         TimingData td;
                         td.false_startpoint = (portClass == TMG_GEN_CLOCK || portClass == TMG_IGNORE);
                         td.max_arrival = 0;
+                        td.min_arrival = 0;
                         net_data[o->net][ClockEvent{async_clock, RISING_EDGE}] = td;
                     }
 
@@ -187,6 +258,7 @@ struct Timing
                         TimingData td;
                         td.false_startpoint = true;
                         td.max_arrival = 0;
+                        td.min_arrival = 0;
                         net_data[o->net][ClockEvent{async_clock, RISING_EDGE}] = td;
                     }
                 }
@@ -278,6 +350,7 @@ struct Timing
                 if (nd.false_startpoint)
                     continue;
                 const auto net_arrival = nd.max_arrival;
+                const auto net_min_arrival = nd.min_arrival;
                 const auto net_length_plus_one = nd.max_path_length + 1;
                 nd.min_remaining_budget = clk_period;
                 for (auto &usr : net->users) {
@@ -302,6 +375,8 @@ struct Timing
                             auto &data = net_data[port.second.net][start_clk];
                             auto &arrival = data.max_arrival;
                             arrival = std::max(arrival, usr_arrival + comb_delay.maxDelay());
+                            data.min_arrival =
+                                    std::min(data.min_arrival, net_min_arrival + net_delay + comb_delay.minDelay());
                             if (!budget_override) { // Do not increment path length if budget overriden since it doesn't
                                 // require a share of the slack
                                 auto &path_length = data.max_path_length;
@@ -313,6 +388,43 @@ struct Timing
             }
         }
 
+        if (net_hold) {
+            // Hold checks, for paths launched and captured by the same clock edge
+            for (auto net : topographical_order) {
+                if (!net_data.count(net))
+                    continue;
+                for (auto &startdomain : net_data.at(net)) {
+                    auto &nd = startdomain.second;
+                    if (nd.false_startpoint || startdomain.first.clock == async_clock)
+                        continue;
+                    for (size_t i = 0; i < net->users.size(); i++) {
+                        auto &usr = net->users.at(i);
+                        int port_clocks;
+                        TimingPortClass portClass = ctx->getPortTimingClass(usr.cell, usr.port, port_clocks);
+                        if (portClass != TMG_REGISTER_INPUT)
+                            continue;
+                        for (int j = 0; j < port_clocks; j++) {
+                            TimingClockingInfo clkInfo = ctx->getPortClockingInfo(usr.cell, usr.port, j);
+                            const NetInfo *clknet = get_net_or_empty(usr.cell, clkInfo.clock_port);
+                            if (clknet == nullptr || clknet->name != startdomain.first.clock ||
+                                clkInfo.edge != startdomain.first.edge)
+                                continue;
+                            auto &nh = (*net_hold)[net->name];
+                            if (nh.min_delay.empty()) {
+                                nh.min_delay.resize(net->users.size(), std::numeric_limits<delay_t>::lowest());
+                                nh.route_delay.resize(net->users.size());
+                                for (size_t k = 0; k < net->users.size(); k++)
+                                    nh.route_delay.at(k) = ctx->getNetinfoRouteDelay(net, net->users.at(k));
+                            }
+                            delay_t capture = clock_arrival(usr.cell, clkInfo.clock_port);
+                            nh.min_delay.at(i) =
+                                    std::max(nh.min_delay.at(i), capture + clkInfo.hold.maxDelay() - nd.min_arrival);
+                        }
+                    }
+                }
+            }
+        }
+
         std::unordered_map<ClockPair, std::pair<delay_t, NetInfo *>> crit_nets;
 
         // Now go backwards topographically to determine the minimum path slack, and to distribute all path slack evenly
@@ -334,9 +446,10 @@ struct Timing
                     int port_clocks;
                     TimingPortClass portClass = ctx->getPortTimingClass(usr.cell, usr.port, port_clocks);
                     if (portClass == TMG_REGISTER_INPUT || portClass == TMG_ENDPOINT) {
-                        auto process_endpoint = [&](IdString clksig, ClockEdge edge, delay_t setup) {
+                        auto process_endpoint = [&](IdString clksig, ClockEdge edge, delay_t setup, delay_t capture) {
                             const auto net_arrival = nd.max_arrival;
-                            const auto endpoint_arrival = net_arrival + net_delay + setup;
+                            // Clock skew moves the endpoint arrival relative to the capturing edge
+                            const auto endpoint_arrival = net_arrival + net_delay + setup - capture;
                             delay_t period;
                             // Set default period
                             if (edge == startdomain.first.edge) {
@@ -383,6 +496,7 @@ struct Timing
                                     crit_nets[clockPair] = std::make_pair(endpoint_arrival, net);
                                     (*crit_path)[clockPair].path_delay = endpoint_arrival;
                                     (*crit_path)[clockPair].path_period = period;
+                                    (*crit_path)[clockPair].capture_clock = capture;
                                     (*crit_path)[clockPair].ports.clear();
                                     (*crit_path)[clockPair].ports.push_back(&usr);
                                 }
@@ -393,10 +507,11 @@ struct Timing
                                 TimingClockingInfo clkInfo = ctx->getPortClockingInfo(usr.cell, usr.port, i);
                                 const NetInfo *clknet = get_net_or_empty(usr.cell, clkInfo.clock_port);
                                 IdString clksig = clknet ? clknet->name : async_clock;
-                                process_endpoint(clksig, clknet ? clkInfo.edge : RISING_EDGE, clkInfo.setup.maxDelay());
+                                process_endpoint(clksig, clknet ? clkInfo.edge : RISING_EDGE, clkInfo.setup.maxDelay(),
+                                                 clock_arrival(usr.cell, clkInfo.clock_port));
                             }
                         } else {
-                            process_endpoint(async_clock, RISING_EDGE, 0);
+                            process_endpoint(async_clock, RISING_EDGE, 0, 0);
                         }
 
                     } else if (update) {
@@ -503,7 +618,8 @@ struct Timing
                         int port_clocks;
                         TimingPortClass portClass = ctx->getPortTimingClass(usr.cell, usr.port, port_clocks);
                         if (portClass == TMG_REGISTER_INPUT || portClass == TMG_ENDPOINT) {
-                            auto process_endpoint = [&](IdString clksig, ClockEdge edge, delay_t setup) {
+                            auto process_endpoint = [&](IdString clksig, ClockEdge edge, delay_t setup,
+                                                        delay_t capture) {
                                 delay_t period;
                                 // Set default period
                                 if (edge == startdomain.first.edge) {
@@ -525,7 +641,7 @@ struct Timing
                                         }
                                     }
                                 }
-                                nd.min_required.at(i) = std::min(period - setup, nd.min_required.at(i));
+                                nd.min_required.at(i) = std::min(period + capture - setup, nd.min_required.at(i));
                             };
                             if (portClass == TMG_REGISTER_INPUT) {
                                 for (int j = 0; j < port_clocks; j++) {
@@ -533,10 +649,11 @@ struct Timing
                                     const NetInfo *clknet = get_net_or_empty(usr.cell, clkInfo.clock_port);
                                     IdString clksig = clknet ? clknet->name : async_clock;
                                     process_endpoint(clksig, clknet ? clkInfo.edge : RISING_EDGE,
-                                                     clkInfo.setup.maxDelay());
+                                                     clkInfo.setup.maxDelay(),
+                                                     clock_arrival(usr.cell, clkInfo.clock_port));
                                 }
                             } else {
-                                process_endpoint(async_clock, RISING_EDGE, 0);
+                                process_endpoint(async_clock, RISING_EDGE, 0, 0);
                             }
                         }
                         net_min_required = std::min(net_min_required, nd.min_required.at(i) - net_delay);
@@ -796,8 +913,8 @@ void timing_analysis(Context *ctx, bool print_histogram, bool print_fmax, bool p
     }
 
     if (print_path) {
-        auto print_path_report = [ctx](ClockPair &clocks, PortRefVector &crit_path) {
-            delay_t total = 0, logic_total = 0, route_total = 0;
+        auto print_path_report = [ctx, &timing](ClockPair &clocks, PortRefVector &crit_path, delay_t capture_clock) {
+            delay_t total = 0, logic_total = 0, route_total = 0, clock_total = 0;
             auto &front = crit_path.front();
             auto &front_port = front->cell->ports.at(front->port);
             auto &front_driver = front_port.net->driver;
@@ -820,6 +937,15 @@ void timing_analysis(Context *ctx, bool print_histogram, bool print_fmax, bool p
             }
 
             log_info("curr total\n");
+            if (clock_start != -1) {
+                delay_t launch = timing.clock_arrival(front_driver.cell, last_port);
+                if (launch != 0 || capture_clock != 0) {
+                    total += launch;
+                    clock_total += launch;
+                    log_info("%4.1f %4.1f  Clock %s.%s\n", ctx->getDelayNS(launch), ctx->getDelayNS(total),
+                             front_driver.cell->name.c_str(ctx), last_port.c_str(ctx));
+                }
+            }
             for (auto sink : crit_path) {
                 auto sink_cell = sink->cell;
                 auto &port = sink_cell->ports.at(sink->port);
@@ -884,8 +1010,20 @@ void timing_analysis(Context *ctx, bool print_histogram, bool print_fmax, bool p
                 logic_total += setup;
                 log_info("%4.1f %4.1f  Setup %s.%s\n", ctx->getDelayNS(setup), ctx->getDelayNS(total),
                          crit_path.back()->cell->name.c_str(ctx), crit_path.back()->port.c_str(ctx));
+                if (capture_clock != 0) {
+                    total -= capture_clock;
+                    clock_total -= capture_clock;
+                    log_info("%4.1f %4.1f  Capture clock %s.%s\n", -ctx->getDelayNS(capture_clock),
+                             ctx->getDelayNS(total), crit_path.back()->cell->name.c_str(ctx),
+                             sinkClockInfo.clock_port.c_str(ctx));
+                }
             }
-            log_info("%.1f ns logic, %.1f ns routing\n", ctx->getDelayNS(logic_total), ctx->getDelayNS(route_total));
+            if (clock_total != 0)
+                log_info("%.1f ns logic, %.1f ns routing, %.1f ns clock skew\n", ctx->getDelayNS(logic_total),
+                         ctx->getDelayNS(route_total), ctx->getDelayNS(clock_total));
+            else
+                log_info("%.1f ns logic, %.1f ns routing\n", ctx->getDelayNS(logic_total),
+                         ctx->getDelayNS(route_total));
         };
 
         for (auto &clock : clock_reports) {
@@ -897,7 +1035,7 @@ void timing_analysis(Context *ctx, bool print_histogram, bool print_fmax, bool p
             log_info("Critical path report for clock '%s' (%s -> %s):\n", clock.first.c_str(ctx), start.c_str(),
                      end.c_str());
             auto &crit_path = clock.second.second.ports;
-            print_path_report(clock.second.first, crit_path);
+            print_path_report(clock.second.first, crit_path, clock.second.second.capture_clock);
         }
 
         for (auto &xclock : xclock_paths) {
@@ -906,7 +1044,7 @@ void timing_analysis(Context *ctx, bool print_histogram, bool print_fmax, bool p
             std::string end = format_event(xclock.end);
             log_info("Critical path report for cross-domain path '%s' -> '%s':\n", start.c_str(), end.c_str());
             auto &crit_path = crit_paths.at(xclock).ports;
-            print_path_report(xclock, crit_path);
+            print_path_report(xclock, crit_path, crit_paths.at(xclock).capture_clock);
         }
     }
     if (print_fmax) {
@@ -988,4 +1126,18 @@ void get_criticalities(Context *ctx, NetCriticalityMap *net_crit)
     timing.walk_paths();
 }
 
+int get_hold_requirements(Context *ctx, NetHoldMap *net_hold)
+{
+    net_hold->clear();
+    Timing timing(ctx, true, false);
+    timing.net_hold = net_hold;
+    timing.walk_paths();
+    int violations = 0;
+    for (auto &nh : *net_hold)
+        for (size_t i = 0; i < nh.second.min_delay.size(); i++)
+            if (nh.second.route_delay.at(i) < nh.second.min_delay.at(i))
+                ++violations;
+    return violations;
+}
+
 NEXTPNR_NAMESPACE_END
@@ -45,6 +45,20 @@ struct NetCriticalityInfo
 typedef std::unordered_map<IdString, NetCriticalityInfo> NetCriticalityMap;
 void get_criticalities(Context *ctx, NetCriticalityMap *net_crit);
 
+// Minimum delay (hold) requirements, for arcs that drive register inputs
+struct NetHoldInfo
+{
+    // One each per user: the smallest routing delay that meets the hold time of the sink, given the earliest
+    // arrival at the driver; lowest() for users with no hold check
+    std::vector<delay_t> min_delay;
+    // The routing delay used for the analysis
+    std::vector<delay_t> route_delay;
+};
+
+typedef std::unordered_map<IdString, NetHoldInfo> NetHoldMap;
+// Returns the number of arcs whose routing delay is below their hold requirement
+int get_hold_requirements(Context *ctx, NetHoldMap *net_hold);
+
 NEXTPNR_NAMESPACE_END
 
 #endif
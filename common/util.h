@@ -102,6 +102,15 @@ template <typename K, typename V> std::map<K, V *> sorted(const std::unordered_m
     return retVal;
 };
 
+// Wrap an unordered_map of values, and allow it to be iterated over sorted by key
+template <typename K, typename V> std::map<K, V &> sorted_ref(std::unordered_map<K, V> &orig)
+{
+    std::map<K, V &> retVal;
+    for (auto &item : orig)
+        retVal.emplace(std::make_pair(item.first, std::ref(item.second)));
+    return retVal;
+};
+
 // Wrap an unordered_set, and allow it to be iterated over sorted by key
 template <typename K> std::set<K> sorted(const std::unordered_set<K> &orig)
 {
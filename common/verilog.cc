@@ -0,0 +1,256 @@
+/*
+ *  nextpnr -- Next Generation Place and Route
+ *
+ *  Copyright (C) 2026  agent <agent@local>
+ *
+ *  Permission to use, copy, modify, and/or distribute this software for any
+ *  purpose with or without fee is hereby granted, provided that the above
+ *  copyright notice and this permission notice appear in all copies.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ *  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ *  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ *  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ *  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ *  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ *  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ */
+
+#include <cctype>
+#include <cmath>
+#include <map>
+#include <sstream>
+#include "design_utils.h"
+#include "log.h"
+#include "nextpnr.h"
+#include "util.h"
+
+NEXTPNR_NAMESPACE_BEGIN
+
+namespace Verilog {
+
+const std::unordered_set<std::string> keywords = {
+        "always",  "and",    "assign",   "begin",   "buf",    "case",   "default", "else",    "end",
+        "endcase", "endmodule", "for",   "function", "if",    "initial", "inout",  "input",   "integer",
+        "module",  "nand",   "nor",      "not",     "or",     "output", "parameter", "reg",   "signed",
+        "supply0", "supply1", "tri",     "wire",    "xnor",   "xor"};
+
+std::string escape_id(const std::string &name)
+{
+    bool simple = !name.empty() && !std::isdigit(static_cast<unsigned char>(name.front())) && name.front() != '$' &&
+                  !keywords.count(name);
+    for (char c : name)
+        if (!std::isalnum(static_cast<unsigned char>(c)) && c != '_' && c != '$')
+            simple = false;
+    return simple ? name : ("\\" + name + " ");
+}
+
+// Split a bus bit name like "DI[3]" into its bus name and index
+bool split_bit(const std::string &name, std::string &base, int &index)
+{
+    size_t open = name.find_last_of('[');
+    if (name.empty() || name.back() != ']' || open == std::string::npos || open == 0 || open + 2 >= name.size() ||
+        name.find_first_not_of("0123456789", open + 1) != name.size() - 1)
+        return false;
+    base = name.substr(0, open);
+    index = std::stoi(name.substr(open + 1, name.size() - open - 2));
+    return true;
+}
+
+std::string param_value(const Property &value)
+{
+    if (value.is_string) {
+        std::string str = "\"";
+        for (char c : value.str) {
+            if (c == '\\' || c == '"')
+                str += '\\';
+            str += c;
+        }
+        return str + "\"";
+    }
+    if (value.size() == 0)
+        return "0";
+    return std::to_string(value.size()) + "'b" + value.to_string();
+}
+
+struct BusConn
+{
+    PortType dir;
+    std::map<int, std::string> bits;
+};
+
+} // namespace Verilog
+
+void Context::writeVerilog(std::ostream &out, bool interconnect_delays) const
+{
+    using namespace Verilog;
+    std::string module = str_or_default(attrs, id("module"), "top");
+
+    // Top level ports, grouped into buses. The nets on the pads of the design become the module ports, and the
+    // pseudo PAD cells themselves aren't written
+    std::map<std::string, BusConn> top_ports;
+    std::unordered_map<IdString, std::string> net_expr;
+    std::unordered_set<IdString> skip_cells;
+    std::map<std::string, IdString> port_names;
+    for (auto &port : ports)
+        port_names[port.first.str(this)] = port.first;
+    for (auto &port : port_names) {
+        const PortInfo &pi = ports.at(port.second);
+        std::string base;
+        int index;
+        std::string expr;
+        if (split_bit(port.first, base, index)) {
+            expr = escape_id(base) + "[" + std::to_string(index) + "]";
+        } else {
+            base = port.first;
+            index = -1;
+            expr = escape_id(base);
+        }
+        BusConn &conn = top_ports[base];
+        conn.dir = pi.type;
+        conn.bits[index] = expr;
+
+        const NetInfo *pad_net = nullptr;
+        auto pad = cells.find(port.second);
+        if (pad != cells.end() && logical_cell_type(this, pad->second.get()) == "PAD") {
+            for (auto &pad_port : pad->second->ports)
+                if (pad_port.second.net != nullptr)
+                    pad_net = pad_port.second.net;
+            skip_cells.insert(pad->first);
+        } else if (pi.net != nullptr && nets.count(pi.net->name) && nets.at(pi.net->name).get() == pi.net) {
+            pad_net = pi.net;
+        }
+        if (pad_net != nullptr && !net_expr.count(pad_net->name))
+            net_expr[pad_net->name] = expr;
+    }
+
+    std::ostringstream decls, assigns, insts;
+    for (auto net : sorted(nets)) {
+        NetInfo *ni = net.second;
+        if (!net_expr.count(ni->name)) {
+            net_expr[ni->name] = escape_id(ni->name.str(this));
+            decls << "    wire " << net_expr.at(ni->name) << ";" << std::endl;
+        }
+        // Constant drivers have no model, and become assignments
+        if (ni->driver.cell != nullptr) {
+            const std::string &drv_type = ni->driver.cell->type.str(this);
+            if (drv_type == "PSEUDO_GND" || drv_type == "PSEUDO_VCC") {
+                assigns << "    assign " << net_expr.at(ni->name) << " = 1'b"
+                        << (drv_type == "PSEUDO_VCC" ? "1" : "0") << ";" << std::endl;
+                skip_cells.insert(ni->driver.cell->name);
+            }
+        }
+    }
+
+    // Routing delays can be written as delayed copies of each net for every sink, for simulators that can't apply the
+    // INTERCONNECT entries of the SDF file
+    std::map<std::pair<IdString, IdString>, std::string> sink_expr;
+    if (interconnect_delays) {
+        for (auto net : sorted(nets)) {
+            NetInfo *ni = net.second;
+            if (ni->driver.cell == nullptr || skip_cells.count(ni->driver.cell->name))
+                continue;
+            int idx = 0;
+            for (auto &usr : ni->users) {
+                int delay = int(std::lround(getDelayNS(getNetinfoRouteDelay(ni, usr)) * 1000));
+                if (delay <= 0 || usr.cell->ports.at(usr.port).type != PORT_IN)
+                    continue;
+                std::string wire = escape_id(ni->name.str(this) + "$delay$" + std::to_string(idx++));
+                decls << "    wire " << wire << ";" << std::endl;
+                assigns << "    assign #" << delay << " " << wire << " = " << net_expr.at(ni->name) << ";"
+                        << std::endl;
+                sink_expr[std::make_pair(usr.cell->name, usr.port)] = wire;
+            }
+        }
+    }
+
+    // Cells are written as their pre-packing primitives where the architecture records them, with the same
+    // instance names as the SDF file
+    int unconn_idx = 0;
+    for (auto cell : sorted(cells)) {
+        const CellInfo *ci = cell.second;
+        if (skip_cells.count(ci->name))
+            continue;
+        std::map<std::string, BusConn> conns;
+        std::map<std::string, IdString> cell_ports;
+        for (auto &port : ci->ports)
+            cell_ports[port.first.str(this)] = port.first;
+        for (auto &port : cell_ports) {
+            const PortInfo &pi = ci->ports.at(port.second);
+            if (pi.net == nullptr)
+                continue;
+            auto sink = sink_expr.find(std::make_pair(ci->name, port.second));
+            const std::string &expr = (sink != sink_expr.end()) ? sink->second : net_expr.at(pi.net->name);
+            for (auto &name : logical_port_names(this, ci, port.second)) {
+                std::string base;
+                int index;
+                if (!split_bit(name, base, index)) {
+                    base = name;
+                    index = -1;
+                }
+                BusConn &conn = conns[base];
+                conn.dir = pi.type;
+                conn.bits[index] = expr;
+            }
+        }
+        insts << "    " << escape_id(logical_cell_type(this, ci));
+        auto params = logical_params(this, ci);
+        if (!params.empty()) {
+            insts << " #(" << std::endl;
+            bool first = true;
+            for (auto &param : params) {
+                insts << (first ? "" : ",\n") << "        ." << escape_id(param.first) << "("
+                      << param_value(param.second) << ")";
+                first = false;
+            }
+            insts << std::endl << "    )";
+        }
+        insts << " " << escape_id(ci->name.str(this)) << " (";
+        bool first = true;
+        for (auto &conn : conns) {
+            insts << (first ? "\n" : ",\n") << "        ." << escape_id(conn.first) << "(";
+            first = false;
+            if (conn.second.bits.count(-1)) {
+                insts << conn.second.bits.at(-1) << ")";
+                continue;
+            }
+            // Missing bits of a bus are tied low for inputs, and left on a dangling wire otherwise
+            insts << "{";
+            for (int i = conn.second.bits.rbegin()->first; i >= 0; i--) {
+                auto bit = conn.second.bits.find(i);
+                if (bit != conn.second.bits.end()) {
+                    insts << bit->second;
+                } else if (conn.second.dir == PORT_IN) {
+                    insts << "1'b0";
+                } else {
+                    std::string wire = escape_id("$nextpnr_unconn$" + std::to_string(unconn_idx++));
+                    decls << "    wire " << wire << ";" << std::endl;
+                    insts << wire;
+                }
+                insts << (i > 0 ? ", " : "");
+            }
+            insts << "})";
+        }
+        insts << std::endl << "    );" << std::endl;
+    }
+
+    out << "`timescale 1ps / 1ps" << std::endl;
+    out << "module " << escape_id(module) << " (";
+    bool first = true;
+    for (auto &port : top_ports) {
+        out << (first ? "\n" : ",\n") << "    " << escape_id(port.first);
+        first = false;
+    }
+    out << std::endl << ");" << std::endl;
+    for (auto &port : top_ports) {
+        out << "    " << (port.second.dir == PORT_IN ? "input" : port.second.dir == PORT_OUT ? "output" : "inout");
+        if (!port.second.bits.count(-1))
+            out << " [" << port.second.bits.rbegin()->first << ":0]";
+        out << " " << escape_id(port.first) << ";" << std::endl;
+    }
+    out << decls.str() << assigns.str() << insts.str();
+    out << "endmodule" << std::endl;
+}
+
+NEXTPNR_NAMESPACE_END
@@ -249,6 +249,14 @@ BelRange Arch::getBelsByTile(int x, int y) const
     return br;
 }
 
+const std::vector<BelId> &Arch::getBelsByType(IdString type) const
+{
+    if (bels_by_type.empty())
+        for (auto bel : getBels())
+            bels_by_type[getBelType(bel)].push_back(bel);
+    return bels_by_type[type];
+}
+
 WireId Arch::getBelPinWire(BelId bel, IdString pin) const
 {
     WireId ret;
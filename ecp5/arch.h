@@ -484,6 +484,7 @@ struct Arch : BaseCtx
     mutable std::unordered_map<IdString, BelId> bel_by_name;
     mutable std::unordered_map<IdString, WireId> wire_by_name;
     mutable std::unordered_map<IdString, PipId> pip_by_name;
+    mutable std::unordered_map<IdString, std::vector<BelId>> bels_by_type;
 
     std::vector<CellInfo *> bel_to_cell;
     std::unordered_map<WireId, NetInfo *> wire_to_net;
@@ -565,6 +566,8 @@ struct Arch : BaseCtx
 
     BelId getBelByLocation(Loc loc) const;
     BelRange getBelsByTile(int x, int y) const;
+    // All bels of a given type, in getBels() order
+    const std::vector<BelId> &getBelsByType(IdString type) const;
 
     bool getBelGlobalBuf(BelId bel) const { return getBelType(bel) == id_DCCA; }
 
@@ -1064,6 +1067,10 @@ struct Arch : BaseCtx
 
     mutable std::unordered_map<DelayKey, std::pair<bool, DelayInfo>> celldelay_cache;
 
+    // Whether the arch has getWireNameString, getPipNameString, getWireByNameString and getPipByNameString, which can
+    // be called from several threads once setup_byname() has been called
+    static constexpr bool threadsafe_names = false;
+
     static const std::string defaultPlacer;
     static const std::vector<std::string> availablePlacers;
     static const std::string defaultRouter;
@@ -333,7 +333,7 @@ static unsigned get_dram_init(const Context *ctx, const CellInfo *ram, int bit)
 {
     auto init_prop = get_or_default(ram->params, ctx->id("INITVAL"), Property(0, 64));
     NPNR_ASSERT(!init_prop.is_string);
-    const std::string &idata = init_prop.str;
+    const std::string idata = init_prop.bit_str();
     NPNR_ASSERT(idata.length() == 64);
     unsigned value = 0;
     for (int i = 0; i < 16; i++) {
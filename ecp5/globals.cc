@@ -19,8 +19,10 @@
 
 #include "globals.h"
 #include <algorithm>
+#include <cstring>
 #include <iomanip>
 #include <queue>
+#include <thread>
 #include "cells.h"
 #include "log.h"
 #include "nextpnr.h"
@@ -132,55 +134,160 @@ class Ecp5GlobalRouter
         return *(ctx->getPipsUphill(spine_wire).begin());
     }
 
-    void route_logic_tile_global(NetInfo *net, int global_index, PortRef user)
+    // Dense per-wire search state, indexed by flat_wire_index(). Visited
+    // state is a generation stamp, so nothing needs clearing between searches
+    // and the arrays are allocated once per router (or per thread).
+    struct SearchScratch
     {
-        WireId userWire = ctx->getBelPinWire(user.cell->bel, user.port);
-        WireId globalWire;
-        IdString global_name = ctx->id(fmt_str("G_HPBX" << std::setw(2) << std::setfill('0') << global_index << "00"));
-        std::queue<WireId> upstream;
-        std::unordered_map<WireId, PipId> backtrace;
-        upstream.push(userWire);
+        std::vector<uint32_t> visit_gen;
+        std::vector<PipId> backtrace;
+        std::vector<WireId> fifo;
+        uint32_t gen = 0;
+        // Wires claimed by earlier searches using this scratch whose routes
+        // are not yet bound in the Arch (parallel search only)
+        std::unordered_map<int, NetInfo *> claimed;
+    };
+
+    // Result of searching from a logic tile clock pin back to the global
+    // network, to be committed later by bind_tile_global_route
+    struct TileGlobalRoute
+    {
+        bool found = false;
         bool already_routed = false;
+        WireId global_wire;
+        // Pips from the global wire towards the sink, in binding order
+        std::vector<PipId> pips;
+    };
+
+    std::vector<int> tile_wire_base;
+    int total_wires = 0;
+
+    void setup_wire_index()
+    {
+        if (!tile_wire_base.empty())
+            return;
+        int num_tiles = ctx->chip_info->width * ctx->chip_info->height;
+        tile_wire_base.resize(num_tiles);
+        for (int i = 0; i < num_tiles; i++) {
+            tile_wire_base.at(i) = total_wires;
+            total_wires += ctx->chip_info->locations[ctx->chip_info->location_type[i]].num_wires;
+        }
+    }
+
+    int flat_wire_index(WireId wire) const
+    {
+        return tile_wire_base.at(wire.location.y * ctx->chip_info->width + wire.location.x) + wire.index;
+    }
+
+    void begin_search(SearchScratch &s) const
+    {
+        if (int(s.visit_gen.size()) != total_wires) {
+            s.visit_gen.assign(total_wires, 0);
+            s.backtrace.resize(total_wires);
+            s.gen = 0;
+        }
+        if (++s.gen == 0) {
+            std::fill(s.visit_gen.begin(), s.visit_gen.end(), 0);
+            s.gen = 1;
+        }
+        s.fifo.clear();
+    }
+
+    // Mark a wire as visited, returning false if it already was
+    bool visit_wire(SearchScratch &s, WireId wire, PipId via) const
+    {
+        int idx = flat_wire_index(wire);
+        if (s.visit_gen[idx] == s.gen)
+            return false;
+        s.visit_gen[idx] = s.gen;
+        s.backtrace[idx] = via;
+        s.fifo.push_back(wire);
+        return true;
+    }
+
+    NetInfo *get_bound_net(const SearchScratch &s, WireId wire) const
+    {
+        if (!s.claimed.empty()) {
+            auto fnd = s.claimed.find(flat_wire_index(wire));
+            if (fnd != s.claimed.end())
+                return fnd->second;
+        }
+        return ctx->getBoundWireNet(wire);
+    }
+
+    // Search back from the pin until we reach the global network. Only reads
+    // from the Arch, so is safe to run in parallel on disjoint quadrants.
+    void search_tile_global(SearchScratch &s, NetInfo *net, const std::string &global_name, WireId user_wire,
+                            TileGlobalRoute &route) const
+    {
+        begin_search(s);
+        visit_wire(s, user_wire, PipId());
+        size_t head = 0;
         WireId next;
-        // Search back from the pin until we reach the global network
         while (true) {
-            next = upstream.front();
-            upstream.pop();
+            if (head == s.fifo.size() || s.fifo.size() - head > 30000)
+                return;
+            next = s.fifo.at(head++);
 
-            if (ctx->getBoundWireNet(next) == net) {
-                already_routed = true;
-                globalWire = next;
+            NetInfo *bound = get_bound_net(s, next);
+            if (bound == net) {
+                route.already_routed = true;
                 break;
             }
 
-            if (ctx->getWireBasename(next) == global_name) {
-                globalWire = next;
+            if (std::strcmp(ctx->locInfo(next)->wire_data[next.index].name.get(), global_name.c_str()) == 0)
                 break;
-            }
-            if (ctx->checkWireAvail(next)) {
-                for (auto pip : ctx->getPipsUphill(next)) {
-                    WireId src = ctx->getPipSrcWire(pip);
-                    backtrace[src] = pip;
-                    upstream.push(src);
-                }
-            }
-            if (upstream.size() > 30000) {
-                log_error("failed to route HPBX%02d00 to %s.%s\n", global_index,
-                          ctx->getBelName(user.cell->bel).c_str(ctx), user.port.c_str(ctx));
+            if (bound == nullptr) {
+                for (auto pip : ctx->getPipsUphill(next))
+                    visit_wire(s, ctx->getPipSrcWire(pip), pip);
             }
         }
-        // Set all the pips we found along the way
+        route.found = true;
+        route.global_wire = next;
+        // Collect all the pips we found along the way
         WireId cursor = next;
         while (true) {
-            auto fnd = backtrace.find(cursor);
-            if (fnd == backtrace.end())
+            PipId pip = s.backtrace.at(flat_wire_index(cursor));
+            if (pip == PipId())
                 break;
-            ctx->bindPip(fnd->second, net, STRENGTH_LOCKED);
-            cursor = ctx->getPipDstWire(fnd->second);
+            route.pips.push_back(pip);
+            cursor = ctx->getPipDstWire(pip);
         }
+    }
+
+    // Record a route in the scratch's claimed set, so later searches in the
+    // same quadrant see it before it is bound
+    void claim_tile_global(SearchScratch &s, NetInfo *net, const TileGlobalRoute &route) const
+    {
+        if (!route.already_routed)
+            s.claimed[flat_wire_index(route.global_wire)] = net;
+        for (auto pip : route.pips)
+            s.claimed[flat_wire_index(ctx->getPipDstWire(pip))] = net;
+    }
+
+    // Check that a route found in parallel is still legal given everything
+    // bound since
+    bool can_bind_tile_global(NetInfo *net, const TileGlobalRoute &route) const
+    {
+        if (!route.found)
+            return false;
+        if (ctx->getBoundWireNet(route.global_wire) != (route.already_routed ? net : nullptr))
+            return false;
+        for (auto pip : route.pips)
+            if (!ctx->checkPipAvail(pip) || !ctx->checkWireAvail(ctx->getPipDstWire(pip)))
+                return false;
+        return true;
+    }
+
+    void bind_tile_global_route(NetInfo *net, const TileGlobalRoute &route)
+    {
+        // Set all the pips we found along the way
+        for (auto pip : route.pips)
+            ctx->bindPip(pip, net, STRENGTH_LOCKED);
         // If the global network inside the tile isn't already set up,
         // we also need to bind the buffers along the way
-        if (!already_routed) {
+        if (!route.already_routed) {
+            WireId next = route.global_wire;
             ctx->bindWire(next, net, STRENGTH_LOCKED);
             PipId tap_pip = find_tap_pip(next);
             NetInfo *tap_net = ctx->getBoundPipNet(tap_pip);
@@ -199,6 +306,22 @@ class Ecp5GlobalRouter
         }
     }
 
+    static std::string get_hpbx_name(int global_index)
+    {
+        return fmt_str("G_HPBX" << std::setw(2) << std::setfill('0') << global_index << "00");
+    }
+
+    void route_logic_tile_global(SearchScratch &s, NetInfo *net, int global_index, PortRef user)
+    {
+        TileGlobalRoute route;
+        search_tile_global(s, net, get_hpbx_name(global_index), ctx->getBelPinWire(user.cell->bel, user.port),
+                           route);
+        if (!route.found)
+            log_error("failed to route HPBX%02d00 to %s.%s\n", global_index, ctx->getBelName(user.cell->bel).c_str(ctx),
+                      user.port.c_str(ctx));
+        bind_tile_global_route(net, route);
+    }
+
     bool is_global_io(CellInfo *io, std::string &glb_name)
     {
         std::string func_name = ctx->getPioFunctionName(io->bel);
@@ -216,22 +339,31 @@ class Ecp5GlobalRouter
                                             "G_" + get_quad_name(quad) + "PCLK" + std::to_string(network));
     }
 
+    SearchScratch scratch;
+
+    // Route from the existing routing tree of the net (or src if there is
+    // none yet) to dst
     bool simple_router(NetInfo *net, WireId src, WireId dst, bool allow_fail = false)
     {
-        std::queue<WireId> visit;
-        std::unordered_map<WireId, PipId> backtrace;
-        visit.push(src);
+        begin_search(scratch);
+        visit_wire(scratch, src, PipId());
+        std::vector<WireId> tree_wires;
+        for (auto &wire : net->wires)
+            tree_wires.push_back(wire.first);
+        std::sort(tree_wires.begin(), tree_wires.end());
+        for (auto wire : tree_wires)
+            visit_wire(scratch, wire, PipId());
+        size_t head = 0;
         WireId cursor;
         while (true) {
 
-            if (visit.empty() || visit.size() > 50000) {
+            if (head == scratch.fifo.size() || scratch.fifo.size() - head > 50000) {
                 if (allow_fail)
                     return false;
                 log_error("cannot route global from %s to %s.\n", ctx->getWireName(src).c_str(ctx),
                           ctx->getWireName(dst).c_str(ctx));
             }
-            cursor = visit.front();
-            visit.pop();
+            cursor = scratch.fifo.at(head++);
             NetInfo *bound = ctx->getBoundWireNet(cursor);
             if (bound == net) {
             } else if (bound != nullptr) {
@@ -239,25 +371,20 @@ class Ecp5GlobalRouter
             }
             if (cursor == dst)
                 break;
-            for (auto dh : ctx->getPipsDownhill(cursor)) {
-                WireId pipDst = ctx->getPipDstWire(dh);
-                if (backtrace.count(pipDst))
-                    continue;
-                backtrace[pipDst] = dh;
-                visit.push(pipDst);
-            }
+            for (auto dh : ctx->getPipsDownhill(cursor))
+                visit_wire(scratch, ctx->getPipDstWire(dh), dh);
         }
         while (true) {
-            auto fnd = backtrace.find(cursor);
-            if (fnd == backtrace.end())
+            PipId pip = scratch.backtrace.at(flat_wire_index(cursor));
+            if (pip == PipId())
                 break;
             NetInfo *bound = ctx->getBoundWireNet(cursor);
             if (bound != nullptr) {
                 NPNR_ASSERT(bound == net);
                 break;
             }
-            ctx->bindPip(fnd->second, net, STRENGTH_LOCKED);
-            cursor = ctx->getPipSrcWire(fnd->second);
+            ctx->bindPip(pip, net, STRENGTH_LOCKED);
+            cursor = ctx->getPipSrcWire(pip);
         }
         if (ctx->getBoundWireNet(src) == nullptr)
             ctx->bindWire(src, net, STRENGTH_LOCKED);
@@ -269,6 +396,7 @@ class Ecp5GlobalRouter
         WireId glb_src;
         NPNR_ASSERT(net->driver.cell->type == id_DCCA);
         glb_src = ctx->getNetinfoSourceWire(net);
+        setup_wire_index();
         for (int quad = QUAD_UL; quad < QUAD_LR + 1; quad++) {
             WireId glb_dst = get_global_wire(GlobalQuadrant(quad), network);
             NPNR_ASSERT(glb_dst != WireId());
@@ -291,19 +419,9 @@ class Ecp5GlobalRouter
             drv_bel = ctx->getBelByName(ctx->id(drv.cell->attrs.at(ctx->id("BEL")).as_string()));
         } else {
             // Check if driver is a singleton
-            BelId last_bel;
-            bool singleton = true;
-            for (auto bel : ctx->getBels()) {
-                if (ctx->getBelType(bel) == drv.cell->type) {
-                    if (last_bel != BelId()) {
-                        singleton = false;
-                        break;
-                    }
-                    last_bel = bel;
-                }
-            }
-            if (singleton && last_bel != BelId()) {
-                drv_bel = last_bel;
+            const auto &drv_bels = ctx->getBelsByType(drv.cell->type);
+            if (drv_bels.size() == 1) {
+                drv_bel = drv_bels.front();
             }
         }
         if (drv_bel == BelId()) {
@@ -327,36 +445,31 @@ class Ecp5GlobalRouter
     // Return true if a short (<5) route exists between two wires
     bool has_short_route(WireId src, WireId dst, int thresh = 7)
     {
-        std::queue<WireId> visit;
-        std::unordered_map<WireId, PipId> backtrace;
-        visit.push(src);
+        setup_wire_index();
+        begin_search(scratch);
+        visit_wire(scratch, src, PipId());
+        size_t head = 0;
         WireId cursor;
         while (true) {
 
-            if (visit.empty() || visit.size() > 10000) {
+            if (head == scratch.fifo.size() || scratch.fifo.size() - head > 10000) {
                 // log_info ("dist %s -> %s = inf\n", ctx->getWireName(src).c_str(ctx),
                 // ctx->getWireName(dst).c_str(ctx));
                 return false;
             }
-            cursor = visit.front();
-            visit.pop();
+            cursor = scratch.fifo.at(head++);
 
             if (cursor == dst)
                 break;
-            for (auto dh : ctx->getPipsDownhill(cursor)) {
-                WireId pipDst = ctx->getPipDstWire(dh);
-                if (backtrace.count(pipDst))
-                    continue;
-                backtrace[pipDst] = dh;
-                visit.push(pipDst);
-            }
+            for (auto dh : ctx->getPipsDownhill(cursor))
+                visit_wire(scratch, ctx->getPipDstWire(dh), dh);
         }
         int length = 0;
         while (true) {
-            auto fnd = backtrace.find(cursor);
-            if (fnd == backtrace.end())
+            PipId pip = scratch.backtrace.at(flat_wire_index(cursor));
+            if (pip == PipId())
                 break;
-            cursor = ctx->getPipSrcWire(fnd->second);
+            cursor = ctx->getPipSrcWire(pip);
             length++;
         }
         // log_info ("dist %s -> %s = %d\n", ctx->getWireName(src).c_str(ctx), ctx->getWireName(dst).c_str(ctx),
@@ -370,8 +483,8 @@ class Ecp5GlobalRouter
         BelId best_bel;
         bool using_ce = get_net_or_empty(dcc, ctx->id("CE")) != nullptr;
         wirelen_t best_wirelen = 9999999;
-        for (auto bel : ctx->getBels()) {
-            if (ctx->getBelType(bel) == id_DCCA && ctx->checkBelAvail(bel)) {
+        for (auto bel : ctx->getBelsByType(id_DCCA)) {
+            if (ctx->checkBelAvail(bel)) {
                 if (ctx->isValidBelForCell(dcc, bel)) {
                     std::string belname = ctx->locInfo(bel)->bel_data[bel.index].name.get();
                     if (belname.at(0) == 'D' && using_ce)
@@ -469,9 +582,13 @@ class Ecp5GlobalRouter
         }
     }
 
+    // Below this many loads, starting the quadrant threads costs more than the serial searches they would save
+    static const int parallel_route_threshold = 1000;
+
     void route_globals()
     {
         log_info("Routing globals...\n");
+        setup_wire_index();
         std::set<int> all_globals, fab_globals;
         for (int i = 0; i < 16; i++) {
             all_globals.insert(i);
@@ -513,9 +630,49 @@ class Ecp5GlobalRouter
                   [this](const std::pair<PortRef *, int> &a, const std::pair<PortRef *, int> &b) {
                       return global_route_priority(*a.first) < global_route_priority(*b.first);
                   });
-        for (const auto &user : toroute) {
-            route_logic_tile_global(clocks.at(user.second), user.second, *user.first);
+        if (int(toroute.size()) < parallel_route_threshold) {
+            for (const auto &user : toroute)
+                route_logic_tile_global(scratch, clocks.at(user.second), user.second, *user.first);
+            return;
+        }
+        // Global quadrants are disjoint, so search for the routes of each
+        // quadrant's loads in parallel, then bind them serially in the
+        // original order. Any route invalidated by a route bound before it
+        // (e.g. near a quadrant boundary) is searched again serially.
+        std::vector<TileGlobalRoute> routes(toroute.size());
+        std::vector<std::vector<size_t>> quad_loads(QUAD_LR + 1);
+        for (size_t i = 0; i < toroute.size(); i++) {
+            GlobalQuadrant quad = ctx->globalInfoAtLoc(toroute.at(i).first->cell->bel.location).quad;
+            quad_loads.at(quad).push_back(i);
+        }
+        std::vector<std::thread> threads;
+        for (auto &loads : quad_loads) {
+            threads.emplace_back([this, &loads, &toroute, &clocks, &routes]() {
+                SearchScratch s;
+                for (size_t i : loads) {
+                    const PortRef &user = *toroute.at(i).first;
+                    NetInfo *net = clocks.at(toroute.at(i).second);
+                    search_tile_global(s, net, get_hpbx_name(toroute.at(i).second),
+                                       ctx->getBelPinWire(user.cell->bel, user.port), routes.at(i));
+                    if (routes.at(i).found)
+                        claim_tile_global(s, net, routes.at(i));
+                }
+            });
+        }
+        for (auto &t : threads)
+            t.join();
+        int rerouted = 0;
+        for (size_t i = 0; i < toroute.size(); i++) {
+            NetInfo *net = clocks.at(toroute.at(i).second);
+            if (can_bind_tile_global(net, routes.at(i))) {
+                bind_tile_global_route(net, routes.at(i));
+            } else {
+                route_logic_tile_global(scratch, net, toroute.at(i).second, *toroute.at(i).first);
+                ++rerouted;
+            }
         }
+        if (rerouted > 0)
+            log_info("    %d/%d global loads rerouted serially\n", rerouted, int(toroute.size()));
     }
 };
 void promote_ecp5_globals(Context *ctx) { Ecp5GlobalRouter(ctx).promote_globals(); }
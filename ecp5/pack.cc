@@ -1753,6 +1753,7 @@ class Ecp5Packer
     };
 
     std::map<std::pair<int, int>, EdgeClockInfo> eclks;
+
     std::map<NetInfo *, int> bridge_side_hint;
 
     void make_eclk(PortInfo &usr_port, CellInfo *usr_cell, BelId usr_bel, int bank)
@@ -1800,9 +1801,7 @@ class Ecp5Packer
                 BelId target_bel;
                 // Find the correct Bel for the ECLKBUF
                 IdString eclkname = ctx->id("G_BANK" + std::to_string(bank) + "ECLK" + std::to_string(free_eclk));
-                for (auto bel : ctx->getBels()) {
-                    if (ctx->getBelType(bel) != id_TRELLIS_ECLKBUF)
-                        continue;
+                for (auto bel : ctx->getBelsByType(id_TRELLIS_ECLKBUF)) {
                     if (ctx->getWireBasename(ctx->getBelPinWire(bel, id_ECLKO)) != eclkname)
                         continue;
                     target_bel = bel;
@@ -2558,9 +2557,7 @@ class Ecp5Packer
                             continue;
                         Loc user_loc = ctx->getBelLocation(
                                 ctx->getBelByName(ctx->id(user.cell->attrs.at(ctx->id("BEL")).as_string())));
-                        for (auto bel : ctx->getBels()) {
-                            if (ctx->getBelType(bel) != id_ECLKBRIDGECS)
-                                continue;
+                        for (auto bel : ctx->getBelsByType(id_ECLKBRIDGECS)) {
                             loc = ctx->getBelLocation(bel);
                             if (loc.x == user_loc.x) {
                                 ci->attrs[ctx->id("BEL")] = ctx->getBelName(bel).str(ctx);
@@ -2576,9 +2573,7 @@ class Ecp5Packer
                                 ctx->getBelByName(ctx->id(drv->attrs.at(ctx->id("BEL")).as_string())));
                         BelId closest;
                         int closest_x = -1; // aim for same side of chip
-                        for (auto bel : ctx->getBels()) {
-                            if (ctx->getBelType(bel) != id_ECLKBRIDGECS)
-                                continue;
+                        for (auto bel : ctx->getBelsByType(id_ECLKBRIDGECS)) {
                             loc = ctx->getBelLocation(bel);
                             if (closest_x == -1 || std::abs(loc.x - drv_loc.x) < std::abs(closest_x - drv_loc.x)) {
                                 closest_x = loc.x;
@@ -2592,9 +2587,7 @@ class Ecp5Packer
                     }
                 }
                 // If all else fails, place randomly
-                for (auto bel : ctx->getBels()) {
-                    if (ctx->getBelType(bel) != id_ECLKBRIDGECS)
-                        continue;
+                for (auto bel : ctx->getBelsByType(id_ECLKBRIDGECS)) {
                     loc = ctx->getBelLocation(bel);
                     ci->attrs[ctx->id("BEL")] = ctx->getBelName(bel).str(ctx);
                 }
@@ -2637,9 +2630,7 @@ class Ecp5Packer
                 const NetInfo *clki = net_or_nullptr(ci, id_CLKI);
                 for (auto &eclk : eclks) {
                     if (eclk.second.unbuf == clki) {
-                        for (auto bel : ctx->getBels()) {
-                            if (ctx->getBelType(bel) != id_CLKDIVF)
-                                continue;
+                        for (auto bel : ctx->getBelsByType(id_CLKDIVF)) {
                             Loc loc = ctx->getBelLocation(bel);
                             // CLKDIVF for bank 6/7 on the left; for bank 2/3 on the right
                             if (loc.x < 10 && eclk.first.first != 6 && eclk.first.first != 7)
@@ -2674,9 +2665,7 @@ class Ecp5Packer
                     if (user.cell->type == id_TRELLIS_ECLKBUF) {
                         Loc eckbuf_loc = ctx->getBelLocation(
                                 ctx->getBelByName(ctx->id(user.cell->attrs.at(ctx->id("BEL")).as_string())));
-                        for (auto bel : ctx->getBels()) {
-                            if (ctx->getBelType(bel) != id_ECLKSYNCB)
-                                continue;
+                        for (auto bel : ctx->getBelsByType(id_ECLKSYNCB)) {
                             Loc loc = ctx->getBelLocation(bel);
                             if (loc.x == eckbuf_loc.x && loc.y == eckbuf_loc.y && loc.z == eckbuf_loc.z - 2) {
                                 ci->attrs[ctx->id("BEL")] = ctx->getBelName(bel).str(ctx);
@@ -2715,9 +2704,7 @@ class Ecp5Packer
 
                 for (auto &eclk : eclks) {
                     if (eclk.second.unbuf == clk) {
-                        for (auto bel : ctx->getBels()) {
-                            if (ctx->getBelType(bel) != id_DDRDLL)
-                                continue;
+                        for (auto bel : ctx->getBelsByType(id_DDRDLL)) {
                             Loc loc = ctx->getBelLocation(bel);
                             if (loc.x > 15 && left_bank_users)
                                 continue;
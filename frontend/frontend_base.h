@@ -159,11 +159,11 @@ template <typename FrontendType> struct GenericFrontend
             mod_refs.emplace(mod_id, mod);
             impl.foreach_attr(mod, [&](const std::string &name, const Property &value) {
                 if (name == "top")
-                    mi.is_top = (value.intval != 0);
+                    mi.is_top = (value.as_int64() != 0);
                 else if (name == "blackbox")
-                    mi.is_blackbox = (value.intval != 0);
+                    mi.is_blackbox = (value.as_int64() != 0);
                 else if (name == "whitebox")
-                    mi.is_whitebox = (value.intval != 0);
+                    mi.is_whitebox = (value.as_int64() != 0);
             });
             impl.foreach_cell(mod, [&](const std::string &name, const cell_dat_t &cell) {
                 mi.instantiated_celltypes.insert(ctx->id(impl.get_cell_type(cell)));
@@ -288,6 +288,10 @@ struct Arch : BaseCtx
     bool isValidBelForCell(CellInfo *cell, BelId bel) const;
     bool isBelLocationValid(BelId bel) const;
 
+    // Whether the arch has getWireNameString, getPipNameString, getWireByNameString and getPipByNameString, which can
+    // be called from several threads once setup_byname() has been called
+    static constexpr bool threadsafe_names = false;
+
     static const std::string defaultPlacer;
     static const std::vector<std::string> availablePlacers;
     static const std::string defaultRouter;
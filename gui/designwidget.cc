@@ -376,10 +376,12 @@ void DesignWidget::updateTree()
         std::lock_guard<std::mutex> lock(ctx->mutex);
 
         std::vector<IdString> cells;
+        cells.reserve(ctx->cells.size());
         for (auto &pair : ctx->cells) {
             cells.push_back(pair.first);
         }
         std::vector<IdString> nets;
+        nets.reserve(ctx->nets.size());
         for (auto &pair : ctx->nets) {
             nets.push_back(pair.first);
         }
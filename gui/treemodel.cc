@@ -19,6 +19,7 @@
  */
 
 #include "treemodel.h"
+#include <algorithm>
 #include "log.h"
 
 NEXTPNR_NAMESPACE_BEGIN
@@ -53,98 +54,156 @@ std::vector<QString> IdStringList::alphaNumSplit(const QString &str)
     return res;
 }
 
-void IdStringList::updateElements(Context *ctx, std::vector<IdString> elements)
+SortedIdStringItem::SortedIdStringItem(Context *ctx, IdString str, Item *parent, ElementType type)
+        : IdStringItem(ctx, str, parent, type)
 {
-    bool changed = false;
+    for (auto &part : IdStringList::alphaNumSplit(name_)) {
+        SortKeyPart kp;
+        kp.number = part.toInt(&kp.is_number);
+        kp.text = std::move(part);
+        key.push_back(std::move(kp));
+    }
+}
 
-    // For any elements that are not yet in managed_, created them.
-    std::unordered_set<IdString> element_set;
-    for (auto elem : elements) {
-        element_set.insert(elem);
-        auto existing = managed_.find(elem);
-        if (existing == managed_.end()) {
-            auto item = new IdStringItem(ctx, elem, this, child_type_);
-            managed_.emplace(elem, std::unique_ptr<IdStringItem>(item));
-            changed = true;
-        }
+bool SortedIdStringItem::keyLess(const SortedIdStringItem *a, const SortedIdStringItem *b)
+{
+    const auto &parts_a = a->key;
+    const auto &parts_b = b->key;
+
+    // Short-circuit for different part count.
+    if (parts_a.size() != parts_b.size()) {
+        return parts_a.size() < parts_b.size();
     }
 
-    // For any elements that are in managed_ but not in new, delete them.
-    auto it = managed_.begin();
-    while (it != managed_.end()) {
-        if (element_set.count(it->first) != 0) {
-            ++it;
-        } else {
-            it = managed_.erase(it);
-            changed = true;
+    for (size_t i = 0; i < parts_a.size(); i++) {
+        auto &part_a = parts_a.at(i);
+        auto &part_b = parts_b.at(i);
+
+        // If both parts are numbers, compare numerically.
+        // If they're equal, continue to next part.
+        if (part_a.is_number && part_b.is_number) {
+            if (part_a.number != part_b.number) {
+                return part_a.number < part_b.number;
+            } else {
+                continue;
+            }
         }
-    }
 
-    // Return early if there are no changes.
-    if (!changed)
-        return;
+        // For different alpha/nonalpha types, make numeric parts appear
+        // first.
+        if (part_a.is_number != part_b.is_number) {
+            return part_a.is_number;
+        }
 
-    // Rebuild children list.
-    children_.clear();
-    for (auto &pair : managed_) {
-        if (element_set.count(pair.first) != 0) {
-            children_.push_back(pair.second.get());
+        // If both parts are not numbers, compare lexically.
+        // If they're equal, continue to next part.
+        if (part_a.text == part_b.text) {
+            continue;
         }
+        return part_a.text < part_b.text;
     }
 
-    // Sort new children
-    std::sort(children_.begin(), children_.end(), [&](const Item *a, const Item *b) {
-        auto parts_a = alphaNumSplit(a->name());
-        auto parts_b = alphaNumSplit(b->name());
+    // Numerically equal keys (e.g. 'a01' and 'a1'), fall back to the raw name
+    // so that the ordering stays strict.
+    return a->name() < b->name();
+}
 
-        // Short-circuit for different part count.
-        if (parts_a.size() != parts_b.size()) {
-            return parts_a.size() < parts_b.size();
+void IdStringList::updateElements(Context *ctx, const std::vector<IdString> &elements)
+{
+    unsigned gen = ++generation_;
+    int old_count = children_.size();
+
+    // For any elements that are not yet in managed_, created them. New items
+    // register themselves at the end of children_.
+    for (auto elem : elements) {
+        auto &entry = managed_[elem];
+        if (entry == nullptr)
+            entry.reset(new SortedIdStringItem(ctx, elem, this, child_type_));
+        entry->generation = gen;
+    }
+    int added = children_.size() - old_count;
+
+    // Drop children that were not listed this time, in one pass.
+    auto is_stale = [gen](Item *item) { return static_cast<SortedIdStringItem *>(item)->generation != gen; };
+    children_.erase(std::remove_if(children_.begin(), children_.end(), is_stale), children_.end());
+    bool removed = false;
+    for (auto it = managed_.begin(); it != managed_.end();) {
+        if (it->second->generation != gen) {
+            Item::orphan(it->second.get());
+            it = managed_.erase(it);
+            removed = true;
+        } else {
+            ++it;
         }
+    }
 
-        for (size_t i = 0; i < parts_a.size(); i++) {
-            auto &part_a = parts_a.at(i);
-            auto &part_b = parts_b.at(i);
-
-            bool a_is_number, b_is_number;
-            int a_number = part_a.toInt(&a_is_number);
-            int b_number = part_b.toInt(&b_is_number);
-
-            // If both parts are numbers, compare numerically.
-            // If they're equal, continue to next part.
-            if (a_is_number && b_is_number) {
-                if (a_number != b_number) {
-                    return a_number < b_number;
-                } else {
-                    continue;
-                }
-            }
+    // Return early if there are no changes.
+    if (added == 0 && !removed)
+        return;
+    trigrams_valid_ = false;
+    if (added == 0)
+        return;
 
-            // For different alpha/nonalpha types, make numeric parts appear
-            // first.
-            if (a_is_number != b_is_number) {
-                return a_is_number;
-            }
+    // The already sorted prefix is kept; only sort the new children and merge
+    // them in.
+    auto less = [](const Item *a, const Item *b) {
+        return SortedIdStringItem::keyLess(static_cast<const SortedIdStringItem *>(a),
+                                           static_cast<const SortedIdStringItem *>(b));
+    };
+    auto mid = children_.end() - added;
+    std::sort(mid, children_.end(), less);
+    std::inplace_merge(children_.begin(), mid, children_.end(), less);
+}
 
-            // If both parts are numbers, compare lexically.
-            // If they're equal, continue to next part.
-            if (part_a == part_b) {
-                continue;
-            }
-            return part_a < part_b;
+void IdStringList::buildSearchIndex()
+{
+    trigrams_.clear();
+    for (int i = 0; i < children_.size(); i++) {
+        QString name = children_.at(i)->name();
+        const QChar *data = name.constData();
+        for (int j = 0; j + 3 <= name.size(); j++) {
+            auto &postings = trigrams_[trigram(data + j)];
+            // Only record each child once per trigram.
+            if (postings.empty() || postings.back() != i)
+                postings.push_back(i);
         }
-
-        // Same string.
-        return true;
-    });
+    }
+    trigrams_valid_ = true;
 }
 
 void IdStringList::search(QList<Item *> &results, QString text, int limit)
 {
-    for (const auto &child : children_) {
+    // Too short for the trigram index, scan linearly.
+    if (text.size() < 3) {
+        for (const auto &child : children_) {
+            if (limit != -1 && results.size() > limit)
+                return;
+
+            if (child->name().contains(text))
+                results.push_back(child);
+        }
+        return;
+    }
+
+    if (!trigrams_valid_)
+        buildSearchIndex();
+
+    // Verify candidates from the rarest trigram of the search text; any
+    // trigram that never occurs means no child can match.
+    const std::vector<int> *candidates = nullptr;
+    for (int j = 0; j + 3 <= text.size(); j++) {
+        auto found = trigrams_.find(trigram(text.constData() + j));
+        if (found == trigrams_.end())
+            return;
+        if (candidates == nullptr || found->second.size() < candidates->size())
+            candidates = &found->second;
+    }
+
+    for (int i : *candidates) {
         if (limit != -1 && results.size() > limit)
             return;
 
+        Item *child = children_.at(i);
         if (child->name().contains(text))
             results.push_back(child);
     }
@@ -162,7 +221,7 @@ void Model::loadData(Context *ctx, std::unique_ptr<Item> data)
     endResetModel();
 }
 
-void Model::updateElements(std::vector<IdString> elements)
+void Model::updateElements(const std::vector<IdString> &elements)
 {
     if (!ctx_)
         return;
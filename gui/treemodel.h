@@ -64,6 +64,11 @@ class Item
 
     void deleteChild(Item *child) { children_.removeAll(child); }
 
+    // Detach a child from its parent without touching the parent's children
+    // list. Used by containers that bulk-remove children, to avoid an O(n)
+    // removeAll() per deleted child.
+    static void orphan(Item *child) { child->parent_ = nullptr; }
+
   public:
     Item(QString name, Item *parent) : name_(name), parent_(parent)
     {
@@ -104,7 +109,7 @@ class Item
 
     virtual boost::optional<Item *> getById(IdString id) { return boost::none; }
     virtual void search(QList<Item *> &results, QString text, int limit) {}
-    virtual void updateElements(Context *ctx, std::vector<IdString> elements) {}
+    virtual void updateElements(Context *ctx, const std::vector<IdString> &elements) {}
 
     virtual ~Item()
     {
@@ -132,6 +137,30 @@ class IdStringItem : public Item
     virtual ElementType type() const override { return type_; }
 };
 
+// One alpha or numeric chunk of a natural sort key.
+struct SortKeyPart
+{
+    bool is_number;
+    int number;
+    QString text;
+};
+
+// IdStringItem with a precomputed natural sort key, as managed by
+// IdStringList.
+class SortedIdStringItem : public IdStringItem
+{
+  public:
+    SortedIdStringItem(Context *ctx, IdString str, Item *parent, ElementType type);
+
+    // Natural sort key, computed once at construction.
+    std::vector<SortKeyPart> key;
+    // Generation of the last updateElements() call that listed this item.
+    unsigned generation = 0;
+
+    // Strict weak ordering over natural sort keys.
+    static bool keyLess(const SortedIdStringItem *a, const SortedIdStringItem *b);
+};
+
 // IdString list is a static list of IdStrings which can be set/updates from
 // a vector of IdStrings. It will render each IdStrings as a child, with the
 // list sorted in a smart way.
@@ -140,15 +169,35 @@ class IdStringList : public Item
   private:
     // Children that we manage the memory for, stored for quick lookup from
     // IdString to child.
-    std::unordered_map<IdString, std::unique_ptr<IdStringItem>> managed_;
+    std::unordered_map<IdString, std::unique_ptr<SortedIdStringItem>> managed_;
     // Type of children that the list creates.
     ElementType child_type_;
+    // Generation counter used to find stale children in updateElements().
+    unsigned generation_ = 0;
+
+    // Trigram -> ascending child indices whose name contains it. Built
+    // lazily on the first search after the children change.
+    std::unordered_map<uint64_t, std::vector<int>> trigrams_;
+    bool trigrams_valid_ = false;
+
+    static uint64_t trigram(const QChar *c)
+    {
+        return (uint64_t(c[0].unicode()) << 32) | (uint64_t(c[1].unicode()) << 16) | uint64_t(c[2].unicode());
+    }
+    void buildSearchIndex();
 
   public:
     // Create an IdStringList at given partent that will contain elements of
     // the given type.
     IdStringList(ElementType type) : Item("root", nullptr), child_type_(type) {}
 
+    ~IdStringList()
+    {
+        // Avoid each child unregistering itself one by one.
+        for (auto &pair : managed_)
+            Item::orphan(pair.second.get());
+    }
+
     // Split a name into alpha/non-alpha parts, which is then used for sorting
     // of children.
     static std::vector<QString> alphaNumSplit(const QString &str);
@@ -156,8 +205,8 @@ class IdStringList : public Item
     // getById finds a child for the given IdString.
     virtual boost::optional<Item *> getById(IdString id) override { return managed_.at(id).get(); }
 
-    // (Re-)create children from a list of IdStrings.
-    virtual void updateElements(Context *ctx, std::vector<IdString> elements) override;
+    // Incrementally add/remove children to match a list of IdStrings.
+    virtual void updateElements(Context *ctx, const std::vector<IdString> &elements) override;
 
     // Find children that contain the given text.
     virtual void search(QList<Item *> &results, QString text, int limit) override;
@@ -353,7 +402,7 @@ class Model : public QAbstractItemModel
     ~Model();
 
     void loadData(Context *ctx, std::unique_ptr<Item> data);
-    void updateElements(std::vector<IdString> elements);
+    void updateElements(const std::vector<IdString> &elements);
     Item *nodeFromIndex(const QModelIndex &idx) const;
     QModelIndex indexFromNode(Item *node)
     {
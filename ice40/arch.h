@@ -900,6 +900,10 @@ struct Arch : BaseCtx
         return std::stoi(std::string("") + glb_net.str(this).back());
     }
 
+    // Whether the arch has getWireNameString, getPipNameString, getWireByNameString and getPipByNameString, which can
+    // be called from several threads once setup_byname() has been called
+    static constexpr bool threadsafe_names = false;
+
     static const std::string defaultPlacer;
     static const std::vector<std::string> availablePlacers;
     static const std::string defaultRouter;
@@ -42,13 +42,6 @@ static std::pair<std::string, std::string> split_identifier_name(const std::stri
     return std::make_pair(name.substr(0, first_slash), name.substr(first_slash + 1));
 };
 
-static std::pair<std::string, std::string> split_identifier_name_dot(const std::string &name)
-{
-    size_t first_dot = name.find('.');
-    NPNR_ASSERT(first_dot != std::string::npos);
-    return std::make_pair(name.substr(0, first_dot), name.substr(first_dot + 1));
-};
-
 // -----------------------------------------------------------------------
 
 void IdString::initialize_arch(const BaseCtx *ctx)
@@ -229,39 +222,59 @@ WireId Arch::getWireByName(IdString name) const
 {
     if (wire_by_name_cache.count(name))
         return wire_by_name_cache.at(name);
-    WireId ret;
     setup_byname();
+    WireId ret = getWireByNameString(name.str(this));
+    wire_by_name_cache[name] = ret;
+    return ret;
+}
 
-    const std::string &s = name.str(this);
-    if (s.substr(0, 9) == "SITEWIRE/") {
-        auto sp2 = split_identifier_name(s.substr(9));
+namespace {
+// The index of an already interned IdString, or -1 if there isn't one; unlike BaseCtx::id this never adds a new
+// string, so is safe to use from several threads
+int32_t existing_id(const BaseCtx *ctx, const std::string &s)
+{
+    auto found = ctx->idstring_str_to_idx->find(s);
+    return (found == ctx->idstring_str_to_idx->end()) ? -1 : found->second;
+}
+} // namespace
+
+WireId Arch::getWireByNameString(const std::string &name) const
+{
+    WireId ret;
+    size_t first_slash = name.find('/');
+    if (name.compare(0, 9, "SITEWIRE/") == 0) {
+        size_t site_end = name.find('/', 9);
+        if (site_end == std::string::npos)
+            return ret;
+        auto site_found = site_by_name.find(name.substr(9, site_end - 9));
+        int32_t wirename = existing_id(this, name.substr(site_end + 1));
+        if (site_found == site_by_name.end() || wirename == -1)
+            return ret;
         int tile, site;
-        std::tie(tile, site) = site_by_name.at(sp2.first);
+        std::tie(tile, site) = site_found->second;
         auto &tile_info = chip_info->tile_types[chip_info->tile_insts[tile].type];
-        IdString wirename = id(sp2.second);
         for (int i = 0; i < tile_info.num_wires; i++) {
-            if (tile_info.wire_data[i].site == site && tile_info.wire_data[i].name == wirename.index) {
+            if (tile_info.wire_data[i].site == site && tile_info.wire_data[i].name == wirename) {
                 ret.tile = tile;
                 ret.index = i;
                 break;
             }
         }
-    } else {
-        auto sp = split_identifier_name(s);
-        int tile = tile_by_name.at(sp.first);
+    } else if (first_slash != std::string::npos) {
+        auto tile_found = tile_by_name.find(name.substr(0, first_slash));
+        int32_t wirename = existing_id(this, name.substr(first_slash + 1));
+        if (tile_found == tile_by_name.end() || wirename == -1)
+            return ret;
+        int tile = tile_found->second;
         auto &tile_info = chip_info->tile_types[chip_info->tile_insts[tile].type];
-        IdString wirename = id(sp.second);
         for (int i = 0; i < tile_info.num_wires; i++) {
-            if (tile_info.wire_data[i].site == -1 && tile_info.wire_data[i].name == wirename.index) {
-                ret.tile = tile;
-                ret.index = i;
+            if (tile_info.wire_data[i].site == -1 && tile_info.wire_data[i].name == wirename) {
+                // Wires that are part of a node are known by the node, as the rest of the arch and netlist does
+                ret = canonicalWireId(chip_info, tile, i);
                 break;
             }
         }
     }
-
-    wire_by_name_cache[name] = ret;
-
     return ret;
 }
 
@@ -277,33 +290,59 @@ PipId Arch::getPipByName(IdString name) const
 {
     if (pip_by_name_cache.count(name))
         return pip_by_name_cache.at(name);
-    PipId ret;
     setup_byname();
+    PipId ret = getPipByNameString(name.str(this));
+    pip_by_name_cache[name] = ret;
+    return ret;
+}
 
-    const std::string &s = name.str(this);
-    if (s.substr(0, 8) == "SITEPIP/") {
-        auto sp2 = split_identifier_name(s.substr(8));
+PipId Arch::getPipByNameString(const std::string &name) const
+{
+    PipId ret;
+    size_t arrow = name.find("->");
+    if (name.compare(0, 8, "SITEPIP/") == 0) {
+        size_t site_end = name.find('/', 8);
+        size_t bel_end = (site_end == std::string::npos) ? std::string::npos : name.find('/', site_end + 1);
+        if (bel_end == std::string::npos)
+            return ret;
+        auto site_found = site_by_name.find(name.substr(8, site_end - 8));
+        int32_t belname = existing_id(this, name.substr(site_end + 1, bel_end - site_end - 1));
+        int32_t pinname = existing_id(this, name.substr(bel_end + 1));
+        if (site_found == site_by_name.end() || belname == -1 || pinname == -1)
+            return ret;
         int tile, site;
-        std::tie(tile, site) = site_by_name.at(sp2.first);
+        std::tie(tile, site) = site_found->second;
         auto &tile_info = chip_info->tile_types[chip_info->tile_insts[tile].type];
-        auto sp3 = split_identifier_name(sp2.second);
-        IdString belname = id(sp3.first), pinname = id(sp3.second);
         for (int i = 0; i < tile_info.num_pips; i++) {
-            if (tile_info.pip_data[i].site == site && tile_info.pip_data[i].bel == belname.index &&
-                tile_info.pip_data[i].extra_data == pinname.index) {
+            if (tile_info.pip_data[i].site == site && tile_info.pip_data[i].bel == belname &&
+                tile_info.pip_data[i].extra_data == pinname) {
                 ret.tile = tile;
                 ret.index = i;
                 break;
             }
         }
+    } else if (arrow != std::string::npos) {
+        // Named by its source and destination wires, as getPipName writes it
+        WireId src = getWireByNameString(name.substr(0, arrow)), dst = getWireByNameString(name.substr(arrow + 2));
+        if (src == WireId() || dst == WireId())
+            return ret;
+        for (auto pip : getPipsDownhill(src)) {
+            if (getPipDstWire(pip) == dst) {
+                ret = pip;
+                break;
+            }
+        }
     } else {
-        auto sp = split_identifier_name(s);
-        int tile = tile_by_name.at(sp.first);
+        // Named by tile and the tile's wire indices, as TILE/SRC.DST
+        size_t first_slash = name.find('/'), dot = name.find('.', first_slash);
+        if (first_slash == std::string::npos || dot == std::string::npos)
+            return ret;
+        auto tile_found = tile_by_name.find(name.substr(0, first_slash));
+        if (tile_found == tile_by_name.end())
+            return ret;
+        int tile = tile_found->second;
         auto &tile_info = chip_info->tile_types[chip_info->tile_insts[tile].type];
-
-        auto spn = split_identifier_name_dot(sp.second);
-        int fromwire = std::stoi(spn.first), towire = std::stoi(spn.second);
-
+        int fromwire = std::atoi(name.c_str() + first_slash + 1), towire = std::atoi(name.c_str() + dot + 1);
         for (int i = 0; i < tile_info.num_pips; i++) {
             if (tile_info.pip_data[i].site == -1 && tile_info.pip_data[i].src_index == fromwire &&
                 tile_info.pip_data[i].dst_index == towire) {
@@ -313,29 +352,25 @@ PipId Arch::getPipByName(IdString name) const
             }
         }
     }
-
-    pip_by_name_cache[name] = ret;
-
     return ret;
 }
 
-IdString Arch::getPipName(PipId pip) const
+IdString Arch::getPipName(PipId pip) const { return id(getPipNameString(pip)); }
+
+std::string Arch::getPipNameString(PipId pip) const
 {
     NPNR_ASSERT(pip != PipId());
-    auto loc_info  = locInfo(pip);
-    auto pip_data  = loc_info.pip_data[pip.index];
-    auto tile_inst = chip_info->tile_insts[pip.tile];
-    auto site      = pip_data.site;
-    auto bel       = pip_data.bel;
+    auto &loc_info = locInfo(pip);
+    auto &pip_data = loc_info.pip_data[pip.index];
+    auto &tile_inst = chip_info->tile_insts[pip.tile];
+    auto site = pip_data.site;
+    auto bel = pip_data.bel;
 
     if (site != -1 && pip_data.flags == PIP_SITE_INTERNAL && bel != -1) {
-        return id(std::string("SITEPIP/") +
-                    tile_inst.site_insts[site].name.get() +
-                    std::string("/") + IdString(bel).str(this) + "/" +
-                    IdString(loc_info.wire_data[pip_data.src_index].name).str(this));
+        return std::string("SITEPIP/") + tile_inst.site_insts[site].name.get() + std::string("/") +
+               IdString(bel).str(this) + "/" + IdString(loc_info.wire_data[pip_data.src_index].name).str(this);
     } else {
-        return id(getWireName(getPipSrcWire(pip)).str(this) + "->" +
-                  getWireName(getPipDstWire(pip)).str(this));
+        return getWireNameString(getPipSrcWire(pip)) + "->" + getWireNameString(getPipDstWire(pip));
     }
 }
 
@@ -653,7 +688,7 @@ bool Arch::place()
 {
     std::string placer = str_or_default(settings, id("placer"), defaultPlacer);
 
-    if (placer == "heap") {
+    if (placer == "heap" || placer == "eplace") {
         PlacerHeapCfg cfg(getCtx());
         cfg.criticalityExponent = 7;
         cfg.ioBufTypes.insert(id("IOB_IBUFCTRL"));
@@ -673,7 +708,19 @@ bool Arch::place()
         cfg.cellGroups.back().insert(id_SLICE_LUTX);
         cfg.cellGroups.back().insert(id_SLICE_FFX);
         cfg.cellGroups.back().insert(id_CARRY8);
-        if (!placer_heap(getCtx(), cfg))
+        if (getCtx()->setting<bool>("xilinx/powerDriven", false)) {
+            // Pull nets together in proportion to how often they switch, relative to the fastest switching net
+            float power_weight = getCtx()->setting<float>("placerHeap/powerWeight", 2);
+            auto activity = estimateActivity();
+            double max_rate = 0;
+            for (auto &act : activity)
+                max_rate = std::max(max_rate, act.second.density * act.second.freq);
+            if (max_rate > 0)
+                for (auto &act : activity)
+                    if (act.second.clock != act.first)
+                        cfg.netWeights[act.first] = 1 + power_weight * act.second.density * act.second.freq / max_rate;
+        }
+        if (placer == "eplace" ? !placer_eplace(getCtx(), cfg) : !placer_heap(getCtx(), cfg))
             return false;
     } else if (placer == "sa") {
         if (!placer1(getCtx(), Placer1Cfg(getCtx())))
@@ -1394,7 +1441,7 @@ const std::string Arch::defaultPlacer = "sa";
 
 const std::vector<std::string> Arch::availablePlacers = {"sa",
 #ifdef WITH_HEAP
-                                                         "heap"
+                                                         "heap", "eplace"
 #endif
 };
 
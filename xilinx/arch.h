@@ -700,6 +700,55 @@ struct Arch : BaseCtx
         {
             bool valid = true, dirty = true;
         } halfs[8];
+
+        // Compact copy of what the validity checks need from cells[], kept up to date by updateLogicBel so that the
+        // checks don't have to chase cell and net pointers. Cells and nets are given by the index of their name, or
+        // -1 for none
+        struct LutSlot
+        {
+            int32_t cell = -1;
+            int32_t inputs[6] = {-1, -1, -1, -1, -1, -1};
+            int32_t outputs[2] = {-1, -1};
+            int32_t address_msb[3] = {-1, -1, -1};
+            int32_t di1 = -1, di2 = -1, wclk = -1;
+            // Bit (net index % 64) set for each input; LUTs with no bits in common share no inputs
+            uint64_t input_mask = 0;
+            int8_t input_count = 0, output_count = 0;
+            bool is_memory = false, is_srl = false, only_drives_carry = false;
+            // Whether each output has more than one user
+            bool output_shared[2] = {false, false};
+        };
+        struct FFSlot
+        {
+            // See ffInfo.ctrl_set
+            int32_t cell = -1, ctrl_set = -1;
+            int32_t clk = -1, ce = -1, d = -1;
+            // Cell driving D, and whether that is through the MC31 output of an SRL
+            int32_t d_driver = -1;
+            bool d_from_mc31 = false;
+            bool is_latch = false;
+        };
+        struct MuxSlot
+        {
+            int32_t cell = -1, sel = -1, out = -1;
+            bool out_shared = false;
+        };
+        struct CarrySlot
+        {
+            int32_t out[8] = {-1, -1, -1, -1, -1, -1, -1, -1};
+            int32_t x[8] = {-1, -1, -1, -1, -1, -1, -1, -1};
+        };
+        // Bit z is set if cells[z] is occupied
+        uint64_t used[2] = {0, 0};
+        // Indexed by (eighth << 1) | (5LUT or FF2)
+        LutSlot luts[16];
+        FFSlot ffs[16];
+        // Indexed by [F7MUX, F8MUX, F9MUX][eighth]
+        MuxSlot muxes[3][8];
+        // Indexed by z >> 6; xc7 has a CARRY4 in each half, UltraScale one CARRY8
+        CarrySlot carries[2];
+
+        bool is_used(int z) const { return (used[z >> 6] >> (z & 63)) & 1; }
     };
 
     struct BRAMTileStatus
@@ -762,6 +811,8 @@ struct Arch : BaseCtx
 
     uint32_t getBelChecksum(BelId bel) const { return bel.index; }
 
+    void updateLogicMirror(LogicTileStatus &ts, int z, const CellInfo *cell);
+
     void updateLogicBel(BelId bel, CellInfo *cell)
     {
         int z = locInfo(bel).bel_data[bel.index].z;
@@ -788,7 +839,12 @@ struct Arch : BaseCtx
             if (xc7)
                 ts.halfs[0].dirty = true; // WCLK and CLK0 shared
         }
+        if (xc7 && (((z & 0xF) == BEL_6LUT) || ((z & 0xF) == BEL_5LUT)) &&
+            ((cell != nullptr && cell->lutInfo.is_memory) || ts.luts[((z >> 4) << 1) | (z & 0x1)].is_memory))
+            ts.halfs[0].dirty = true; // WCLK of any memory LUT must match CLK0
+
         ts.cells[z] = cell;
+        updateLogicMirror(ts, z, cell);
         // determine which sections to mark as dirty
         switch (z & 0xF) {
         case BEL_FF:
@@ -959,6 +1015,26 @@ struct Arch : BaseCtx
     mutable std::unordered_map<IdString, WireId> wire_by_name_cache;
 
     WireId getWireByName(IdString name) const;
+    // Forms of getWireByName/getWireName, and getPipByName/getPipName, that neither intern names nor use the name
+    // caches, so can be called from several threads at once once setup_byname() has been called
+    WireId getWireByNameString(const std::string &name) const;
+    std::string getWireNameString(WireId wire) const
+    {
+        NPNR_ASSERT_MSG(wire != WireId(), "uninitialized wire");
+        if (wire.tile != -1 && locInfo(wire).wire_data[wire.index].site != -1) {
+            return std::string("SITEWIRE/") +
+                   chip_info->tile_insts[wire.tile].site_insts[locInfo(wire).wire_data[wire.index].site].name.get() +
+                   std::string("/") + IdString(locInfo(wire).wire_data[wire.index].name).str(this);
+        } else {
+            return std::string(chip_info
+                                       ->tile_insts[wire.tile == -1 ? chip_info->nodes[wire.index].tile_wires[0].tile
+                                                                    : wire.tile]
+                                       .name.get()) +
+                   "/" + IdString(wireInfo(wire).name).c_str(this);
+        }
+    }
+    PipId getPipByNameString(const std::string &name) const;
+    std::string getPipNameString(PipId pip) const;
 
     const TileWireInfoPOD &wireInfo(WireId wire) const
     {
@@ -970,21 +1046,7 @@ struct Arch : BaseCtx
         }
     }
 
-    IdString getWireName(WireId wire) const
-    {
-        NPNR_ASSERT_MSG(wire != WireId(), "uninitialized wire");
-        if (wire.tile != -1 && locInfo(wire).wire_data[wire.index].site != -1) {
-            return id(std::string("SITEWIRE/") +
-                      chip_info->tile_insts[wire.tile].site_insts[locInfo(wire).wire_data[wire.index].site].name.get() +
-                      std::string("/") + IdString(locInfo(wire).wire_data[wire.index].name).str(this));
-        } else {
-            return id(std::string(chip_info
-                                          ->tile_insts[wire.tile == -1 ? chip_info->nodes[wire.index].tile_wires[0].tile
-                                                                       : wire.tile]
-                                          .name.get()) +
-                      "/" + IdString(wireInfo(wire).name).c_str(this));
-        }
-    }
+    IdString getWireName(WireId wire) const { return id(getWireNameString(wire)); }
 
     IdString getWireType(WireId wire) const;
     std::vector<std::pair<IdString, std::string>> getWireAttrs(WireId wire) const;
@@ -1617,6 +1679,8 @@ struct Arch : BaseCtx
     // netlist modifications, and validity checks
     void assignArchInfo();
     void assignCellInfo(CellInfo *cell);
+    // IDs given to flipflop control sets, see ffInfo.ctrl_set
+    std::map<std::vector<int32_t>, int> ff_control_sets;
 
     void fixupPlacement();
     void fixupRouting();
@@ -1650,6 +1714,10 @@ struct Arch : BaseCtx
 
     // -------------------------------------------------
 
+    // Whether the arch has getWireNameString, getPipNameString, getWireByNameString and getPipByNameString, which can
+    // be called from several threads once setup_byname() has been called
+    static constexpr bool threadsafe_names = true;
+
     static const std::string defaultPlacer;
     static const std::vector<std::string> availablePlacers;
 
@@ -1663,6 +1731,19 @@ struct Arch : BaseCtx
     }
     // -------------------------------------------------
     void writeFasm(const std::string &filename);
+
+    // -------------------------------------------------
+    // Switching activity of a net: the probability of it being high, the transitions per clock cycle, and the clock
+    // (and its frequency in Hz) that it is switched by
+    struct NetActivity
+    {
+        double prob = 0.5, density = 0;
+        IdString clock;
+        double freq = 0;
+    };
+    double getClockFrequency(const NetInfo *clock) const;
+    std::unordered_map<IdString, NetActivity> estimateActivity();
+    void writePowerReport(const std::string &filename);
 };
 
 NEXTPNR_NAMESPACE_END
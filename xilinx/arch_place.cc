@@ -41,208 +41,282 @@ inline NetInfo *port_or_nullptr(const CellInfo *cell, IdString name)
 #define DBG()
 #endif
 
+namespace {
+inline int32_t net_index(const NetInfo *net) { return net == nullptr ? -1 : net->name.index; }
+
+// Whether the 6LUT and 5LUT of an eighth have no more than 5 distinct inputs between them
+bool lut_inputs_fit(const Arch::LogicTileStatus::LutSlot &lut6, const Arch::LogicTileStatus::LutSlot &lut5)
+{
+    int need_shared = lut6.input_count + lut5.input_count - 5;
+    if (need_shared <= 0)
+        return true;
+    // Shared inputs set the same bit in both masks
+    if ((lut6.input_mask & lut5.input_mask) == 0)
+        return false;
+    int shared = 0;
+    for (int j = 0; j < lut6.input_count; j++) {
+        for (int k = 0; k < lut5.input_count; k++) {
+            if (lut6.inputs[j] == lut5.inputs[k])
+                shared++;
+            if (shared >= need_shared)
+                break;
+        }
+    }
+    return shared >= need_shared;
+}
+
+// Use a net on a site input that might already be used by another net
+inline bool use_input(int32_t &input, int32_t net)
+{
+    if (input == -1) {
+        input = net;
+        return true;
+    }
+    return input == net;
+}
+} // namespace
+
+void Arch::updateLogicMirror(LogicTileStatus &ts, int z, const CellInfo *cell)
+{
+    if (cell != nullptr)
+        ts.used[z >> 6] |= (1ULL << (z & 63));
+    else
+        ts.used[z >> 6] &= ~(1ULL << (z & 63));
+    int eighth = z >> 4;
+    switch (z & 0xF) {
+    case BEL_6LUT:
+    case BEL_5LUT: {
+        auto &lut = ts.luts[(eighth << 1) | (z & 0x1)];
+        lut = LogicTileStatus::LutSlot();
+        if (cell == nullptr)
+            break;
+        lut.cell = cell->name.index;
+        lut.input_count = cell->lutInfo.input_count;
+        for (int i = 0; i < lut.input_count; i++) {
+            lut.inputs[i] = net_index(cell->lutInfo.input_sigs[i]);
+            lut.input_mask |= (1ULL << (lut.inputs[i] & 63));
+        }
+        lut.output_count = cell->lutInfo.output_count;
+        for (int i = 0; i < 2; i++) {
+            NetInfo *out = cell->lutInfo.output_sigs[i];
+            lut.outputs[i] = net_index(out);
+            lut.output_shared[i] = (out != nullptr && out->users.size() > 1);
+        }
+        for (int i = 0; i < 3; i++)
+            lut.address_msb[i] = net_index(cell->lutInfo.address_msb[i]);
+        lut.di1 = net_index(cell->lutInfo.di1_net);
+        lut.di2 = net_index(cell->lutInfo.di2_net);
+        lut.wclk = net_index(cell->lutInfo.wclk);
+        lut.is_memory = cell->lutInfo.is_memory;
+        lut.is_srl = cell->lutInfo.is_srl;
+        lut.only_drives_carry = cell->lutInfo.only_drives_carry;
+        break;
+    }
+    case BEL_FF:
+    case BEL_FF2: {
+        auto &ff = ts.ffs[(eighth << 1) | ((z & 0xF) - BEL_FF)];
+        ff = LogicTileStatus::FFSlot();
+        if (cell == nullptr)
+            break;
+        ff.cell = cell->name.index;
+        ff.ctrl_set = cell->ffInfo.ctrl_set;
+        ff.clk = net_index(cell->ffInfo.clk);
+        ff.ce = net_index(cell->ffInfo.ce);
+        ff.d = net_index(cell->ffInfo.d);
+        if (cell->ffInfo.d != nullptr && cell->ffInfo.d->driver.cell != nullptr) {
+            ff.d_driver = cell->ffInfo.d->driver.cell->name.index;
+            ff.d_from_mc31 = (cell->ffInfo.d->driver.port == id_MC31);
+        }
+        ff.is_latch = cell->ffInfo.is_latch;
+        break;
+    }
+    case BEL_F7MUX:
+    case BEL_F8MUX:
+    case BEL_F9MUX: {
+        auto &mux = ts.muxes[(z & 0xF) - BEL_F7MUX][eighth];
+        mux = LogicTileStatus::MuxSlot();
+        if (cell == nullptr)
+            break;
+        mux.cell = cell->name.index;
+        mux.sel = net_index(cell->muxInfo.sel);
+        mux.out = net_index(cell->muxInfo.out);
+        mux.out_shared = (cell->muxInfo.out != nullptr && cell->muxInfo.out->users.size() > 1);
+        break;
+    }
+    case BEL_CARRY8:
+    case BEL_CARRY4: {
+        auto &carry = ts.carries[z >> 6];
+        carry = LogicTileStatus::CarrySlot();
+        if (cell == nullptr)
+            break;
+        int width = ((z & 0xF) == BEL_CARRY4) ? 4 : 8;
+        for (int i = 0; i < width; i++) {
+            carry.out[i] = net_index(cell->carryInfo.out_sigs[i]);
+            carry.x[i] = net_index(cell->carryInfo.x_sigs[i]);
+        }
+        break;
+    }
+    }
+}
+
 bool Arch::xcu_logic_tile_valid(IdString tileType, LogicTileStatus &lts) const
 {
     bool is_slicem = (tileType == id_CLEM) || (tileType == id_CLEM_R);
-    bool tile_is_memory = false;
-    if (lts.cells[(7 << 4) | BEL_6LUT] != nullptr && lts.cells[(7 << 4) | BEL_6LUT]->lutInfo.is_memory)
-        tile_is_memory = true;
-    bool small_memory = false;
-    if (lts.cells[(7 << 4) | BEL_5LUT] != nullptr && lts.cells[(7 << 4) | BEL_5LUT]->lutInfo.is_memory)
-        small_memory = true;
+    const auto &top_lut = lts.luts[(7 << 1) | 0];
+    bool tile_is_memory = top_lut.is_memory;
+    bool small_memory = lts.luts[(7 << 1) | 1].is_memory;
+    const auto &carry8 = lts.carries[0];
     // Check eight-tiles (mostly LUT-related validity)
     for (int i = 0; i < 8; i++) {
         if (lts.eights[i].dirty) {
             lts.eights[i].dirty = false;
             lts.eights[i].valid = false;
 
-            CellInfo *lut6 = lts.cells[(i << 4) | BEL_6LUT];
-            CellInfo *lut5 = lts.cells[(i << 4) | BEL_5LUT];
+            const auto &lut6 = lts.luts[i << 1];
+            const auto &lut5 = lts.luts[(i << 1) | 1];
 
             // Check 6LUT
-            if (lut6 != nullptr) {
-                if (!is_slicem && (lut6->lutInfo.is_memory || lut6->lutInfo.is_srl))
+            if (lut6.cell != -1) {
+                if (!is_slicem && (lut6.is_memory || lut6.is_srl))
                     return false; // Memory and SRLs only valid in SLICEMs
-                if (lut5 != nullptr) {
+                if (lut5.cell != -1) {
                     // Can't mix memory and non-memory
-                    if (lut6->lutInfo.is_memory != lut5->lutInfo.is_memory ||
-                        lut6->lutInfo.is_srl != lut5->lutInfo.is_srl)
+                    if (lut6.is_memory != lut5.is_memory || lut6.is_srl != lut5.is_srl)
                         return false;
                     // If all 6 inputs or 2 outputs are used, 5LUT can't also be present
-                    if (lut6->lutInfo.input_count == 6 || lut6->lutInfo.output_count == 2)
+                    if (lut6.input_count == 6 || lut6.output_count == 2)
                         return false;
                     // If more than 5 total inputs are used, need to check number of shared input
-                    if ((lut6->lutInfo.input_count + lut5->lutInfo.input_count) > 5) {
-                        int shared = 0, need_shared = (lut6->lutInfo.input_count + lut5->lutInfo.input_count - 5);
-                        for (int j = 0; j < lut6->lutInfo.input_count; j++) {
-                            for (int k = 0; k < lut5->lutInfo.input_count; k++) {
-                                if (lut6->lutInfo.input_sigs[j] == lut5->lutInfo.input_sigs[k])
-                                    shared++;
-                                if (shared >= need_shared)
-                                    break;
-                            }
-                        }
-                        if (shared < need_shared) {
-                            DBG();
-                            return false;
-                        }
+                    if (!lut_inputs_fit(lut6, lut5)) {
+                        DBG();
+                        return false;
                     }
                 }
             }
-            if (lut5 != nullptr) {
-                if (!is_slicem && (lut5->lutInfo.is_memory || lut5->lutInfo.is_srl)) {
+            if (lut5.cell != -1) {
+                if (!is_slicem && (lut5.is_memory || lut5.is_srl)) {
                     DBG();
                     return false; // Memory and SRLs only valid in SLICEMs
                 }
                 // 5LUT can use at most 5 inputs and 1 output
-                if (lut5->lutInfo.input_count > 5 || lut5->lutInfo.output_count == 2) {
+                if (lut5.input_count > 5 || lut5.output_count == 2) {
                     DBG();
-                    return false; // Memory and SRLs only valid in SLICEMs
+                    return false;
                 }
             }
 
             // Check (over)usage of DI and X inputs
-            NetInfo *i_net = nullptr, *x_net = nullptr;
-            if (lut6 != nullptr) {
-                i_net = lut6->lutInfo.di1_net;
-                x_net = lut6->lutInfo.di2_net;
+            int32_t i_net = lut6.di1, x_net = lut6.di2;
+            if (lut5.di1 != -1 && !use_input(i_net, lut5.di1)) {
+                DBG();
+                return false;
             }
-            if (lut5 != nullptr) {
-                if (lut5->lutInfo.di1_net != nullptr) {
-                    if (i_net == nullptr)
-                        i_net = lut5->lutInfo.di1_net;
-                    else if (i_net != lut5->lutInfo.di1_net) {
-                        DBG();
-                        return false; // Memory and SRLs only valid in SLICEMs
-                    }
-                }
-                // DI2 not available for 5LUT
-                if (lut5->lutInfo.di2_net != nullptr) {
-                    DBG();
-                    return false; // Memory and SRLs only valid in SLICEMs
-                }
+            // DI2 not available for 5LUT
+            if (lut5.di2 != -1) {
+                DBG();
+                return false;
             }
 
-            CellInfo *mux = nullptr;
+            const LogicTileStatus::MuxSlot *mux = nullptr;
             // Eights A, C, E, G: F7MUX uses X input
             if (i == 0 || i == 2 || i == 4 || i == 6)
-                mux = lts.cells[i << 4 | BEL_F7MUX];
+                mux = &lts.muxes[0][i];
             // Eights B, F: F8MUX uses X input
             if (i == 1 || i == 5)
-                mux = lts.cells[(i - 1) << 4 | BEL_F8MUX];
+                mux = &lts.muxes[1][i - 1];
             // Eights D: F9MUX uses X input
             if (i == 3)
-                mux = lts.cells[BEL_F9MUX];
+                mux = &lts.muxes[2][0];
 
-            if (mux != nullptr) {
-                if (x_net == nullptr)
-                    x_net = mux->muxInfo.sel;
-                else if (x_net != mux->muxInfo.sel) {
-                    DBG();
-                    return false; // Memory and SRLs only valid in SLICEMs
-                }
+            if (mux != nullptr && mux->cell != -1 && !use_input(x_net, mux->sel)) {
+                DBG();
+                return false;
             }
 
-            CellInfo *out_fmux = nullptr;
+            const LogicTileStatus::MuxSlot *out_fmux = nullptr;
             // Eights B, D, F, H: F7MUX connects to F7F8 out
             if (i == 1 || i == 3 || i == 5 || i == 7)
-                out_fmux = lts.cells[(i - 1) << 4 | BEL_F7MUX];
+                out_fmux = &lts.muxes[0][i - 1];
             // Eights C, G: F8MUX connects to F7F8 out
             if (i == 2 || i == 6)
-                out_fmux = lts.cells[(i - 2) << 4 | BEL_F8MUX];
+                out_fmux = &lts.muxes[1][i - 2];
             // Eights E: F9MUX connects to F7F8 out
             if (i == 4)
-                out_fmux = lts.cells[BEL_F9MUX];
+                out_fmux = &lts.muxes[2][0];
+            int32_t out_fmux_cell = (out_fmux != nullptr) ? out_fmux->cell : -1;
 
-            CellInfo *carry8 = lts.cells[BEL_CARRY8];
             // CARRY8 might use X
-            if (carry8 != nullptr && carry8->carryInfo.x_sigs[i] != nullptr) {
-                if (x_net == nullptr)
-                    x_net = carry8->carryInfo.x_sigs[i];
-                else if (x_net != carry8->carryInfo.x_sigs[i]) {
-                    DBG();
-                    return false; // Memory and SRLs only valid in SLICEMs
-                }
+            if (carry8.x[i] != -1 && !use_input(x_net, carry8.x[i])) {
+                DBG();
+                return false;
             }
 
             // FF1 might use X, if it isn't driven directly
-            CellInfo *ff1 = lts.cells[i << 4 | BEL_FF];
-            if (ff1 != nullptr && ff1->ffInfo.d != nullptr && ff1->ffInfo.d->driver.cell != nullptr) {
-                auto &drv = ff1->ffInfo.d->driver;
-                if ((drv.cell == lut6 && drv.port != id_MC31) || drv.cell == lut5 || drv.cell == out_fmux) {
+            const auto &ff1 = lts.ffs[i << 1];
+            if (ff1.d_driver != -1) {
+                if ((ff1.d_driver == lut6.cell && !ff1.d_from_mc31) || ff1.d_driver == lut5.cell ||
+                    ff1.d_driver == out_fmux_cell) {
                     // Direct, OK
                     // FIXME: CARRY8 direct
-                } else {
+                } else if (!use_input(x_net, ff1.d)) {
                     // Indirect, must use X input
-                    if (x_net == nullptr)
-                        x_net = ff1->ffInfo.d;
-                    else if (x_net != ff1->ffInfo.d) {
-                        DBG();
-                        return false; // Memory and SRLs only valid in SLICEMs
-                    }
+                    DBG();
+                    return false;
                 }
             }
 
             // FF2 might use I, if it isn't driven directly
-            CellInfo *ff2 = lts.cells[i << 4 | BEL_FF2];
-            if (ff2 != nullptr && ff2->ffInfo.d != nullptr && ff2->ffInfo.d->driver.cell != nullptr) {
-                auto &drv = ff2->ffInfo.d->driver;
-                if ((drv.cell == lut6 && drv.port != id_MC31) || drv.cell == lut5 || drv.cell == out_fmux) {
+            const auto &ff2 = lts.ffs[(i << 1) | 1];
+            if (ff2.d_driver != -1) {
+                if ((ff2.d_driver == lut6.cell && !ff2.d_from_mc31) || ff2.d_driver == lut5.cell ||
+                    ff2.d_driver == out_fmux_cell) {
                     // Direct, OK
                     // FIXME: CARRY8 direct
-                } else {
-                    // Indirect, must use X input
-                    if (i_net == nullptr)
-                        i_net = ff2->ffInfo.d;
-                    else if (i_net != ff2->ffInfo.d) {
-                        DBG();
-                        return false; // Memory and SRLs only valid in SLICEMs
-                    }
+                } else if (!use_input(i_net, ff2.d)) {
+                    // Indirect, must use I input
+                    DBG();
+                    return false;
                 }
             }
 
             // Collision with top address bits
             if (tile_is_memory && !small_memory) {
-                CellInfo *top_lut = lts.cells[(7 << 4) | BEL_6LUT];
-                if (top_lut != nullptr) {
-                    if ((i == 6) && x_net != top_lut->lutInfo.address_msb[0])
-                        return false;
-                    if ((i == 5) && x_net != top_lut->lutInfo.address_msb[1])
-                        return false;
-                    if ((i == 3) && x_net != top_lut->lutInfo.address_msb[2])
-                        return false;
-                }
+                if ((i == 6) && x_net != top_lut.address_msb[0])
+                    return false;
+                if ((i == 5) && x_net != top_lut.address_msb[1])
+                    return false;
+                if ((i == 3) && x_net != top_lut.address_msb[2])
+                    return false;
             }
 
             bool mux_output_used = false;
-            NetInfo *out5 = nullptr;
-            if (lut6 != nullptr && lut6->lutInfo.output_count == 2)
-                out5 = lut6->lutInfo.output_sigs[1];
-            else if (lut5 != nullptr && !lut5->lutInfo.only_drives_carry)
-                out5 = lut5->lutInfo.output_sigs[0];
-            if (out5 != nullptr && (out5->users.size() > 1 || ((ff1 == nullptr || out5 != ff1->ffInfo.d) &&
-                                                               (ff2 == nullptr || out5 != ff2->ffInfo.d)))) {
-                mux_output_used = true;
+            int32_t out5 = -1;
+            bool out5_shared = false;
+            if (lut6.output_count == 2) {
+                out5 = lut6.outputs[1];
+                out5_shared = lut6.output_shared[1];
+            } else if (lut5.cell != -1 && !lut5.only_drives_carry) {
+                out5 = lut5.outputs[0];
+                out5_shared = lut5.output_shared[0];
             }
+            if (out5 != -1 && (out5_shared || (out5 != ff1.d && out5 != ff2.d)))
+                mux_output_used = true;
 
-            if (carry8 != nullptr && carry8->carryInfo.out_sigs[i] != nullptr) {
+            if (carry8.out[i] != -1) {
                 // FIXME: direct connections to FF
                 if (mux_output_used) {
                     DBG();
-                    return false; // Memory and SRLs only valid in SLICEMs
+                    return false;
                 }
                 mux_output_used = true;
             }
-            if (out_fmux != nullptr) {
-                NetInfo *f7f8 = out_fmux->muxInfo.out;
-                if (f7f8 != nullptr && (f7f8->users.size() > 1 || ((ff1 == nullptr || f7f8 != ff1->ffInfo.d) &&
-                                                                   (ff2 == nullptr || f7f8 != ff2->ffInfo.d)))) {
-                    if (mux_output_used) {
-                        DBG();
-                        return false; // Memory and SRLs only valid in SLICEMs
-                    }
-                    mux_output_used = true;
+            if (out_fmux != nullptr && out_fmux->out != -1 &&
+                (out_fmux->out_shared || (out_fmux->out != ff1.d && out_fmux->out != ff2.d))) {
+                if (mux_output_used) {
+                    DBG();
+                    return false;
                 }
+                mux_output_used = true;
             }
 
             lts.eights[i].valid = true;
@@ -253,38 +327,27 @@ bool Arch::xcu_logic_tile_valid(IdString tileType, LogicTileStatus &lts) const
     // Check half-tiles
     for (int i = 0; i < 2; i++) {
         if (lts.halfs[i].dirty) {
+            lts.halfs[i].dirty = false;
             lts.halfs[i].valid = false;
             bool found_ff[2] = {false, false};
-            NetInfo *clk = nullptr, *sr = nullptr, *ce[2] = {nullptr};
-            bool clkinv = false, srinv = false, islatch = false;
+            int32_t ctrl_set = -1, ce[2] = {-1, -1};
             for (int z = 4 * i; z < 4 * (i + 1); z++) {
                 for (int k = 0; k < 2; k++) {
-                    CellInfo *ff = lts.cells[z << 4 | (BEL_FF + k)];
-                    if (ff == nullptr)
+                    const auto &ff = lts.ffs[(z << 1) | k];
+                    if (ff.cell == -1)
                         continue;
+                    // Clock, SR, inversion and latch mode are shared by the half
                     if (found_ff[0] || found_ff[1]) {
-                        if (ff->ffInfo.clk != clk)
-                            return false;
-                        if (ff->ffInfo.sr != sr)
-                            return false;
-                        if (ff->ffInfo.is_clkinv != clkinv)
-                            return false;
-                        if (ff->ffInfo.is_srinv != srinv)
-                            return false;
-                        if (ff->ffInfo.is_latch != islatch)
+                        if (ff.ctrl_set != ctrl_set)
                             return false;
                     } else {
-                        clk = ff->ffInfo.clk;
-                        sr = ff->ffInfo.sr;
-                        clkinv = ff->ffInfo.is_clkinv;
-                        srinv = ff->ffInfo.is_srinv;
-                        islatch = ff->ffInfo.is_latch;
+                        ctrl_set = ff.ctrl_set;
                     }
                     if (found_ff[k]) {
-                        if (ff->ffInfo.ce != ce[k])
+                        if (ff.ce != ce[k])
                             return false;
                     } else {
-                        ce[k] = ff->ffInfo.ce;
+                        ce[k] = ff.ce;
                     }
                     found_ff[k] = true;
                 }
@@ -300,214 +363,155 @@ bool Arch::xcu_logic_tile_valid(IdString tileType, LogicTileStatus &lts) const
 bool Arch::xc7_logic_tile_valid(IdString tileType, LogicTileStatus &lts) const
 {
     bool is_slicem = (tileType == id_CLBLM_L) || (tileType == id_CLBLM_R);
-    bool tile_is_memory = false;
-    if (lts.cells[(3 << 4) | BEL_6LUT] != nullptr && lts.cells[(3 << 4) | BEL_6LUT]->lutInfo.is_memory)
-        tile_is_memory = true;
-    bool small_memory = false;
-    if (lts.cells[(3 << 4) | BEL_5LUT] != nullptr && lts.cells[(3 << 4) | BEL_5LUT]->lutInfo.is_memory)
-        small_memory = true;
-    NetInfo *wclk = nullptr;
+    const auto &top_lut = lts.luts[(3 << 1) | 0];
+    bool tile_is_memory = top_lut.is_memory;
+    bool small_memory = lts.luts[(3 << 1) | 1].is_memory;
+    int32_t wclk = -1;
     // Check eight-tiles (mostly LUT-related validity)
     for (int i = 0; i < 8; i++) {
         if (lts.eights[i].dirty) {
             lts.eights[i].dirty = false;
             lts.eights[i].valid = false;
 
-            CellInfo *lut6 = lts.cells[(i << 4) | BEL_6LUT];
-            CellInfo *lut5 = lts.cells[(i << 4) | BEL_5LUT];
+            const auto &lut6 = lts.luts[i << 1];
+            const auto &lut5 = lts.luts[(i << 1) | 1];
 
             // Check 6LUT
-            if (lut6 != nullptr) {
-                if (!is_slicem && (lut6->lutInfo.is_memory || lut6->lutInfo.is_srl))
+            if (lut6.cell != -1) {
+                if (!is_slicem && (lut6.is_memory || lut6.is_srl))
                     return false; // Memory and SRLs only valid in SLICEMs
-                if (lut6->lutInfo.is_srl && (i >= 4))
+                if (lut6.is_srl && (i >= 4))
+                    return false;
+                if ((lut6.is_memory || lut6.is_srl) && !use_input(wclk, lut6.wclk)) {
+                    DBG();
                     return false;
-                if (lut6->lutInfo.is_memory || lut6->lutInfo.is_srl) {
-                    if (wclk == nullptr)
-                        wclk = lut6->lutInfo.wclk;
-                    else if (lut6->lutInfo.wclk != wclk) {
-                        DBG();
-                        return false;
-                    }
                 }
-                if (lut5 != nullptr) {
+                if (lut5.cell != -1) {
                     // Can't mix memory and non-memory
-                    if (lut6->lutInfo.is_memory != lut5->lutInfo.is_memory ||
-                        lut6->lutInfo.is_srl != lut5->lutInfo.is_srl) {
+                    if (lut6.is_memory != lut5.is_memory || lut6.is_srl != lut5.is_srl) {
                         DBG();
                         return false;
                     }
                     // If all 6 inputs or 2 outputs are used, 5LUT can't also be present
-                    if (lut6->lutInfo.input_count == 6 || lut6->lutInfo.output_count == 2) {
+                    if (lut6.input_count == 6 || lut6.output_count == 2) {
                         DBG();
                         return false;
                     }
                     // If more than 5 total inputs are used, need to check number of shared input
-                    if ((lut6->lutInfo.input_count + lut5->lutInfo.input_count) > 5) {
-                        int shared = 0, need_shared = (lut6->lutInfo.input_count + lut5->lutInfo.input_count - 5);
-                        for (int j = 0; j < lut6->lutInfo.input_count; j++) {
-                            for (int k = 0; k < lut5->lutInfo.input_count; k++) {
-                                if (lut6->lutInfo.input_sigs[j] == lut5->lutInfo.input_sigs[k])
-                                    shared++;
-                                if (shared >= need_shared)
-                                    break;
-                            }
-                        }
-                        if (shared < need_shared) {
-                            DBG();
-                            return false;
-                        }
+                    if (!lut_inputs_fit(lut6, lut5)) {
+                        DBG();
+                        return false;
                     }
                 }
             }
-            if (lut5 != nullptr) {
-                if (!is_slicem && (lut5->lutInfo.is_memory || lut5->lutInfo.is_srl)) {
+            if (lut5.cell != -1) {
+                if (!is_slicem && (lut5.is_memory || lut5.is_srl)) {
                     DBG();
                     return false; // Memory and SRLs only valid in SLICEMs
                 }
-                if (lut5->lutInfo.is_srl) {
-                    if (wclk == nullptr)
-                        wclk = lut5->lutInfo.wclk;
-                    else if (lut5->lutInfo.wclk != wclk) {
-                        DBG();
-                        return false;
-                    }
+                if (lut5.is_srl && !use_input(wclk, lut5.wclk)) {
+                    DBG();
+                    return false;
                 }
                 // 5LUT can use at most 5 inputs and 1 output
-                if (lut5->lutInfo.input_count > 5 || lut5->lutInfo.output_count == 2) {
+                if (lut5.input_count > 5 || lut5.output_count == 2) {
                     DBG();
-                    return false; // Memory and SRLs only valid in SLICEMs
+                    return false;
                 }
             }
 
-            // Check (over)usage ofX inputs
-            NetInfo *x_net = nullptr;
-            if (lut6 != nullptr) {
-                x_net = lut6->lutInfo.di2_net;
-            }
+            // Check (over)usage of X inputs
+            int32_t x_net = lut6.di2;
 
-            CellInfo *mux = nullptr;
-            // Eights A, C, E, G: F7MUX uses X input
+            const LogicTileStatus::MuxSlot *mux = nullptr;
+            // Eights A, C, E, G: F7MUX uses X input, and connects to F7F8 out
             if (i == 0 || i == 2 || i == 4 || i == 6)
-                mux = lts.cells[i << 4 | BEL_F7MUX];
-            // Eights B, F: F8MUX uses X input
+                mux = &lts.muxes[0][i];
+            // Eights B, F: F8MUX uses X input, and connects to F7F8 out
             if (i == 1 || i == 5)
-                mux = lts.cells[(i - 1) << 4 | BEL_F8MUX];
+                mux = &lts.muxes[1][i - 1];
 
-            if (mux != nullptr) {
-                if (x_net == nullptr)
-                    x_net = mux->muxInfo.sel;
-                else if (x_net != mux->muxInfo.sel) {
-                    DBG();
-                    return false; // Memory and SRLs only valid in SLICEMs
-                }
+            if (mux != nullptr && mux->cell != -1 && !use_input(x_net, mux->sel)) {
+                DBG();
+                return false;
             }
+            int32_t out_fmux_cell = (mux != nullptr) ? mux->cell : -1;
 
-            CellInfo *out_fmux = nullptr;
-            // Subslices A, C: F7MUX connects to F7F8 out
-            if (i == 0 || i == 2 || i == 4 || i == 6)
-                out_fmux = lts.cells[(i << 4) | BEL_F7MUX];
-            // Subslices B: F8MUX connects to F7F8 out
-            if (i == 1 || i == 5)
-                out_fmux = lts.cells[(i - 1) << 4 | BEL_F8MUX];
-
-            CellInfo *carry4 = lts.cells[((i / 4) << 6) | BEL_CARRY4];
-
-            if (carry4 != nullptr && carry4->carryInfo.x_sigs[i % 4] != nullptr) {
-                if (x_net == nullptr)
-                    x_net = carry4->carryInfo.x_sigs[i % 4];
-                else if (x_net != carry4->carryInfo.x_sigs[i % 4]) {
-                    DBG();
-                    return false;
-                }
+            const auto &carry4 = lts.carries[i / 4];
+            if (carry4.x[i % 4] != -1 && !use_input(x_net, carry4.x[i % 4])) {
+                DBG();
+                return false;
             }
 
             // FF1 might use X, if it isn't driven directly
-            CellInfo *ff1 = lts.cells[i << 4 | BEL_FF];
-            if (ff1 != nullptr && ff1->ffInfo.d != nullptr && ff1->ffInfo.d->driver.cell != nullptr) {
-                auto &drv = ff1->ffInfo.d->driver;
-                if ((drv.cell == lut6 && drv.port != id_MC31) || drv.cell == lut5 || drv.cell == out_fmux) {
+            const auto &ff1 = lts.ffs[i << 1];
+            if (ff1.d_driver != -1) {
+                if ((ff1.d_driver == lut6.cell && !ff1.d_from_mc31) || ff1.d_driver == lut5.cell ||
+                    ff1.d_driver == out_fmux_cell) {
                     // Direct, OK
-                } else {
+                } else if (!use_input(x_net, ff1.d)) {
                     // Indirect, must use X input
-                    if (x_net == nullptr)
-                        x_net = ff1->ffInfo.d;
-                    else if (x_net != ff1->ffInfo.d) {
-                        DBG();
-                        return false;
-                    }
+                    DBG();
+                    return false;
                 }
             }
 
             // FF2 might use X, if it isn't driven directly
-            CellInfo *ff2 = lts.cells[i << 4 | BEL_FF2];
-            if (ff2 != nullptr && ff2->ffInfo.d != nullptr && ff2->ffInfo.d->driver.cell != nullptr) {
-                auto &drv = ff2->ffInfo.d->driver;
-                if (drv.cell == lut5) {
+            const auto &ff2 = lts.ffs[(i << 1) | 1];
+            if (ff2.d_driver != -1) {
+                if (ff2.d_driver == lut5.cell) {
                     // Direct, OK
-                } else {
+                } else if (!use_input(x_net, ff2.d)) {
                     // Indirect, must use X input
-                    if (x_net == nullptr)
-                        x_net = ff2->ffInfo.d;
-                    else if (x_net != ff2->ffInfo.d) {
-#ifdef DEBUG_VALIDITY
-                        log_info("%s %s %s %s %s\n", nameOf(lut6), nameOf(ff1), nameOf(lut5), nameOf(ff2),
-                                 nameOf(drv.cell));
-#endif
-                        DBG();
-                        return false;
-                    }
+                    DBG();
+                    return false;
                 }
             }
 
             // collision with top address bits
             if (tile_is_memory && !small_memory) {
-                CellInfo *top_lut = lts.cells[(3 << 4) | BEL_6LUT];
-                if (top_lut != nullptr) {
-                    if ((i == 2) && x_net != top_lut->lutInfo.address_msb[0]) {
-                        DBG();
-                        return false;
-                    }
-                    if ((i == 1) && x_net != top_lut->lutInfo.address_msb[1]) {
-                        DBG();
-                        return false;
-                    }
+                if ((i == 2) && x_net != top_lut.address_msb[0]) {
+                    DBG();
+                    return false;
+                }
+                if ((i == 1) && x_net != top_lut.address_msb[1]) {
+                    DBG();
+                    return false;
                 }
             }
 
             bool mux_output_used = false;
-            NetInfo *out5 = nullptr;
-            if (lut6 != nullptr && lut6->lutInfo.output_count == 2)
-                out5 = lut6->lutInfo.output_sigs[1];
-            else if (lut5 != nullptr && !lut5->lutInfo.only_drives_carry)
-                out5 = lut5->lutInfo.output_sigs[0];
-            if (out5 != nullptr && (out5->users.size() > 1 || ((ff1 == nullptr || out5 != ff1->ffInfo.d) &&
-                                                               (ff2 == nullptr || out5 != ff2->ffInfo.d)))) {
-                mux_output_used = true;
+            int32_t out5 = -1;
+            bool out5_shared = false;
+            if (lut6.output_count == 2) {
+                out5 = lut6.outputs[1];
+                out5_shared = lut6.output_shared[1];
+            } else if (lut5.cell != -1 && !lut5.only_drives_carry) {
+                out5 = lut5.outputs[0];
+                out5_shared = lut5.output_shared[0];
             }
+            if (out5 != -1 && (out5_shared || (out5 != ff1.d && out5 != ff2.d)))
+                mux_output_used = true;
 
-            if (carry4 != nullptr && carry4->carryInfo.out_sigs[i % 4] != nullptr) {
+            if (carry4.out[i % 4] != -1) {
                 // FIXME: direct connections to FF
                 if (mux_output_used) {
                     DBG();
-                    return false; // Memory and SRLs only valid in SLICEMs
+                    return false;
                 }
                 mux_output_used = true;
             }
-            if (out_fmux != nullptr) {
-                NetInfo *f7f8 = out_fmux->muxInfo.out;
-                if (f7f8 != nullptr && (f7f8->users.size() > 1 || ((ff1 == nullptr || f7f8 != ff1->ffInfo.d)))) {
-                    if (mux_output_used) {
-                        DBG();
-                        return false; // Memory and SRLs only valid in SLICEMs
-                    }
-                    mux_output_used = true;
+            if (mux != nullptr && mux->out != -1 && (mux->out_shared || mux->out != ff1.d)) {
+                if (mux_output_used) {
+                    DBG();
+                    return false;
                 }
+                mux_output_used = true;
             }
-            if (ff2 != nullptr) {
+            if (ff2.cell != -1) {
                 if (mux_output_used) {
                     DBG();
-                    return false; // Memory and SRLs only valid in SLICEMs
+                    return false;
                 }
                 mux_output_used = true;
             }
@@ -520,60 +524,39 @@ bool Arch::xc7_logic_tile_valid(IdString tileType, LogicTileStatus &lts) const
     // Check half-tiles
     for (int i = 0; i < 2; i++) {
         if (lts.halfs[i].dirty) {
+            lts.halfs[i].dirty = false;
             lts.halfs[i].valid = false;
-            bool found_ff[2] = {false, false};
-            if (i == 0 && wclk == nullptr) {
+            if (i == 0 && wclk == -1) {
                 // Need to check wclk too
-                for (int z = 4 * i; z < 4 * (i + 1); z++) {
+                for (int z = 0; z < 4; z++) {
                     for (int k = 0; k < 2; k++) {
-                        CellInfo *lut = lts.cells[z << 4 | (BEL_6LUT + k)];
-                        if (lut == nullptr)
-                            continue;
-                        if (!lut->lutInfo.is_memory && !lut->lutInfo.is_srl)
-                            continue;
-                        if (lut->lutInfo.wclk != nullptr) {
-                            wclk = lut->lutInfo.wclk;
+                        const auto &lut = lts.luts[(z << 1) | k];
+                        if (lut.cell != -1 && (lut.is_memory || lut.is_srl) && lut.wclk != -1) {
+                            wclk = lut.wclk;
                             break;
                         }
                     }
                 }
             }
-            NetInfo *clk = nullptr, *sr = nullptr, *ce = nullptr;
-            bool clkinv = false, srinv = false, islatch = false, ffsync = false;
+            bool found_ff = false;
+            int32_t ctrl_set = -1;
             for (int z = 4 * i; z < 4 * (i + 1); z++) {
                 for (int k = 0; k < 2; k++) {
-                    CellInfo *ff = lts.cells[z << 4 | (BEL_FF + k)];
-                    if (ff == nullptr)
+                    const auto &ff = lts.ffs[(z << 1) | k];
+                    if (ff.cell == -1)
                         continue;
-                    if (ff->ffInfo.is_latch && k == 1)
+                    if (ff.is_latch && k == 1)
                         return false;
-                    if (found_ff[0] || found_ff[1]) {
-                        if (ff->ffInfo.clk != clk)
-                            return false;
-                        if (ff->ffInfo.sr != sr)
-                            return false;
-                        if (ff->ffInfo.ce != ce)
-                            return false;
-                        if (ff->ffInfo.is_clkinv != clkinv)
-                            return false;
-                        if (ff->ffInfo.is_srinv != srinv)
-                            return false;
-                        if (ff->ffInfo.is_latch != islatch)
-                            return false;
-                        if (ff->ffInfo.ffsync != ffsync)
+                    // Clock, SR, CE, inversion, latch and sync modes are shared by the half
+                    if (found_ff) {
+                        if (ff.ctrl_set != ctrl_set)
                             return false;
                     } else {
-                        clk = ff->ffInfo.clk;
-                        if (i == 0 && wclk != nullptr && clk != wclk)
+                        if (i == 0 && wclk != -1 && ff.clk != wclk)
                             return false;
-                        sr = ff->ffInfo.sr;
-                        ce = ff->ffInfo.ce;
-                        clkinv = ff->ffInfo.is_clkinv;
-                        srinv = ff->ffInfo.is_srinv;
-                        islatch = ff->ffInfo.is_latch;
-                        ffsync = ff->ffInfo.ffsync;
+                        ctrl_set = ff.ctrl_set;
                     }
-                    found_ff[k] = true;
+                    found_ff = true;
                 }
             }
             lts.halfs[i].valid = true;
@@ -180,6 +180,8 @@ struct ArchCellInfo
             bool is_latch, is_clkinv, is_srinv, ffsync;
             bool is_paired;
             NetInfo *clk, *sr, *ce, *d;
+            // Small integer ID of the nets and settings that must match between flipflops in the same half tile
+            int ctrl_set;
         } ffInfo;
         struct
         {
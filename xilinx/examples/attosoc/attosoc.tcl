@@ -1,2 +0,0 @@
-open_checkpoint attosoc.dcp
-write_verilog -force attosoc_out.v
@@ -85,6 +85,16 @@ struct FasmBackend
         out << std::endl;
     }
 
+    // Write a vector stored as words of 64 bits, least significant word first
+    void write_words(const std::string &name, const uint64_t *words, int width)
+    {
+        write_prefix();
+        out << name << " = " << width << "'b";
+        for (int i = width - 1; i >= 0; i--)
+            out << (((words[i / 64] >> (i % 64)) & 1) ? '1' : '0');
+        out << std::endl;
+    }
+
     void write_int_vector(const std::string &name, uint64_t value, int width, bool invert = false)
     {
         std::vector<bool> bits(width, false);
@@ -435,7 +445,7 @@ struct FasmBackend
                     for (auto &p2l : phys_to_log[k])
                         log_index |= (1 << log_to_bit[p2l]);
                 }
-                bits[j] = (init.str.at(log_index) == Property::S1);
+                bits[j] = (init.get_bit(log_index) == Property::S1);
             }
         }
         return bits;
@@ -1414,17 +1424,20 @@ struct FasmBackend
         for (std::string mode : {"", "P"}) {
             for (int i = 0; i < (mode == "P" ? 8 : 64); i++) {
                 bool has_init = false;
-                std::vector<bool> init_data(256, false);
+                uint64_t init_data[4] = {0, 0, 0, 0};
                 if (is_36) {
+                    // Each RAMB18 half of a RAMB36 takes every other bit of a pair of INIT values
                     for (int j = 0; j < 2; j++) {
                         IdString param = ctx->id(stringf("INIT%s_%02X", mode.c_str(), i * 2 + j));
                         if (ci->params.count(param)) {
                             auto &init0 = ci->params.at(param);
                             has_init = true;
-                            for (int k = half; k < 256; k += 2) {
-                                if (k >= int(init0.str.size()))
-                                    break;
-                                init_data[j * 128 + (k / 2)] = init0.str[k] == Property::S1;
+                            for (int w = 0; w < std::min(4, init0.num_words()); w++) {
+                                uint64_t v = init0.value_word(w) & ~init0.undef_word(w);
+                                uint64_t half_bits = 0;
+                                for (int k = 0; k < 32; k++)
+                                    half_bits |= ((v >> (2 * k + half)) & 1) << k;
+                                init_data[2 * j + w / 2] |= half_bits << (32 * (w % 2));
                             }
                         }
                     }
@@ -1433,15 +1446,12 @@ struct FasmBackend
                     if (ci->params.count(param)) {
                         auto &init = ci->params.at(param);
                         has_init = true;
-                        for (int k = 0; k < 256; k++) {
-                            if (k >= int(init.str.size()))
-                                break;
-                            init_data[k] = init.str[k] == Property::S1;
-                        }
+                        for (int w = 0; w < std::min(4, init.num_words()); w++)
+                            init_data[w] = init.value_word(w) & ~init.undef_word(w);
                     }
                 }
                 if (has_init)
-                    write_vector(stringf("INIT%s_%02X[255:0]", mode.c_str(), i), init_data);
+                    write_words(stringf("INIT%s_%02X[255:0]", mode.c_str(), i), init_data, 256);
             }
         }
     }
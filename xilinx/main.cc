@@ -50,6 +50,9 @@ po::options_description UspCommandHandler::getArchOptions()
     specific.add_options()("chipdb", po::value<std::string>(), "name of chip database binary");
     specific.add_options()("xdc", po::value<std::vector<std::string>>(), "XDC-style constraints file");
     specific.add_options()("fasm", po::value<std::string>(), "fasm bitstream file to write");
+    specific.add_options()("no-lut-opt", "disable constant propagation and LUT merging before packing");
+    specific.add_options()("power-report", po::value<std::string>(), "write an estimate of dynamic power to file");
+    specific.add_options()("power-driven", "weight nets by estimated switching power during analytic placement");
 
     return specific;
 }
@@ -60,6 +63,8 @@ void UspCommandHandler::customBitstream(Context *ctx)
         std::string filename = vm["fasm"].as<std::string>();
         ctx->writeFasm(filename);
     }
+    if (vm.count("power-report"))
+        ctx->writePowerReport(vm["power-report"].as<std::string>());
 }
 
 std::unique_ptr<Context> UspCommandHandler::createContext(std::unordered_map<std::string, Property> &values)
@@ -74,6 +79,10 @@ std::unique_ptr<Context> UspCommandHandler::createContext(std::unordered_map<std
 
 void UspCommandHandler::customAfterLoad(Context *ctx)
 {
+    if (vm.count("no-lut-opt"))
+        ctx->settings[ctx->id("xilinx/noLutOpt")] = true;
+    if (vm.count("power-driven"))
+        ctx->settings[ctx->id("xilinx/powerDriven")] = true;
     if (vm.count("xdc")) {
         std::vector<std::string> files = vm["xdc"].as<std::vector<std::string>>();
         for (const auto &filename : files) {
@@ -19,6 +19,7 @@
 
 #include "pack.h"
 #include <algorithm>
+#include <boost/algorithm/string/join.hpp>
 #include <boost/optional.hpp>
 #include <iterator>
 #include <queue>
@@ -49,10 +50,30 @@ void XilinxPacker::flush_cells()
     new_cells.clear();
 }
 
+IdString XilinxPacker::stripped_port_name(IdString port)
+{
+    auto found = stripped_port_names.find(port);
+    if (found != stripped_port_names.end())
+        return found->second;
+    std::string stripped_name;
+    for (auto c : port.str(ctx))
+        if (c != '[' && c != ']')
+            stripped_name += c;
+    return stripped_port_names[port] = ctx->id(stripped_name);
+}
+
+IdString XilinxPacker::orig_port_attr(IdString port)
+{
+    auto found = orig_port_attrs.find(port);
+    if (found != orig_port_attrs.end())
+        return found->second;
+    return orig_port_attrs[port] = ctx->id("X_ORIG_PORT_" + port.str(ctx));
+}
+
 void XilinxPacker::xform_cell(const std::unordered_map<IdString, XFormRule> &rules, CellInfo *ci)
 {
     auto &rule = rules.at(ci->type);
-    ci->attrs[ctx->id("X_ORIG_TYPE")] = ci->type.str(ctx);
+    ci->attrs[id_X_ORIG_TYPE] = ci->type.str(ctx);
     ci->type = rule.new_type;
     std::vector<IdString> orig_port_names;
     for (auto &port : ci->ports)
@@ -67,32 +88,33 @@ void XilinxPacker::xform_cell(const std::unordered_map<IdString, XFormRule> &rul
                 ci->ports[new_name].name = new_name;
                 ci->ports[new_name].type = old_port.type;
                 connect_port(ctx, old_port.net, ci, new_name);
-                ci->attrs[ctx->id("X_ORIG_PORT_" + new_name.str(ctx))] = pname.str(ctx);
+                ci->attrs[orig_port_attr(new_name)] = pname.str(ctx);
             }
         } else {
-            IdString new_name;
-            if (rule.port_xform.count(pname)) {
-                new_name = rule.port_xform.at(pname);
-            } else {
-                std::string stripped_name;
-                for (auto c : pname.str(ctx))
-                    if (c != '[' && c != ']')
-                        stripped_name += c;
-                new_name = ctx->id(stripped_name);
-            }
+            auto xform = rule.port_xform.find(pname);
+            IdString new_name = (xform != rule.port_xform.end()) ? xform->second : stripped_port_name(pname);
             if (new_name != pname) {
                 rename_port(ctx, ci, pname, new_name);
             }
-            ci->attrs[ctx->id("X_ORIG_PORT_" + new_name.str(ctx))] = pname.str(ctx);
+            ci->attrs[orig_port_attr(new_name)] = pname.str(ctx);
         }
     }
 
+    // Record the parameters of the original primitive and the new names of any that are renamed, so the logical
+    // netlist can be written back out without those added by packing
+    std::vector<std::string> orig_params;
     std::vector<IdString> xform_params;
-    for (auto &param : ci->params)
+    for (auto &param : ci->params) {
+        orig_params.push_back(param.first.str(ctx));
         if (rule.param_xform.count(param.first))
             xform_params.push_back(param.first);
-    for (auto param : xform_params)
+    }
+    std::sort(orig_params.begin(), orig_params.end());
+    ci->attrs[ctx->id("X_ORIG_PARAMS")] = boost::algorithm::join(orig_params, " ");
+    for (auto param : xform_params) {
         ci->params[rule.param_xform.at(param)] = ci->params[param];
+        ci->attrs[ctx->id("X_ORIG_PARAM_" + rule.param_xform.at(param).str(ctx))] = param.str(ctx);
+    }
 
     for (auto &attr : rule.set_attrs)
         ci->attrs[attr.first] = attr.second;
@@ -105,13 +127,10 @@ void XilinxPacker::generic_xform(const std::unordered_map<IdString, XFormRule> &
 {
     std::map<std::string, int> cell_count;
     std::map<std::string, int> new_types;
-    for (auto cell : sorted(ctx->cells)) {
-        CellInfo *ci = cell.second;
-        if (rules.count(ci->type)) {
-            cell_count[ci->type.str(ctx)]++;
-            xform_cell(rules, ci);
-            new_types[ci->type.str(ctx)]++;
-        }
+    for (auto ci : cells_of_type(rules)) {
+        cell_count[ci->type.str(ctx)]++;
+        xform_cell(rules, ci);
+        new_types[ci->type.str(ctx)]++;
     }
     if (print_summary) {
         for (auto &nt : new_types) {
@@ -201,22 +220,26 @@ void XilinxPacker::pack_ffs()
     std::unordered_map<IdString, XFormRule> ff_rules;
     ff_rules[ctx->id("FDCE")].new_type = id_SLICE_FFX;
     ff_rules[ctx->id("FDCE")].port_xform[ctx->id("C")] = ctx->xc7 ? id_CK : id_CLK;
+    ff_rules[ctx->id("FDCE")].param_xform[ctx->id("IS_C_INVERTED")] = ctx->id("IS_CLK_INVERTED");
     ff_rules[ctx->id("FDCE")].port_xform[ctx->id("CLR")] = id_SR;
     // ff_rules[ctx->id("FDCE")].param_xform[ctx->id("IS_CLR_INVERTED")] = ctx->id("IS_SR_INVERTED");
 
     ff_rules[ctx->id("FDPE")].new_type = id_SLICE_FFX;
     ff_rules[ctx->id("FDPE")].port_xform[ctx->id("C")] = ctx->xc7 ? id_CK : id_CLK;
+    ff_rules[ctx->id("FDPE")].param_xform[ctx->id("IS_C_INVERTED")] = ctx->id("IS_CLK_INVERTED");
     ff_rules[ctx->id("FDPE")].port_xform[ctx->id("PRE")] = id_SR;
     // ff_rules[ctx->id("FDPE")].param_xform[ctx->id("IS_PRE_INVERTED")] = ctx->id("IS_SR_INVERTED");
 
     ff_rules[ctx->id("FDRE")].new_type = id_SLICE_FFX;
     ff_rules[ctx->id("FDRE")].port_xform[ctx->id("C")] = ctx->xc7 ? id_CK : id_CLK;
+    ff_rules[ctx->id("FDRE")].param_xform[ctx->id("IS_C_INVERTED")] = ctx->id("IS_CLK_INVERTED");
     ff_rules[ctx->id("FDRE")].port_xform[ctx->id("R")] = id_SR;
     ff_rules[ctx->id("FDRE")].set_attrs.emplace_back(ctx->id("X_FFSYNC"), "1");
     // ff_rules[ctx->id("FDRE")].param_xform[ctx->id("IS_R_INVERTED")] = ctx->id("IS_SR_INVERTED");
 
     ff_rules[ctx->id("FDSE")].new_type = id_SLICE_FFX;
     ff_rules[ctx->id("FDSE")].port_xform[ctx->id("C")] = ctx->xc7 ? id_CK : id_CLK;
+    ff_rules[ctx->id("FDSE")].param_xform[ctx->id("IS_C_INVERTED")] = ctx->id("IS_CLK_INVERTED");
     ff_rules[ctx->id("FDSE")].port_xform[ctx->id("S")] = id_SR;
     ff_rules[ctx->id("FDSE")].set_attrs.emplace_back(ctx->id("X_FFSYNC"), "1");
     // ff_rules[ctx->id("FDSE")].param_xform[ctx->id("IS_S_INVERTED")] = ctx->id("IS_SR_INVERTED");
@@ -239,14 +262,12 @@ void XilinxPacker::pack_ffs()
 void XilinxPacker::pack_lutffs()
 {
     int pairs = 0;
-    for (auto cell : sorted(ctx->cells)) {
-        CellInfo *ci = cell.second;
+    for (auto ci : cells_of_type(std::unordered_set<IdString>{id_SLICE_FFX})) {
         if (ci->constr_parent != nullptr || !ci->constr_children.empty())
             continue;
-        if (ci->type != id_SLICE_FFX)
-            continue;
         NetInfo *d = get_net_or_empty(ci, id_D);
-        if (d->driver.cell == nullptr || d->driver.cell->type != id_SLICE_LUTX || d->driver.port != id_O6)
+        if (d == nullptr || d->driver.cell == nullptr || d->driver.cell->type != id_SLICE_LUTX ||
+            d->driver.port != id_O6)
             continue;
         CellInfo *lut = d->driver.cell;
         if (lut->constr_parent != nullptr || !lut->constr_children.empty())
@@ -901,7 +922,7 @@ void USPacker::pack_uram()
 
 void XilinxPacker::pack_inverters()
 {
-    // FIXME: fold where possible
+    // Inverters that can be folded into pins with programmable inversion are removed later by optimise_luts
     for (auto cell : sorted(ctx->cells)) {
         CellInfo *ci = cell.second;
         if (ci->type == ctx->id("INV")) {
@@ -919,6 +940,7 @@ bool Arch::pack()
         packer.ctx = getCtx();
         packer.pack_constants();
         packer.pack_inverters();
+        packer.optimise_luts();
         packer.pack_io();
         // packer.prepare_iologic();
         packer.prepare_clocking();
@@ -939,11 +961,13 @@ bool Arch::pack()
         packer.pack_ffs();
         packer.finalise_muxfs();
         packer.pack_lutffs();
+        packer.validate_params();
     } else {
         USPacker packer;
         packer.ctx = getCtx();
         packer.pack_constants();
         packer.pack_inverters();
+        packer.optimise_luts();
         packer.pack_io();
         packer.prepare_iologic();
         packer.prepare_clocking();
@@ -961,6 +985,7 @@ bool Arch::pack()
         packer.pack_ffs();
         packer.finalise_muxfs();
         packer.pack_lutffs();
+        packer.validate_params();
     }
 
     assignArchInfo();
@@ -1021,6 +1046,14 @@ void Arch::assignCellInfo(CellInfo *cell)
                                 bool_or_default(cell->params, id("IS_PRE_INVERTED"), false);
         cell->ffInfo.is_latch = cell->attrs.count(id("X_FF_AS_LATCH"));
         cell->ffInfo.ffsync = cell->attrs.count(id("X_FFSYNC"));
+        // UltraScale flipflops only share CE with the others at the same position in the half, and don't need to
+        // agree on sync/async; so those are checked separately there
+        std::vector<int32_t> ctrl_set{cell->ffInfo.clk ? cell->ffInfo.clk->name.index : -1,
+                                      cell->ffInfo.sr ? cell->ffInfo.sr->name.index : -1,
+                                      (xc7 && cell->ffInfo.ce) ? cell->ffInfo.ce->name.index : -1,
+                                      (cell->ffInfo.is_clkinv ? 1 : 0) | (cell->ffInfo.is_srinv ? 2 : 0) |
+                                              (cell->ffInfo.is_latch ? 4 : 0) | ((xc7 && cell->ffInfo.ffsync) ? 8 : 0)};
+        cell->ffInfo.ctrl_set = ff_control_sets.emplace(ctrl_set, int(ff_control_sets.size())).first->second;
     } else if (cell->type == id_F7MUX || cell->type == id_F8MUX || cell->type == id_F9MUX ||
                cell->type == id("SELMUX2_1")) {
         cell->muxInfo.sel = get_net_or_empty(cell, id_S0);
@@ -1039,6 +1072,9 @@ void Arch::assignCellInfo(CellInfo *cell)
         }
         cell->carryInfo.x_sigs[0] = get_net_or_empty(cell, id("CYINIT"));
     }
+    // Cells bound before their info was assigned (e.g. when loading a placed design) need their tile state refreshing
+    if (cell->bel != BelId() && isLogicTile(cell->bel))
+        updateLogicBel(cell->bel, cell);
 }
 
 void Arch::assignArchInfo()
@@ -105,6 +105,20 @@ struct XilinxPacker
 
     void xform_cell(const std::unordered_map<IdString, XFormRule> &rules, CellInfo *ci);
     void generic_xform(const std::unordered_map<IdString, XFormRule> &rules, bool print_summary = false);
+    // Cells with one of the given types, in name order, found in a single pass over the netlist
+    template <typename TypeSet> std::vector<CellInfo *> cells_of_type(const TypeSet &types)
+    {
+        std::vector<CellInfo *> found;
+        for (auto &cell : ctx->cells)
+            if (types.count(cell.second->type))
+                found.push_back(cell.second.get());
+        std::sort(found.begin(), found.end(), [](const CellInfo *a, const CellInfo *b) { return a->name < b->name; });
+        return found;
+    }
+    // Names interned by xform_cell for every port of every cell, cached across passes
+    std::unordered_map<IdString, IdString> stripped_port_names, orig_port_attrs;
+    IdString stripped_port_name(IdString port);
+    IdString orig_port_attr(IdString port);
 
     std::unique_ptr<CellInfo> feed_through_lut(NetInfo *net, const std::vector<PortRef> &feed_users);
     std::unique_ptr<CellInfo> feed_through_muxf(NetInfo *net, IdString type, const std::vector<PortRef> &feed_users);
@@ -117,6 +131,12 @@ struct XilinxPacker
 
     // LUTs & FFs
     void pack_inverters();
+    // Pre-pack constant propagation, buffer and inverter removal, and merging of small LUT cascades
+    void optimise_luts();
+    bool optimise_lut(CellInfo *ci, const std::vector<NetInfo *> &inputs, uint64_t tt);
+    int lut_opt_width(const CellInfo *ci);
+    bool lut_opt_fixed(const CellInfo *ci);
+    bool lut_opt_fixed(const NetInfo *ni);
     void pack_luts();
     void pack_ffs();
     void pack_lutffs();
@@ -132,6 +152,14 @@ struct XilinxPacker
     void pack_srls();
 
     void split_carry4s();
+    // Find cascades of CARRY4s or CARRY8s connected through CO[width-1] -> CI that are regular enough to map straight
+    // onto chained bels
+    std::vector<std::vector<CellInfo *>> find_direct_carry_chains(IdString type, int width);
+    // Make the LUTs driving S[z] and DI[z] of a packed carry legal and constrain them to the carry's tile
+    void legalise_carry_luts(CellInfo *carry, CellInfo *root, int z, int dy);
+    // Split carry chains longer than a column or clock region into segments bridged through fabric, cutting where
+    // the fewest long paths cross. break_period is the number of carries after which the chain skips a row
+    void split_carry_chains(IdString type, int width, int break_period, int region_length);
 
     // DistRAM
     std::unordered_map<IdString, XFormRule> dram_rules, dram32_6_rules, dram32_5_rules;
@@ -153,6 +181,11 @@ struct XilinxPacker
     CellInfo *insert_outinv(IdString name, NetInfo *i, NetInfo *o);
     std::pair<CellInfo *, PortRef> insert_pad_and_buf(CellInfo *npnr_io);
     CellInfo *create_iobuf(CellInfo *npnr_io, IdString &top_port);
+    // Choose sites for IOs without a location constraint, keeping bank voltages compatible, differential pairs on
+    // pairs of sites and clock inputs on clock capable pins, and placing IOs near the logic they connect to
+    void plan_io(const std::vector<std::pair<CellInfo *, PortRef>> &pad_and_buf,
+                 const std::unordered_set<BelId> &used_io_bels);
+    bool io_drives_clock(const PortRef &buf);
 
     // Clocking
     std::unordered_set<BelId> used_bels;
@@ -160,6 +193,10 @@ struct XilinxPacker
     void try_preplace(CellInfo *cell, IdString port);
     void preplace_unique(CellInfo *cell);
 
+    // Check the parameters of the packed cells against the schemas of their original primitives, reporting every
+    // violation before failing
+    void validate_params();
+
     int autoidx = 0;
 };
 
@@ -167,6 +204,7 @@ struct USPacker : public XilinxPacker
 {
     // Carries
     bool has_illegal_fanout(NetInfo *carry);
+    int pack_carry8_chains();
     void pack_carries();
 
     // IO
@@ -207,6 +245,7 @@ struct XC7Packer : public XilinxPacker
 {
     // Carries
     bool has_illegal_fanout(NetInfo *carry);
+    int pack_carry4_chains();
     void pack_carries();
 
     // IO
@@ -0,0 +1,262 @@
+/*
+ *  nextpnr -- Next Generation Place and Route
+ *
+ *  Copyright (C) 2026  agent <agent@local>
+ *
+ *  Permission to use, copy, modify, and/or distribute this software for any
+ *  purpose with or without fee is hereby granted, provided that the above
+ *  copyright notice and this permission notice appear in all copies.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ *  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ *  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ *  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ *  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ *  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ *  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ */
+
+#include <algorithm>
+#include <limits>
+#include <queue>
+#include "cells.h"
+#include "design_utils.h"
+#include "log.h"
+#include "nextpnr.h"
+#include "pack.h"
+#include "util.h"
+
+NEXTPNR_NAMESPACE_BEGIN
+
+namespace {
+// Delay of the combinational cells seen before packing, in arbitrary units; or -1 for cells that start and end paths
+int comb_delay(const Context *ctx, const CellInfo *ci)
+{
+    const std::string &type = ci->type.str(ctx);
+    if (type == "CARRY4" || type == "CARRY8")
+        return 1;
+    if (type.size() == 4 && type.compare(0, 3, "LUT") == 0)
+        return 10;
+    if (type == "MUXF7" || type == "MUXF8" || type == "MUXF9" || type == "F7MUX" || type == "F8MUX" ||
+        type == "F9MUX" || type == "SELMUX2_1")
+        return 2;
+    return -1;
+}
+
+// The STA can't time cells that are neither packed nor placed, so estimate the longest path through each cell with a
+// levelised analysis of the netlist instead. Returns, for each combinational cell, the longest path arriving at its
+// outputs and the longest path starting at its inputs
+void levelise_paths(Context *ctx, std::unordered_map<IdString, int> &arrival, std::unordered_map<IdString, int> &tail)
+{
+    std::unordered_map<IdString, int> pending;
+    std::queue<CellInfo *> ready;
+    std::vector<CellInfo *> order;
+    for (auto cell : sorted(ctx->cells)) {
+        CellInfo *ci = cell.second;
+        if (comb_delay(ctx, ci) == -1)
+            continue;
+        int count = 0;
+        for (auto &port : ci->ports)
+            if (port.second.type == PORT_IN && port.second.net != nullptr &&
+                port.second.net->driver.cell != nullptr && comb_delay(ctx, port.second.net->driver.cell) != -1)
+                ++count;
+        pending[ci->name] = count;
+        if (count == 0)
+            ready.push(ci);
+    }
+    while (!ready.empty()) {
+        CellInfo *ci = ready.front();
+        ready.pop();
+        order.push_back(ci);
+        for (auto &port : ci->ports) {
+            if (port.second.type != PORT_OUT || port.second.net == nullptr)
+                continue;
+            for (auto &usr : port.second.net->users)
+                if (comb_delay(ctx, usr.cell) != -1 && --pending.at(usr.cell->name) == 0)
+                    ready.push(usr.cell);
+        }
+    }
+    // Cells on combinational loops never become ready, and are left out of the analysis
+    for (auto ci : order) {
+        int in_arrival = 0;
+        for (auto &port : ci->ports) {
+            NetInfo *ni = port.second.net;
+            if (port.second.type == PORT_IN && ni != nullptr && ni->driver.cell != nullptr &&
+                arrival.count(ni->driver.cell->name))
+                in_arrival = std::max(in_arrival, arrival.at(ni->driver.cell->name));
+        }
+        arrival[ci->name] = in_arrival + comb_delay(ctx, ci);
+    }
+    for (auto it = order.rbegin(); it != order.rend(); ++it) {
+        CellInfo *ci = *it;
+        int out_tail = 0;
+        for (auto &port : ci->ports) {
+            if (port.second.type != PORT_OUT || port.second.net == nullptr)
+                continue;
+            for (auto &usr : port.second.net->users)
+                if (tail.count(usr.cell->name))
+                    out_tail = std::max(out_tail, tail.at(usr.cell->name));
+        }
+        tail[ci->name] = out_tail + comb_delay(ctx, ci);
+    }
+}
+} // namespace
+
+void XilinxPacker::split_carry_chains(IdString type, int width, int break_period, int region_length)
+{
+    IdString co_top = ctx->id("CO[" + std::to_string(width - 1) + "]");
+    int bel_z = (type == ctx->id("CARRY4")) ? BEL_CARRY4 : BEL_CARRY8;
+    auto dy = [&](int n) { return n + (break_period > 0 ? n / break_period : 0); };
+
+    // The longest chain that can be placed is limited by the tallest column of carries, and by the clock region
+    // (xc7: HCLK row) breaks where carries can't continue in the next tile
+    std::unordered_map<int, int> column_height;
+    for (auto bel : ctx->getBels()) {
+        Loc loc = ctx->getBelLocation(bel);
+        if (loc.z == bel_z)
+            ++column_height[loc.x];
+    }
+    int max_column = 0;
+    for (auto &col : column_height)
+        max_column = std::max(max_column, col.second);
+    int max_length = ctx->setting<int>("xilinx/maxCarryLength", std::min(max_column, region_length));
+    if (max_length < 2)
+        return;
+
+    std::vector<CellInfo *> roots;
+    for (auto cell : sorted(ctx->cells)) {
+        CellInfo *ci = cell.second;
+        if (ci->type == type && ci->constr_parent == nullptr && !ci->constr_children.empty())
+            roots.push_back(ci);
+    }
+
+    std::unordered_map<IdString, int> arrival, tail;
+    bool analysed = false;
+    NetInfo *vcc = ctx->nets.at(ctx->id("$PACKER_VCC_NET")).get();
+    int split_chains = 0, segment_count = 0;
+
+    for (auto root : roots) {
+        std::vector<CellInfo *> chain{root}, luts;
+        for (auto child : root->constr_children)
+            (child->type == type ? chain : luts).push_back(child);
+        int length = int(chain.size());
+        if (length <= max_length)
+            continue;
+        std::stable_sort(chain.begin() + 1, chain.end(),
+                         [](const CellInfo *a, const CellInfo *b) { return a->constr_y > b->constr_y; });
+        if (!analysed) {
+            levelise_paths(ctx, arrival, tail);
+            analysed = true;
+        }
+        // The cost of cutting before carry k is the longest path through the carry between k - 1 and k, as the
+        // bridge through fabric adds to it
+        auto cut_cost = [&](int k) {
+            int a = arrival.count(chain.at(k - 1)->name) ? arrival.at(chain.at(k - 1)->name) : 0;
+            int t = tail.count(chain.at(k)->name) ? tail.at(chain.at(k)->name) : 0;
+            return a + t;
+        };
+        // Find the fewest segments, and then the least critical worst cut. Segments other than the last need one
+        // extra carry for the bridge
+        std::vector<std::pair<int, int>> best(length, std::make_pair(std::numeric_limits<int>::max(), 0));
+        std::vector<int> prev(length, -1);
+        best.at(0) = std::make_pair(0, 0);
+        for (int k = 1; k < length; k++) {
+            int cost = cut_cost(k);
+            for (int j = std::max(0, k - (max_length - 1)); j < k; j++) {
+                if (best.at(j).first == std::numeric_limits<int>::max())
+                    continue;
+                auto cand = std::make_pair(best.at(j).first + 1, std::max(best.at(j).second, cost));
+                if (cand < best.at(k)) {
+                    best.at(k) = cand;
+                    prev.at(k) = j;
+                }
+            }
+        }
+        int last = -1;
+        std::pair<int, int> last_cost(std::numeric_limits<int>::max(), 0);
+        for (int j = std::max(0, length - max_length); j < length; j++)
+            if (best.at(j).first != std::numeric_limits<int>::max() && best.at(j) < last_cost) {
+                last_cost = best.at(j);
+                last = j;
+            }
+        NPNR_ASSERT(last > 0);
+        std::vector<int> starts;
+        for (int k = last; k != -1; k = prev.at(k))
+            starts.push_back(k);
+        std::reverse(starts.begin(), starts.end());
+        starts.push_back(length);
+
+        // LUTs follow the carry that they are constrained alongside
+        std::unordered_map<int, int> dy_to_index;
+        for (int n = 0; n < length; n++)
+            dy_to_index[dy(n)] = n;
+        std::vector<std::vector<CellInfo *>> luts_by_index(length);
+        for (auto lut : luts)
+            luts_by_index.at(dy_to_index.at(-lut->constr_y)).push_back(lut);
+
+        root->constr_children.clear();
+        for (int i = 0; i + 1 < int(starts.size()); i++) {
+            int start = starts.at(i), end = starts.at(i + 1);
+            CellInfo *seg_root = chain.at(start);
+            if (i > 0) {
+                seg_root->constr_parent = nullptr;
+                seg_root->constr_x = seg_root->UNCONSTR;
+                seg_root->constr_y = seg_root->UNCONSTR;
+            }
+            for (int n = start; n < end; n++) {
+                std::vector<CellInfo *> cells = luts_by_index.at(n);
+                if (n > start)
+                    cells.push_back(chain.at(n));
+                for (auto ci : cells) {
+                    ci->constr_parent = seg_root;
+                    ci->constr_y = -dy(n - start);
+                    seg_root->constr_children.push_back(ci);
+                }
+            }
+            if (end == length)
+                continue;
+            // Bridge the carry out of this segment to the carry in of the next through fabric, using an extra carry
+            // with S[0] tied low so that O[0] is a copy of its carry in
+            CellInfo *next = chain.at(end);
+            NetInfo *carry = get_net_or_empty(next, ctx->id("CI"));
+            NPNR_ASSERT(carry != nullptr && carry->driver.cell == chain.at(end - 1) && carry->driver.port == co_top);
+            disconnect_port(ctx, next, ctx->id("CI"));
+            std::unique_ptr<CellInfo> bridge =
+                    create_cell(ctx, type, ctx->id(chain.at(end - 1)->name.str(ctx) + "$split$bridge"));
+            connect_port(ctx, carry, bridge.get(), ctx->id("CI"));
+            NetInfo *zero = create_internal_net(bridge->name, "zero", false);
+            std::unique_ptr<CellInfo> zero_lut =
+                    create_lut(ctx, bridge->name.str(ctx) + "$zero", {vcc}, zero, Property(1));
+            connect_port(ctx, zero, bridge.get(), ctx->id("S[0]"));
+            NetInfo *feed = create_internal_net(bridge->name, "carry", false);
+            connect_port(ctx, feed, bridge.get(), ctx->id("O[0]"));
+            // The carry in of the bottom of a chain comes from CYINIT (CARRY4) or AX (CARRY8, through CI)
+            IdString cin = ctx->id(type == ctx->id("CARRY4") ? "CYINIT" : "CI");
+            if (!next->ports.count(cin)) {
+                next->ports[cin].name = cin;
+                next->ports[cin].type = PORT_IN;
+            }
+            connect_port(ctx, feed, next, cin);
+
+            bridge->constr_parent = seg_root;
+            seg_root->constr_children.push_back(bridge.get());
+            bridge->constr_x = 0;
+            bridge->constr_y = -dy(end - start);
+            bridge->constr_abs_z = true;
+            bridge->constr_z = bel_z;
+            CellInfo *bridge_ptr = bridge.get();
+            new_cells.push_back(std::move(zero_lut));
+            new_cells.push_back(std::move(bridge));
+            legalise_carry_luts(bridge_ptr, seg_root, 0, dy(end - start));
+        }
+        ++split_chains;
+        segment_count += int(starts.size()) - 1;
+    }
+    flush_cells();
+    if (split_chains > 0)
+        log_info("   Split %d carry chains longer than %d into %d segments\n", split_chains, max_length,
+                 segment_count);
+}
+
+NEXTPNR_NAMESPACE_END
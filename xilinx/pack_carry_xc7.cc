@@ -66,11 +66,207 @@ bool XC7Packer::has_illegal_fanout(NetInfo *carry)
     return false;
 }
 
+std::vector<std::vector<CellInfo *>> XilinxPacker::find_direct_carry_chains(IdString type, int width)
+{
+    IdString co_top = ctx->id("CO[" + std::to_string(width - 1) + "]");
+    NetInfo *gnd = ctx->nets.at(ctx->id("$PACKER_GND_NET")).get();
+    auto is_gnd = [&](NetInfo *ni) { return ni == nullptr || ni == gnd; };
+    // Internal carries can't leave the chain, and CYINIT (CARRY4) or CI_TOP (CARRY8) can only be used at the bottom of
+    // a chain in single-chain mode
+    auto is_regular = [&](CellInfo *ci, bool is_root) {
+        for (int z = 0; z < width - 1; z++) {
+            NetInfo *co = get_net_or_empty(ci, ctx->id("CO[" + std::to_string(z) + "]"));
+            if (co != nullptr && !co->users.empty())
+                return false;
+        }
+        if (type == ctx->id("CARRY4")) {
+            NetInfo *cyinit = get_net_or_empty(ci, ctx->id("CYINIT"));
+            if (!is_gnd(cyinit) && (!is_root || !is_gnd(get_net_or_empty(ci, ctx->id("CI")))))
+                return false;
+        } else {
+            if (!is_gnd(get_net_or_empty(ci, ctx->id("CI_TOP"))))
+                return false;
+            if (str_or_default(ci->params, ctx->id("CARRY_TYPE"), "SINGLE_CY8") != "SINGLE_CY8")
+                return false;
+        }
+        return true;
+    };
+
+    std::vector<std::vector<CellInfo *>> chains;
+    std::unordered_set<IdString> visited;
+    for (auto cell : sorted(ctx->cells)) {
+        CellInfo *ci = cell.second;
+        if (ci->type != type || is_constrained(ci))
+            continue;
+        NetInfo *cin = get_net_or_empty(ci, ctx->id("CI"));
+        if (cin != nullptr && cin->driver.cell != nullptr && cin->driver.cell->type == type &&
+            cin->driver.port == co_top)
+            continue;
+        std::vector<CellInfo *> chain;
+        bool regular = true;
+        CellInfo *curr = ci;
+        while (curr != nullptr && !visited.count(curr->name)) {
+            visited.insert(curr->name);
+            chain.push_back(curr);
+            if (!is_regular(curr, curr == ci) || is_constrained(curr))
+                regular = false;
+            NetInfo *co = get_net_or_empty(curr, co_top);
+            curr = nullptr;
+            if (co == nullptr)
+                break;
+            // The top carry out may only feed the next carry in the chain
+            for (auto &usr : co->users) {
+                if (usr.cell->type == type && usr.port == ctx->id("CI") && curr == nullptr)
+                    curr = usr.cell;
+                else
+                    regular = false;
+            }
+        }
+        if (regular)
+            chains.push_back(chain);
+    }
+    return chains;
+}
+
+void XilinxPacker::legalise_carry_luts(CellInfo *carry, CellInfo *root, int z, int dy)
+{
+    // N.B. LUT6 is not a valid type here, as CARRY requires dual outputs
+    static const std::unordered_set<std::string> lut_types{"LUT1", "LUT2", "LUT3", "LUT4", "LUT5"};
+    auto is_lut = [&](CellInfo *ci) { return ci != nullptr && lut_types.count(ci->type.str(ctx)); };
+
+    NetInfo *c_s = get_net_or_empty(carry, ctx->id("S[" + std::to_string(z) + "]"));
+    NetInfo *c_di = get_net_or_empty(carry, ctx->id("DI[" + std::to_string(z) + "]"));
+    // Keep track of the total LUT input count; cannot exceed five or the LUTs cannot be packed together
+    std::unordered_set<IdString> unique_lut_inputs;
+    int s_inputs = 0, d_inputs = 0;
+    // Check that S and DI are validy and unqiuely driven by LUTs
+    // FIXME: in multiple fanout cases, cell duplication will probably be cheaper
+    // than feed-throughs
+    CellInfo *s_lut = nullptr, *di_lut = nullptr;
+    if (c_s) {
+        if (c_s->users.size() == 1 && is_lut(c_s->driver.cell)) {
+            s_lut = c_s->driver.cell;
+            for (int j = 0; j < 5; j++) {
+                NetInfo *ix = get_net_or_empty(s_lut, ctx->id("I" + std::to_string(j)));
+                if (ix) {
+                    unique_lut_inputs.insert(ix->name);
+                    s_inputs++;
+                }
+            }
+        }
+    }
+    if (c_di) {
+        if (c_di->users.size() == 1 && is_lut(c_di->driver.cell)) {
+            di_lut = c_di->driver.cell;
+            for (int j = 0; j < 5; j++) {
+                NetInfo *ix = get_net_or_empty(di_lut, ctx->id("I" + std::to_string(j)));
+                if (ix) {
+                    unique_lut_inputs.insert(ix->name);
+                    d_inputs++;
+                }
+            }
+        }
+    }
+    int lut_inp_count = int(unique_lut_inputs.size());
+    if (!s_lut)
+        ++lut_inp_count; // for feedthrough
+    if (!di_lut)
+        ++lut_inp_count; // for feedthrough
+    if (lut_inp_count > 5) {
+        // Must use feedthrough for at least one LUT
+        di_lut = nullptr;
+        if (s_inputs > 4)
+            s_lut = nullptr;
+    }
+    // If LUTs are nullptr, that means we need a feedthrough lut
+    if (!s_lut && c_s) {
+        PortRef pr;
+        pr.cell = carry;
+        pr.port = ctx->id("S[" + std::to_string(z) + "]");
+        auto s_feed = feed_through_lut(c_s, {pr});
+        s_lut = s_feed.get();
+        new_cells.push_back(std::move(s_feed));
+    }
+    if (!di_lut && c_di) {
+        PortRef pr;
+        pr.cell = carry;
+        pr.port = ctx->id("DI[" + std::to_string(z) + "]");
+        auto di_feed = feed_through_lut(c_di, {pr});
+        di_lut = di_feed.get();
+        new_cells.push_back(std::move(di_feed));
+    }
+    // Constrain LUTs relative to root carry
+    if (s_lut) {
+        root->constr_children.push_back(s_lut);
+        s_lut->constr_parent = root;
+        s_lut->constr_x = 0;
+        s_lut->constr_y = -dy;
+        s_lut->constr_abs_z = true;
+        s_lut->constr_z = (z << 4 | BEL_6LUT);
+    }
+    if (di_lut) {
+        root->constr_children.push_back(di_lut);
+        di_lut->constr_parent = root;
+        di_lut->constr_x = 0;
+        di_lut->constr_y = -dy;
+        di_lut->constr_abs_z = true;
+        di_lut->constr_z = (z << 4 | BEL_5LUT);
+    }
+}
+
+int XC7Packer::pack_carry4_chains()
+{
+    NetInfo *gnd = ctx->nets.at(ctx->id("$PACKER_GND_NET")).get();
+    std::vector<IdString> dead_nets;
+    int count = 0;
+    for (auto &chain : find_direct_carry_chains(ctx->id("CARRY4"), 4)) {
+        CellInfo *root = chain.front();
+        for (int n = 0; n < int(chain.size()); n++) {
+            CellInfo *c4 = chain.at(n);
+            if (n == 0) {
+                // The carry in of the chain always enters through CYINIT
+                NetInfo *cin = get_net_or_empty(c4, ctx->id("CI"));
+                if (cin == nullptr || cin == gnd)
+                    cin = get_net_or_empty(c4, ctx->id("CYINIT"));
+                disconnect_port(ctx, c4, ctx->id("CI"));
+                disconnect_port(ctx, c4, ctx->id("CYINIT"));
+                connect_port(ctx, cin, c4, ctx->id("CYINIT"));
+                c4->constr_abs_z = true;
+                c4->constr_z = BEL_CARRY4;
+            } else {
+                disconnect_port(ctx, c4, ctx->id("CYINIT"));
+                c4->constr_parent = root;
+                root->constr_children.push_back(c4);
+                c4->constr_x = 0;
+                // Looks no CARRY4 on the tile of which grid_y is a multiple of 26. Skip them
+                c4->constr_y = -(n + n / 25);
+                c4->constr_abs_z = true;
+                c4->constr_z = BEL_CARRY4;
+            }
+            for (int z = 0; z < 3; z++) {
+                NetInfo *co = get_net_or_empty(c4, ctx->id("CO[" + std::to_string(z) + "]"));
+                if (co != nullptr) {
+                    disconnect_port(ctx, c4, ctx->id("CO[" + std::to_string(z) + "]"));
+                    dead_nets.push_back(co->name);
+                }
+            }
+            for (int z = 0; z < 4; z++)
+                legalise_carry_luts(c4, root, z, n + n / 25);
+            ++count;
+        }
+    }
+    flush_cells();
+    for (auto net : dead_nets)
+        ctx->nets.erase(net);
+    return count;
+}
+
 void XilinxPacker::split_carry4s()
 {
     for (auto cell : sorted(ctx->cells)) {
         CellInfo *ci = cell.second;
-        if (ci->type != ctx->id("CARRY4"))
+        // CARRY4s that are already constrained have been packed by pack_carry4_chains
+        if (ci->type != ctx->id("CARRY4") || is_constrained(ci))
             continue;
         NetInfo *cin = get_net_or_empty(ci, ctx->id("CI"));
         if (cin == nullptr || cin->name == ctx->id("$PACKER_GND_NET")) {
@@ -107,6 +303,12 @@ void XilinxPacker::split_carry4s()
 void XC7Packer::pack_carries()
 {
     log_info("Packing carries..\n");
+    int direct_count = pack_carry4_chains();
+    int split_count = 0;
+    for (auto &cell : ctx->cells)
+        if (cell.second->type == ctx->id("CARRY4") && !is_constrained(cell.second.get()))
+            ++split_count;
+    log_info("   Packed %d CARRY4s directly into chains, splitting %d irregular CARRY4s\n", direct_count, split_count);
     split_carry4s();
     std::vector<CellInfo *> root_muxcys;
     // Find MUXCYs
@@ -215,10 +417,6 @@ void XC7Packer::pack_carries()
 
     log_info("   Grouped %d MUXCYs and %d XORCYs into %d chains.\n", muxcy_count, xorcy_count, int(root_muxcys.size()));
 
-    // N.B. LUT6 is not a valid type here, as CARRY requires dual outputs
-    std::unordered_set<IdString> lut_types{ctx->id("LUT1"), ctx->id("LUT2"), ctx->id("LUT3"), ctx->id("LUT4"),
-                                           ctx->id("LUT5")};
-
     std::unordered_set<IdString> folded_nets;
 
     for (auto &grp : groups) {
@@ -277,87 +475,7 @@ void XC7Packer::pack_carries()
                 disconnect_port(ctx, xorcy, ctx->id("DI"));
                 packed_cells.insert(xorcy->name);
             }
-            // Check legality of LUTs driving CARRY4, making them legal if they aren't already
-            NetInfo *c4_s = get_net_or_empty(c4, ctx->id("S[" + std::to_string(z) + "]"));
-            NetInfo *c4_di = get_net_or_empty(c4, ctx->id("DI[" + std::to_string(z) + "]"));
-            // Keep track of the total LUT input count; cannot exceed five or the LUTs cannot be packed together
-            std::unordered_set<IdString> unique_lut_inputs;
-            int s_inputs = 0, d_inputs = 0;
-            // Check that S and DI are validy and unqiuely driven by LUTs
-            // FIXME: in multiple fanout cases, cell duplication will probably be cheaper
-            // than feed-throughs
-            CellInfo *s_lut = nullptr, *di_lut = nullptr;
-            if (c4_s) {
-                if (c4_s->users.size() == 1 && c4_s->driver.cell != nullptr &&
-                    lut_types.count(c4_s->driver.cell->type)) {
-                    s_lut = c4_s->driver.cell;
-                    for (int j = 0; j < 5; j++) {
-                        NetInfo *ix = get_net_or_empty(s_lut, ctx->id("I" + std::to_string(j)));
-                        if (ix) {
-                            unique_lut_inputs.insert(ix->name);
-                            s_inputs++;
-                        }
-                    }
-                }
-            }
-            if (c4_di) {
-                if (c4_di->users.size() == 1 && c4_di->driver.cell != nullptr &&
-                    lut_types.count(c4_di->driver.cell->type)) {
-                    di_lut = c4_di->driver.cell;
-                    for (int j = 0; j < 5; j++) {
-                        NetInfo *ix = get_net_or_empty(di_lut, ctx->id("I" + std::to_string(j)));
-                        if (ix) {
-                            unique_lut_inputs.insert(ix->name);
-                            d_inputs++;
-                        }
-                    }
-                }
-            }
-            int lut_inp_count = int(unique_lut_inputs.size());
-            if (!s_lut)
-                ++lut_inp_count; // for feedthrough
-            if (!di_lut)
-                ++lut_inp_count; // for feedthrough
-            if (lut_inp_count > 5) {
-                // Must use feedthrough for at least one LUT
-                di_lut = nullptr;
-                if (s_inputs > 4)
-                    s_lut = nullptr;
-            }
-            // If LUTs are nullptr, that means we need a feedthrough lut
-            if (!s_lut && c4_s) {
-                PortRef pr;
-                pr.cell = c4;
-                pr.port = ctx->id("S[" + std::to_string(z) + "]");
-                auto s_feed = feed_through_lut(c4_s, {pr});
-                s_lut = s_feed.get();
-                new_cells.push_back(std::move(s_feed));
-            }
-            if (!di_lut && c4_di) {
-                PortRef pr;
-                pr.cell = c4;
-                pr.port = ctx->id("DI[" + std::to_string(z) + "]");
-                auto di_feed = feed_through_lut(c4_di, {pr});
-                di_lut = di_feed.get();
-                new_cells.push_back(std::move(di_feed));
-            }
-            // Constrain LUTs relative to root CARRY4
-            if (s_lut) {
-                root->constr_children.push_back(s_lut);
-                s_lut->constr_parent = root;
-                s_lut->constr_x = 0;
-                s_lut->constr_y = -(i / 4 + i / (4*25));
-                s_lut->constr_abs_z = true;
-                s_lut->constr_z = (z << 4 | BEL_6LUT);
-            }
-            if (di_lut) {
-                root->constr_children.push_back(di_lut);
-                di_lut->constr_parent = root;
-                di_lut->constr_x = 0;
-                di_lut->constr_y = -(i / 4 + i / (4*25));
-                di_lut->constr_abs_z = true;
-                di_lut->constr_z = (z << 4 | BEL_5LUT);
-            }
+            legalise_carry_luts(c4, root, z, i / 4 + i / (4 * 25));
         }
         for (auto &c4 : carry4s)
             new_cells.push_back(std::move(c4));
@@ -367,6 +485,9 @@ void XC7Packer::pack_carries()
     for (auto net : folded_nets)
         ctx->nets.erase(net);
 
+    // Looks no CARRY4 on the tile of which grid_y is a multiple of 26, which is also where carry chains are split
+    split_carry_chains(ctx->id("CARRY4"), 4, 25, 25);
+
     // XORCYs and MUXCYs not part of any chain (and therefore not packed into a CARRY4) must now be blasted
     // to boring soft logic (LUT2 or LUT3 - these will become SLICE_LUTXs later in the flow.)
     int remaining_muxcy = 0, remaining_xorcy = 0;
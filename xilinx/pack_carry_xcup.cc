@@ -66,9 +66,46 @@ bool USPacker::has_illegal_fanout(NetInfo *carry)
     return false;
 }
 
+int USPacker::pack_carry8_chains()
+{
+    std::vector<IdString> dead_nets;
+    int count = 0;
+    for (auto &chain : find_direct_carry_chains(ctx->id("CARRY8"), 8)) {
+        CellInfo *root = chain.front();
+        for (int n = 0; n < int(chain.size()); n++) {
+            CellInfo *c8 = chain.at(n);
+            disconnect_port(ctx, c8, ctx->id("CI_TOP"));
+            c8->constr_abs_z = true;
+            c8->constr_z = BEL_CARRY8;
+            if (n > 0) {
+                c8->constr_parent = root;
+                root->constr_children.push_back(c8);
+                c8->constr_x = 0;
+                c8->constr_y = -n;
+            }
+            for (int z = 0; z < 7; z++) {
+                NetInfo *co = get_net_or_empty(c8, ctx->id("CO[" + std::to_string(z) + "]"));
+                if (co != nullptr) {
+                    disconnect_port(ctx, c8, ctx->id("CO[" + std::to_string(z) + "]"));
+                    dead_nets.push_back(co->name);
+                }
+            }
+            for (int z = 0; z < 8; z++)
+                legalise_carry_luts(c8, root, z, n);
+            ++count;
+        }
+    }
+    flush_cells();
+    for (auto net : dead_nets)
+        ctx->nets.erase(net);
+    return count;
+}
+
 void USPacker::pack_carries()
 {
     log_info("Packing carries..\n");
+    int direct_count = pack_carry8_chains();
+    log_info("   Packed %d CARRY8s directly into chains\n", direct_count);
     split_carry4s();
     std::vector<CellInfo *> root_muxcys;
     // Find MUXCYs
@@ -177,10 +214,6 @@ void USPacker::pack_carries()
 
     log_info("   Grouped %d MUXCYs and %d XORCYs into %d chains.\n", muxcy_count, xorcy_count, int(root_muxcys.size()));
 
-    // N.B. LUT6 is not a valid type here, as CARRY requires dual outputs
-    std::unordered_set<IdString> lut_types{ctx->id("LUT1"), ctx->id("LUT2"), ctx->id("LUT3"), ctx->id("LUT4"),
-                                           ctx->id("LUT5")};
-
     std::unordered_set<IdString> folded_nets;
 
     for (auto &grp : groups) {
@@ -236,87 +269,7 @@ void USPacker::pack_carries()
                 disconnect_port(ctx, xorcy, ctx->id("DI"));
                 packed_cells.insert(xorcy->name);
             }
-            // Check legality of LUTs driving CARRY8, making them legal if they aren't already
-            NetInfo *c8_s = get_net_or_empty(c8, ctx->id("S[" + std::to_string(z) + "]"));
-            NetInfo *c8_di = get_net_or_empty(c8, ctx->id("DI[" + std::to_string(z) + "]"));
-            // Keep track of the total LUT input count; cannot exceed five or the LUTs cannot be packed together
-            std::unordered_set<IdString> unique_lut_inputs;
-            int s_inputs = 0, d_inputs = 0;
-            // Check that S and DI are validy and unqiuely driven by LUTs
-            // FIXME: in multiple fanout cases, cell duplication will probably be cheaper
-            // than feed-throughs
-            CellInfo *s_lut = nullptr, *di_lut = nullptr;
-            if (c8_s) {
-                if (c8_s->users.size() == 1 && c8_s->driver.cell != nullptr &&
-                    lut_types.count(c8_s->driver.cell->type)) {
-                    s_lut = c8_s->driver.cell;
-                    for (int j = 0; j < 5; j++) {
-                        NetInfo *ix = get_net_or_empty(s_lut, ctx->id("I" + std::to_string(j)));
-                        if (ix) {
-                            unique_lut_inputs.insert(ix->name);
-                            s_inputs++;
-                        }
-                    }
-                }
-            }
-            if (c8_di) {
-                if (c8_di->users.size() == 1 && c8_di->driver.cell != nullptr &&
-                    lut_types.count(c8_di->driver.cell->type)) {
-                    di_lut = c8_di->driver.cell;
-                    for (int j = 0; j < 5; j++) {
-                        NetInfo *ix = get_net_or_empty(di_lut, ctx->id("I" + std::to_string(j)));
-                        if (ix) {
-                            unique_lut_inputs.insert(ix->name);
-                            d_inputs++;
-                        }
-                    }
-                }
-            }
-            int lut_inp_count = int(unique_lut_inputs.size());
-            if (!s_lut)
-                ++lut_inp_count; // for feedthrough
-            if (!di_lut)
-                ++lut_inp_count; // for feedthrough
-            if (lut_inp_count > 5) {
-                // Must use feedthrough for at least one LUT
-                di_lut = nullptr;
-                if (s_inputs > 4)
-                    s_lut = nullptr;
-            }
-            // If LUTs are nullptr, that means we need a feedthrough lut
-            if (!s_lut && c8_s) {
-                PortRef pr;
-                pr.cell = c8;
-                pr.port = ctx->id("S[" + std::to_string(z) + "]");
-                auto s_feed = feed_through_lut(c8_s, {pr});
-                s_lut = s_feed.get();
-                new_cells.push_back(std::move(s_feed));
-            }
-            if (!di_lut && c8_di) {
-                PortRef pr;
-                pr.cell = c8;
-                pr.port = ctx->id("DI[" + std::to_string(z) + "]");
-                auto di_feed = feed_through_lut(c8_di, {pr});
-                di_lut = di_feed.get();
-                new_cells.push_back(std::move(di_feed));
-            }
-            // Constrain LUTs relative to root CARRY8
-            if (s_lut) {
-                root->constr_children.push_back(s_lut);
-                s_lut->constr_parent = root;
-                s_lut->constr_x = 0;
-                s_lut->constr_y = -i / 8;
-                s_lut->constr_abs_z = true;
-                s_lut->constr_z = (z << 4 | BEL_6LUT);
-            }
-            if (di_lut) {
-                root->constr_children.push_back(di_lut);
-                di_lut->constr_parent = root;
-                di_lut->constr_x = 0;
-                di_lut->constr_y = -i / 8;
-                di_lut->constr_abs_z = true;
-                di_lut->constr_z = (z << 4 | BEL_5LUT);
-            }
+            legalise_carry_luts(c8, root, z, i / 8);
         }
         for (auto &c8 : carry8s)
             new_cells.push_back(std::move(c8));
@@ -326,6 +279,9 @@ void USPacker::pack_carries()
     for (auto net : folded_nets)
         ctx->nets.erase(net);
 
+    // Carry chains are split at clock region boundaries, every 60 rows
+    split_carry_chains(ctx->id("CARRY8"), 8, 0, 60);
+
     // XORCYs and MUXCYs not part of any chain (and therefore not packed into a CARRY8) must now be blasted
     // to boring soft logic (LUT2 or LUT3 - these will become SLICE_LUTXs later in the flow.)
     int remaining_muxcy = 0, remaining_xorcy = 0;
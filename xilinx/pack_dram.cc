@@ -226,11 +226,10 @@ void XilinxPacker::pack_dram()
             ++inverted_ports;
             if (ci->params.count(ctx->id("INIT"))) {
                 Property &init = ci->params[ctx->id("INIT")];
-                for (int j = 0; j < int(init.str.size()); j++) {
+                for (int j = 0; j < int(init.size()); j++) {
                     if (j & (1 << i))
-                        init.str[j] = init.str[j & ~(1 << i)];
+                        init.set_bit(j, init.get_bit(j & ~(1 << i)));
                 }
-                init.update_intval();
             }
         }
     }
@@ -0,0 +1,556 @@
+/*
+ *  nextpnr -- Next Generation Place and Route
+ *
+ *  Copyright (C) 2026  agent <agent@local>
+ *
+ *  Permission to use, copy, modify, and/or distribute this software for any
+ *  purpose with or without fee is hereby granted, provided that the above
+ *  copyright notice and this permission notice appear in all copies.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ *  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ *  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ *  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ *  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ *  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ *  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ */
+
+#include <algorithm>
+#include <boost/algorithm/string.hpp>
+#include <limits>
+#include <map>
+#include "design_utils.h"
+#include "log.h"
+#include "nextpnr.h"
+#include "pack.h"
+
+NEXTPNR_NAMESPACE_BEGIN
+
+namespace {
+struct IoSite
+{
+    BelId bel;
+    int bank = -1;
+    // Index of the other half of a differential pair, or -1
+    int partner = -1;
+    bool master = false, ccio = false, used = false;
+    Loc loc;
+};
+
+struct IoBank
+{
+    std::vector<int> sites;
+    // High performance banks only support VCCO up to 1.8V
+    bool hp = false;
+    // Bank voltage in mV as set by the IOs placed so far, 0 if still free
+    int vcco = 0;
+    int x = 0, y = 0;
+};
+
+struct IoItem
+{
+    // n is the complementary pad of a differential pair, or nullptr
+    CellInfo *p = nullptr, *n = nullptr;
+    bool clock = false;
+    int vcco = 0;
+    Loc target;
+};
+
+// The VCCO in mV an IOSTANDARD requires of its bank, or 0 if it places no requirement on it
+int iostandard_vcco(std::string iostd)
+{
+    if (boost::starts_with(iostd, "DIFF_"))
+        iostd = iostd.substr(5);
+    if (boost::ends_with(iostd, "_T_DCI"))
+        iostd = iostd.substr(0, iostd.size() - 6);
+    else if (boost::ends_with(iostd, "_DCI"))
+        iostd = iostd.substr(0, iostd.size() - 4);
+    if (iostd == "LVTTL" || boost::ends_with(iostd, "33"))
+        return 3300;
+    if (boost::ends_with(iostd, "25"))
+        return 2500;
+    if (iostd == "LVDS" || boost::ends_with(iostd, "18") || boost::starts_with(iostd, "SSTL18"))
+        return 1800;
+    if (boost::starts_with(iostd, "SSTL135"))
+        return 1350;
+    if (iostd == "LVCMOS15" || boost::starts_with(iostd, "SSTL15") || iostd == "HSTL_I" || iostd == "HSTL_II")
+        return 1500;
+    if (boost::ends_with(iostd, "12") || boost::starts_with(iostd, "SSTL12"))
+        return 1200;
+    if (boost::ends_with(iostd, "10"))
+        return 1000;
+    return 0;
+}
+
+// Whether an xc7 IO has a dedicated route from its input buffer to the clocking in the HCLK_CMT tile
+bool xc7_io_is_ccio(Context *ctx, const std::string &site, bool hp)
+{
+    BelId inbuf = ctx->getBelByName(ctx->id(site + (hp ? "/IOB18/INBUF_DCIEN" : "/IOB33/INBUF_EN")));
+    if (inbuf == BelId())
+        return false;
+    std::vector<WireId> frontier{ctx->getBelPinWire(inbuf, ctx->id("OUT"))};
+    std::unordered_set<WireId> seen(frontier.begin(), frontier.end());
+    // Fabric routing takes far more hops than this to reach the HCLK_CMT
+    for (int depth = 0; depth < 5 && !frontier.empty(); depth++) {
+        std::vector<WireId> next;
+        for (auto wire : frontier) {
+            for (auto pip : ctx->getPipsDownhill(wire)) {
+                if (boost::starts_with(ctx->getTileType(ctx->getTileByIndex(pip.tile)).str(ctx), "HCLK_CMT"))
+                    return true;
+                WireId dst = ctx->getPipDstWire(pip);
+                if (seen.insert(dst).second)
+                    next.push_back(dst);
+            }
+        }
+        frontier = std::move(next);
+    }
+    return false;
+}
+
+// The differential input buffer pin that an UltraScale IO's PADOUT connects to
+BelPin us_io_diff_pin(Context *ctx, const std::string &site)
+{
+    BelId padout = ctx->getBelByName(ctx->id(site + "/PADOUT"));
+    if (padout == BelId())
+        return BelPin();
+    WireId cursor = ctx->getBelPinWire(padout, ctx->id("OUT"));
+    for (int i = 0; i < 16; i++) {
+        auto pips_dh = ctx->getPipsDownhill(cursor);
+        if (!(pips_dh.begin() != pips_dh.end())) {
+            for (auto bp : ctx->getWireBelPins(cursor))
+                return bp;
+            break;
+        }
+        cursor = ctx->getPipDstWire(*pips_dh.begin());
+    }
+    return BelPin();
+}
+
+int io_dist(const Loc &a, const Loc &b) { return std::abs(a.x - b.x) + std::abs(a.y - b.y); }
+
+// Minimum cost assignment of rows to distinct columns (Hungarian algorithm); requires at least as many columns as
+// rows. Returns the column of each row
+std::vector<int> solve_assignment(const std::vector<std::vector<int64_t>> &cost, int cols)
+{
+    int rows = int(cost.size());
+    const int64_t inf = std::numeric_limits<int64_t>::max() / 4;
+    std::vector<int64_t> u(rows + 1, 0), v(cols + 1, 0);
+    std::vector<int> match(cols + 1, 0), way(cols + 1, 0);
+    for (int i = 1; i <= rows; i++) {
+        match.at(0) = i;
+        int j0 = 0;
+        std::vector<int64_t> minv(cols + 1, inf);
+        std::vector<bool> done(cols + 1, false);
+        do {
+            done.at(j0) = true;
+            int i0 = match.at(j0), j1 = 0;
+            int64_t delta = inf;
+            for (int j = 1; j <= cols; j++) {
+                if (done.at(j))
+                    continue;
+                int64_t cur = cost.at(i0 - 1).at(j - 1) - u.at(i0) - v.at(j);
+                if (cur < minv.at(j)) {
+                    minv.at(j) = cur;
+                    way.at(j) = j0;
+                }
+                if (minv.at(j) < delta) {
+                    delta = minv.at(j);
+                    j1 = j;
+                }
+            }
+            for (int j = 0; j <= cols; j++) {
+                if (done.at(j)) {
+                    u.at(match.at(j)) += delta;
+                    v.at(j) -= delta;
+                } else {
+                    minv.at(j) -= delta;
+                }
+            }
+            j0 = j1;
+        } while (match.at(j0) != 0);
+        do {
+            int j1 = way.at(j0);
+            match.at(j0) = match.at(j1);
+            j0 = j1;
+        } while (j0 != 0);
+    }
+    std::vector<int> result(rows, -1);
+    for (int j = 1; j <= cols; j++)
+        if (match.at(j) != 0)
+            result.at(match.at(j) - 1) = j - 1;
+    return result;
+}
+} // namespace
+
+bool XilinxPacker::io_drives_clock(const PortRef &buf)
+{
+    const std::string &type = buf.cell->type.str(ctx);
+    if (boost::starts_with(type, "IBUFG"))
+        return true;
+    NetInfo *out = get_net_or_empty(buf.cell, ctx->id("O"));
+    if (out == nullptr)
+        return false;
+    for (auto &usr : out->users) {
+        const std::string &usr_type = usr.cell->type.str(ctx);
+        if (boost::starts_with(usr_type, "BUFG") || boost::starts_with(usr_type, "BUFH") ||
+            boost::starts_with(usr_type, "BUFR") || boost::starts_with(usr_type, "BUFIO") ||
+            boost::starts_with(usr_type, "BUFMR") || boost::starts_with(usr_type, "MMCM") ||
+            boost::starts_with(usr_type, "PLL"))
+            return true;
+        if (usr.port == ctx->id("C") || usr.port == ctx->id("CLK"))
+            return true;
+    }
+    return false;
+}
+
+void XilinxPacker::plan_io(const std::vector<std::pair<CellInfo *, PortRef>> &pad_and_buf,
+                           const std::unordered_set<BelId> &used_io_bels)
+{
+    int unconstr_count = 0;
+    for (auto &iob : pad_and_buf)
+        if (!iob.first->attrs.count(ctx->id("BEL")))
+            ++unconstr_count;
+    if (unconstr_count == 0)
+        return;
+    log_info("Planning %d unconstrained IOs..\n", unconstr_count);
+
+    // Discover the user IO sites of the device, their banks and differential pairing
+    std::vector<IoSite> sites;
+    std::vector<IoBank> banks;
+    std::unordered_map<BelId, int> site_by_bel;
+    std::map<std::pair<int, int>, int> bank_by_key;
+    std::unordered_map<int, std::vector<int>> sites_by_tile;
+    std::unordered_map<BelId, std::vector<std::pair<int, BelPin>>> sites_by_diffbuf;
+    IdString pad_id = ctx->xc7 ? ctx->id("PAD") : ctx->id("IOB_PAD");
+    for (auto bel : ctx->getBels()) {
+        if (ctx->getBelType(bel) != pad_id)
+            continue;
+        if (ctx->xc7 && ctx->locInfo(bel).bel_data[bel.index].site_variant != 0)
+            continue;
+        if (ctx->getBelPackagePin(bel) == ".")
+            continue;
+        std::string tile_type = ctx->getBelTileType(bel).str(ctx);
+        std::string site = ctx->getBelSite(bel);
+        IoSite io;
+        io.bel = bel;
+        io.loc = ctx->getBelLocation(bel);
+        io.used = used_io_bels.count(bel);
+        std::pair<int, int> bank_key;
+        bool hp;
+        if (ctx->xc7) {
+            // Transceiver pads can't be used for general IO
+            if (!boost::starts_with(tile_type, "LIOB") && !boost::starts_with(tile_type, "RIOB"))
+                continue;
+            // Each xc7 bank has exactly one HCLK_IOI
+            hp = boost::starts_with(tile_type, "RIOB18");
+            bank_key = std::make_pair(ctx->getHclkForIob(bel), 0);
+            io.master = ctx->getBelByName(ctx->id(site + (hp ? "/IOB18M/PAD" : "/IOB33M/PAD"))) != BelId();
+            io.ccio = xc7_io_is_ccio(ctx, site, hp);
+        } else {
+            // UltraScale banks are one clock region tall
+            hp = boost::starts_with(tile_type, "HPIO");
+            bank_key = std::make_pair(io.loc.x, io.loc.y / 60);
+        }
+        auto bank_found = bank_by_key.find(bank_key);
+        if (bank_found == bank_by_key.end()) {
+            bank_found = bank_by_key.emplace(bank_key, int(banks.size())).first;
+            banks.emplace_back();
+            banks.back().hp = hp;
+        }
+        io.bank = bank_found->second;
+        int index = int(sites.size());
+        banks.at(io.bank).sites.push_back(index);
+        site_by_bel[bel] = index;
+        sites.push_back(io);
+        if (ctx->xc7) {
+            sites_by_tile[bel.tile].push_back(index);
+        } else {
+            BelPin diff_pin = us_io_diff_pin(ctx, site);
+            if (diff_pin.bel != BelId())
+                sites_by_diffbuf[diff_pin.bel].emplace_back(index, diff_pin);
+        }
+    }
+    // The two IOs of an xc7 IOB tile are a pair; on UltraScale pairs share a differential input buffer
+    for (auto &tile : sites_by_tile) {
+        if (tile.second.size() != 2)
+            continue;
+        sites.at(tile.second.at(0)).partner = tile.second.at(1);
+        sites.at(tile.second.at(1)).partner = tile.second.at(0);
+    }
+    for (auto &diffbuf : sites_by_diffbuf) {
+        if (diffbuf.second.size() != 2)
+            continue;
+        for (int i = 0; i < 2; i++) {
+            IoSite &io = sites.at(diffbuf.second.at(i).first);
+            io.partner = diffbuf.second.at(1 - i).first;
+            io.master = diffbuf.second.at(i).second.pin == ctx->id("DIFF_IN_P");
+        }
+    }
+    for (auto &bank : banks) {
+        for (int s : bank.sites) {
+            bank.x += sites.at(s).loc.x;
+            bank.y += sites.at(s).loc.y;
+        }
+        bank.x /= int(bank.sites.size());
+        bank.y /= int(bank.sites.size());
+    }
+
+    // Constrained IOs fix the voltage of their bank, and act as anchors for the unconstrained ones
+    std::unordered_map<IdString, Loc> io_loc;
+    auto pad_site = [&](CellInfo *pad) {
+        if (!pad->attrs.count(ctx->id("BEL")))
+            return -1;
+        auto found = site_by_bel.find(ctx->getBelByName(ctx->id(pad->attrs.at(ctx->id("BEL")).as_string())));
+        return found == site_by_bel.end() ? -1 : found->second;
+    };
+    for (auto &iob : pad_and_buf) {
+        CellInfo *pad = iob.first;
+        int s = pad_site(pad);
+        if (s == -1)
+            continue;
+        io_loc[pad->name] = sites.at(s).loc;
+        int vcco = iostandard_vcco(str_or_default(pad->attrs, ctx->id("IOSTANDARD"), ""));
+        IoBank &bank = banks.at(sites.at(s).bank);
+        if (vcco == 0)
+            continue;
+        if (bank.vcco != 0 && bank.vcco != vcco)
+            log_warning("IO '%s' needs a bank voltage of %.2fV, but its bank also has IOs needing %.2fV\n",
+                        pad->name.c_str(ctx), vcco / 1000.0, bank.vcco / 1000.0);
+        else
+            bank.vcco = vcco;
+    }
+
+    auto set_site = [&](CellInfo *pad, int s) {
+        IoSite &io = sites.at(s);
+        NPNR_ASSERT(!io.used);
+        io.used = true;
+        pad->attrs[ctx->id("BEL")] = std::string(ctx->nameOfBel(io.bel));
+        io_loc[pad->name] = io.loc;
+        int vcco = iostandard_vcco(str_or_default(pad->attrs, ctx->id("IOSTANDARD"), ""));
+        if (vcco != 0)
+            banks.at(io.bank).vcco = vcco;
+        log_info("    Constraining '%s' to site '%s'\n", pad->name.c_str(ctx), ctx->getBelSite(io.bel).c_str());
+    };
+
+    // Pair up the two halves of differential buffers. Where only one half is constrained the other half must go on
+    // its partner
+    std::unordered_map<IdString, CellInfo *> p_pad, n_pad;
+    std::unordered_map<IdString, PortRef> pad_buf;
+    for (auto &iob : pad_and_buf) {
+        IdString port = iob.second.port;
+        bool is_n = port == ctx->id("IB") || port == ctx->id("OB") || port == ctx->id("IOB");
+        (is_n ? n_pad : p_pad)[iob.second.cell->name] = iob.first;
+        pad_buf[iob.first->name] = iob.second;
+    }
+    std::vector<IoItem> items;
+    for (auto &iob : pad_and_buf) {
+        CellInfo *pad = iob.first;
+        IdString buf = iob.second.cell->name;
+        bool is_p = p_pad.count(buf) && p_pad.at(buf) == pad;
+        CellInfo *other = is_p ? (n_pad.count(buf) ? n_pad.at(buf) : nullptr)
+                               : (p_pad.count(buf) ? p_pad.at(buf) : nullptr);
+        if (pad->attrs.count(ctx->id("BEL")))
+            continue;
+        if (other != nullptr && other->attrs.count(ctx->id("BEL"))) {
+            int s = pad_site(other);
+            if (s != -1 && sites.at(s).partner != -1 && !sites.at(sites.at(s).partner).used) {
+                set_site(pad, sites.at(s).partner);
+                continue;
+            }
+            log_error("Differential pad '%s' cannot be placed, as the site of its constrained partner '%s' has no "
+                      "free partner site.\n",
+                      pad->name.c_str(ctx), other->name.c_str(ctx));
+        }
+        if (!is_p && other != nullptr)
+            continue;
+        IoItem item;
+        item.p = pad;
+        item.n = other;
+        item.clock = io_drives_clock(iob.second);
+        item.vcco = iostandard_vcco(str_or_default(pad->attrs, ctx->id("IOSTANDARD"), ""));
+        items.push_back(item);
+    }
+
+    // Aim each IO at the centroid of the placed logic and IOs near it in the netlist
+    Loc fallback(0, 0, 0);
+    {
+        int count = 0;
+        for (auto &loc : io_loc) {
+            fallback.x += loc.second.x;
+            fallback.y += loc.second.y;
+            ++count;
+        }
+        if (count == 0)
+            for (auto &bank : banks) {
+                fallback.x += bank.x;
+                fallback.y += bank.y;
+                ++count;
+            }
+        if (count > 0) {
+            fallback.x /= count;
+            fallback.y /= count;
+        }
+    }
+    const int max_anchor_fanout = 64, anchor_depth = 2;
+    for (auto &item : items) {
+        std::vector<CellInfo *> frontier{pad_buf.at(item.p->name).cell};
+        std::unordered_set<IdString> seen{frontier.front()->name};
+        int64_t sum_x = 0, sum_y = 0, count = 0;
+        for (int depth = 0; depth < anchor_depth && !frontier.empty(); depth++) {
+            std::vector<CellInfo *> next;
+            for (auto ci : frontier) {
+                for (auto &port : ci->ports) {
+                    NetInfo *ni = port.second.net;
+                    if (ni == nullptr || int(ni->users.size()) > max_anchor_fanout)
+                        continue;
+                    if (ni->name == ctx->id("$PACKER_GND_NET") || ni->name == ctx->id("$PACKER_VCC_NET"))
+                        continue;
+                    std::vector<CellInfo *> cells;
+                    if (ni->driver.cell != nullptr)
+                        cells.push_back(ni->driver.cell);
+                    for (auto &usr : ni->users)
+                        cells.push_back(usr.cell);
+                    for (auto other : cells) {
+                        if (!seen.insert(other->name).second)
+                            continue;
+                        next.push_back(other);
+                        if (other == item.p || other == item.n)
+                            continue;
+                        Loc loc;
+                        if (io_loc.count(other->name))
+                            loc = io_loc.at(other->name);
+                        else if (other->bel != BelId())
+                            loc = ctx->getBelLocation(other->bel);
+                        else
+                            continue;
+                        sum_x += loc.x;
+                        sum_y += loc.y;
+                        ++count;
+                    }
+                }
+            }
+            frontier = std::move(next);
+        }
+        item.target = count > 0 ? Loc(int(sum_x / count), int(sum_y / count), 0) : fallback;
+    }
+
+    // Plan each bank voltage in turn, largest first; IOs that don't care about VCCO go last and can share any bank
+    std::map<int, std::vector<int>> items_by_vcco;
+    for (int i = 0; i < int(items.size()); i++)
+        items_by_vcco[items.at(i).vcco].push_back(i);
+    std::vector<int> vcco_order;
+    for (auto &cls : items_by_vcco)
+        if (cls.first != 0)
+            vcco_order.push_back(cls.first);
+    std::stable_sort(vcco_order.begin(), vcco_order.end(), [&](int a, int b) {
+        return items_by_vcco.at(a).size() > items_by_vcco.at(b).size();
+    });
+    if (items_by_vcco.count(0))
+        vcco_order.push_back(0);
+
+    // Clock inputs strongly prefer clock capable pins, which other IOs leave free where they can
+    const int64_t clock_penalty = 100000, ccio_penalty = 1000;
+    auto site_cost = [&](const IoItem &item, const IoSite &io) {
+        int64_t cost = io_dist(item.target, io.loc);
+        if (item.clock && !io.ccio)
+            cost += clock_penalty;
+        else if (!item.clock && io.ccio)
+            cost += ccio_penalty;
+        return cost;
+    };
+    auto pair_free = [&](const IoSite &io) { return io.master && io.partner != -1 && !sites.at(io.partner).used; };
+
+    for (int vcco : vcco_order) {
+        const std::vector<int> &cls = items_by_vcco.at(vcco);
+        int pairs = 0, demand = 0;
+        Loc target(0, 0, 0);
+        for (int i : cls) {
+            pairs += (items.at(i).n != nullptr) ? 1 : 0;
+            demand += (items.at(i).n != nullptr) ? 2 : 1;
+            target.x += items.at(i).target.x;
+            target.y += items.at(i).target.y;
+        }
+        target.x /= int(cls.size());
+        target.y /= int(cls.size());
+
+        // Take the nearest compatible banks, preferring those already at this voltage, until there is room
+        std::vector<int> candidates;
+        for (int b = 0; b < int(banks.size()); b++) {
+            const IoBank &bank = banks.at(b);
+            if (vcco != 0 && bank.vcco != 0 && bank.vcco != vcco)
+                continue;
+            if (vcco > 1800 && bank.hp)
+                continue;
+            candidates.push_back(b);
+        }
+        auto bank_score = [&](int b) {
+            const IoBank &bank = banks.at(b);
+            return std::make_pair((vcco != 0 && bank.vcco == vcco) ? 0 : 1,
+                                  io_dist(target, Loc(bank.x, bank.y, 0)));
+        };
+        std::stable_sort(candidates.begin(), candidates.end(),
+                         [&](int a, int b) { return bank_score(a) < bank_score(b); });
+        std::vector<int> free_sites, free_masters;
+        for (int b : candidates) {
+            if (int(free_sites.size()) >= demand && int(free_masters.size()) >= pairs)
+                break;
+            for (int s : banks.at(b).sites) {
+                if (sites.at(s).used)
+                    continue;
+                free_sites.push_back(s);
+                if (pair_free(sites.at(s)))
+                    free_masters.push_back(s);
+            }
+        }
+        if (int(free_sites.size()) < demand || int(free_masters.size()) < pairs) {
+            std::string voltage = vcco != 0 ? stringf("%.2fV", vcco / 1000.0) : std::string("any voltage");
+            log_error("IO placer ran out of available IOs for %s (%d pins and %d differential pairs to place, %d "
+                      "compatible pins and %d pairs available)\n",
+                      voltage.c_str(), demand, pairs, int(free_sites.size()), int(free_masters.size()));
+        }
+
+        // Differential pairs first, as they need both halves of a pair free
+        std::vector<int> pair_items, single_items;
+        for (int i : cls)
+            (items.at(i).n != nullptr ? pair_items : single_items).push_back(i);
+        if (!pair_items.empty()) {
+            std::vector<std::vector<int64_t>> cost;
+            for (int i : pair_items) {
+                cost.emplace_back();
+                for (int s : free_masters)
+                    cost.back().push_back(site_cost(items.at(i), sites.at(s)));
+            }
+            std::vector<int> result = solve_assignment(cost, int(free_masters.size()));
+            for (int k = 0; k < int(pair_items.size()); k++) {
+                const IoItem &item = items.at(pair_items.at(k));
+                int s = free_masters.at(result.at(k));
+                set_site(item.p, s);
+                set_site(item.n, sites.at(s).partner);
+            }
+        }
+        if (!single_items.empty()) {
+            std::vector<int> remaining;
+            for (int s : free_sites)
+                if (!sites.at(s).used)
+                    remaining.push_back(s);
+            std::vector<std::vector<int64_t>> cost;
+            for (int i : single_items) {
+                cost.emplace_back();
+                for (int s : remaining)
+                    cost.back().push_back(site_cost(items.at(i), sites.at(s)));
+            }
+            std::vector<int> result = solve_assignment(cost, int(remaining.size()));
+            for (int k = 0; k < int(single_items.size()); k++) {
+                const IoItem &item = items.at(single_items.at(k));
+                int s = remaining.at(result.at(k));
+                if (item.clock && !sites.at(s).ccio)
+                    log_warning("No clock capable pin left near clock input '%s'\n", item.p->name.c_str(ctx));
+                set_site(item.p, s);
+            }
+        }
+    }
+}
+
+NEXTPNR_NAMESPACE_END
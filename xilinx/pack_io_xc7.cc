@@ -296,7 +296,6 @@ void XC7Packer::pack_io()
     }
     flush_cells();
     std::unordered_set<BelId> used_io_bels;
-    int unconstr_io_count = 0;
     for (auto &iob : pad_and_buf) {
         CellInfo *pad = iob.first;
         // Process location constraints
@@ -322,40 +321,10 @@ void XC7Packer::pack_io()
                     pad->attrs[id_BEL] = std::string(site + "/IOB33/PAD");
             }
         }
-        if (pad->attrs.count(ctx->id("BEL"))) {
+        if (pad->attrs.count(ctx->id("BEL")))
             used_io_bels.insert(ctx->getBelByName(ctx->id(pad->attrs.at(ctx->id("BEL")).as_string())));
-        } else {
-            ++unconstr_io_count;
-        }
-    }
-    std::queue<BelId> available_io_bels;
-    IdString pad_id = ctx->xc7 ? ctx->id("PAD") : ctx->id("IOB_PAD");
-    for (auto bel : ctx->getBels()) {
-        if (int(available_io_bels.size()) >= unconstr_io_count)
-            break;
-        if (ctx->locInfo(bel).bel_data[bel.index].site_variant != 0)
-            continue;
-        if (ctx->getBelType(bel) != pad_id)
-            continue;
-        if (ctx->getBelPackagePin(bel) == ".")
-            continue;
-        if (used_io_bels.count(bel))
-            continue;
-        available_io_bels.push(bel);
-    }
-    int avail_count = int(available_io_bels.size());
-    // Constrain unconstrained IO
-    for (auto &iob : pad_and_buf) {
-        CellInfo *pad = iob.first;
-        if (!pad->attrs.count(ctx->id("BEL"))) {
-            if (available_io_bels.empty()) {
-                log_error("IO placer ran out of available IOs (%d available IO, %d unconstrained pins)\n", avail_count,
-                          unconstr_io_count);
-            }
-            pad->attrs[ctx->id("BEL")] = std::string(ctx->nameOfBel(available_io_bels.front()));
-            available_io_bels.pop();
-        }
     }
+    plan_io(pad_and_buf, used_io_bels);
     // Decompose macro IO primitives to smaller primitives that map logically to the actual IO Bels
     for (auto &iob : pad_and_buf) {
         auto pad_cell = iob.first;
@@ -20,7 +20,6 @@
 #include <algorithm>
 #include <boost/optional.hpp>
 #include <iterator>
-#include <queue>
 #include <unordered_set>
 #include "cells.h"
 #include "chain_utils.h"
@@ -473,7 +472,6 @@ void USPacker::pack_io()
     }
     flush_cells();
     std::unordered_set<BelId> used_io_bels;
-    int unconstr_io_count = 0;
     for (auto &iob : pad_and_buf) {
         CellInfo *pad = iob.first;
         // Process location constraints
@@ -486,33 +484,10 @@ void USPacker::pack_io()
             log_info("    Constraining '%s' to site '%s'\n", pad->name.c_str(ctx), site.c_str());
             pad->attrs[ctx->id("BEL")] = std::string(site + "/PAD");
         }
-        if (pad->attrs.count(ctx->id("BEL"))) {
+        if (pad->attrs.count(ctx->id("BEL")))
             used_io_bels.insert(ctx->getBelByName(ctx->id(pad->attrs.at(ctx->id("BEL")).as_string())));
-        } else {
-            ++unconstr_io_count;
-        }
-    }
-    std::queue<BelId> available_io_bels;
-    IdString pad_id = ctx->id("IOB_PAD");
-    for (auto bel : ctx->getBels()) {
-        if (int(available_io_bels.size()) >= unconstr_io_count)
-            break;
-        if (ctx->getBelType(bel) != pad_id)
-            continue;
-        if (ctx->getBelPackagePin(bel) == ".")
-            continue;
-        if (used_io_bels.count(bel))
-            continue;
-        available_io_bels.push(bel);
-    }
-    // Constrain unconstrained IO
-    for (auto &iob : pad_and_buf) {
-        CellInfo *pad = iob.first;
-        if (!pad->attrs.count(ctx->id("BEL"))) {
-            pad->attrs[ctx->id("BEL")] = std::string(ctx->nameOfBel(available_io_bels.front()));
-            available_io_bels.pop();
-        }
     }
+    plan_io(pad_and_buf, used_io_bels);
     // Decompose macro IO primitives to smaller primitives that map logically to the actual IO Bels
     for (auto &iob : pad_and_buf) {
         if (packed_cells.count(iob.second.cell->name))
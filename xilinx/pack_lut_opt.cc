@@ -0,0 +1,372 @@
+/*
+ *  nextpnr -- Next Generation Place and Route
+ *
+ *  Copyright (C) 2026  agent <agent@local>
+ *
+ *  Permission to use, copy, modify, and/or distribute this software for any
+ *  purpose with or without fee is hereby granted, provided that the above
+ *  copyright notice and this permission notice appear in all copies.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ *  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ *  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ *  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ *  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ *  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ *  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ */
+
+#include <algorithm>
+#include "design_utils.h"
+#include "log.h"
+#include "nextpnr.h"
+#include "pack.h"
+#include "util.h"
+
+NEXTPNR_NAMESPACE_BEGIN
+
+namespace {
+// A LUT function of up to 6 inputs; bit i of tt is the output when input j has the value of bit j of i
+struct LutFunc
+{
+    std::vector<NetInfo *> inputs;
+    uint64_t tt = 0;
+};
+
+// Whether an inverter driving a pin can be absorbed into its IS_<pin>_INVERTED parameter. This is only the case for
+// pins where the parameter survives packing and is written to the bitstream; others in invertible_pins, such as SRL
+// CLK (not carried over by packing) or BUFGCE I (no FASM feature), would silently lose the inversion
+bool inversion_absorbable(const Context *ctx, const PortRef &usr)
+{
+    const std::string &type = usr.cell->type.str(ctx), &port = usr.port.str(ctx);
+    if (type == "FDRE" || type == "FDSE" || type == "FDCE" || type == "FDPE")
+        return port == "C";
+    if (type == "BUFGCTRL")
+        return port == "CE0" || port == "CE1" || port == "S0" || port == "S1";
+    if (type == "RAMB18E1" || type == "RAMB36E1")
+        return port == "CLKARDCLK" || port == "CLKBWRCLK" || port == "ENARDEN" || port == "ENBWREN" ||
+               port == "RSTRAMARSTRAM" || port == "RSTRAMB" || port == "RSTREGARSTREG" || port == "RSTREGB";
+    return false;
+}
+
+uint64_t tt_mask(int k) { return (k >= 6) ? ~uint64_t(0) : ((uint64_t(1) << (1 << k)) - 1); }
+
+// Re-express f over new_inputs. For each old input, src gives the index of the new input that drives it, or -1/-2
+// for constant 0/1
+uint64_t remap_tt(const LutFunc &f, const std::vector<int> &src, int new_k)
+{
+    uint64_t result = 0;
+    for (int m = 0; m < (1 << new_k); m++) {
+        int old_idx = 0;
+        for (int i = 0; i < int(f.inputs.size()); i++) {
+            bool bit = (src.at(i) >= 0) ? ((m >> src.at(i)) & 1) : (src.at(i) == -2);
+            if (bit)
+                old_idx |= (1 << i);
+        }
+        if ((f.tt >> old_idx) & 1)
+            result |= (uint64_t(1) << m);
+    }
+    return result;
+}
+
+bool depends_on(const LutFunc &f, int input)
+{
+    int k = int(f.inputs.size());
+    for (int m = 0; m < (1 << k); m++) {
+        if (m & (1 << input))
+            continue;
+        if (((f.tt >> m) & 1) != ((f.tt >> (m | (1 << input))) & 1))
+            return true;
+    }
+    return false;
+}
+
+uint64_t lut_init(const Context *ctx, const CellInfo *ci)
+{
+    auto found = ci->params.find(ctx->id("INIT"));
+    return (found == ci->params.end()) ? 0 : uint64_t(found->second.as_int64());
+}
+} // namespace
+
+bool XilinxPacker::lut_opt_fixed(const CellInfo *ci)
+{
+    return ci->attrs.count(ctx->id("keep")) || ci->attrs.count(ctx->id("DONT_TOUCH")) ||
+           ci->attrs.count(ctx->id("dont_touch"));
+}
+
+bool XilinxPacker::lut_opt_fixed(const NetInfo *ni)
+{
+    if (ni->attrs.count(ctx->id("keep")) || ni->attrs.count(ctx->id("DONT_TOUCH")) ||
+        ni->attrs.count(ctx->id("dont_touch")))
+        return true;
+    // Nets connected to top level IO are left to the IO packer
+    auto is_io = [&](const CellInfo *ci) {
+        return ci != nullptr && (ci->type == ctx->id("$nextpnr_ibuf") || ci->type == ctx->id("$nextpnr_obuf") ||
+                                 ci->type == ctx->id("$nextpnr_iobuf"));
+    };
+    if (is_io(ni->driver.cell))
+        return true;
+    for (auto &usr : ni->users)
+        if (is_io(usr.cell))
+            return true;
+    return false;
+}
+
+int XilinxPacker::lut_opt_width(const CellInfo *ci)
+{
+    const std::string &type = ci->type.str(ctx);
+    if (type.size() != 4 || type.compare(0, 3, "LUT") != 0 || type[3] < '1' || type[3] > '6')
+        return -1;
+    int k = type[3] - '0';
+    auto init = ci->params.find(ctx->id("INIT"));
+    if (init != ci->params.end() && init->second.is_string)
+        return -1;
+    for (int i = 0; i < k; i++) {
+        // LUTs with floating inputs are left alone
+        const NetInfo *ni = get_net_or_empty(ci, ctx->id("I" + std::to_string(i)));
+        if (ni == nullptr || ni->driver.cell == nullptr)
+            return -1;
+    }
+    return k;
+}
+
+bool XilinxPacker::optimise_lut(CellInfo *ci, const std::vector<NetInfo *> &inputs, uint64_t tt)
+{
+    NetInfo *gnd = ctx->nets.at(ctx->id("$PACKER_GND_NET")).get();
+    NetInfo *vcc = ctx->nets.at(ctx->id("$PACKER_VCC_NET")).get();
+
+    LutFunc f;
+    f.inputs = inputs;
+    f.tt = tt & tt_mask(int(inputs.size()));
+    // Fold constant and repeated inputs
+    std::vector<int> src;
+    std::vector<NetInfo *> new_inputs;
+    for (auto ni : f.inputs) {
+        if (ni == gnd) {
+            src.push_back(-1);
+        } else if (ni == vcc) {
+            src.push_back(-2);
+        } else {
+            auto found = std::find(new_inputs.begin(), new_inputs.end(), ni);
+            src.push_back(int(found - new_inputs.begin()));
+            if (found == new_inputs.end())
+                new_inputs.push_back(ni);
+        }
+    }
+    f.tt = remap_tt(f, src, int(new_inputs.size()));
+    f.inputs = new_inputs;
+    // Remove inputs that the function does not depend on
+    for (int i = int(f.inputs.size()) - 1; i >= 0; i--) {
+        if (depends_on(f, i))
+            continue;
+        src.clear();
+        for (int j = 0; j < int(f.inputs.size()); j++)
+            src.push_back(j == i ? -1 : (j > i ? j - 1 : j));
+        f.tt = remap_tt(f, src, int(f.inputs.size()) - 1);
+        f.inputs.erase(f.inputs.begin() + i);
+    }
+
+    int old_k = lut_opt_width(ci);
+    bool changed = (old_k != int(f.inputs.size())) || (lut_init(ctx, ci) & tt_mask(old_k)) != f.tt;
+    for (int i = 0; !changed && i < old_k; i++)
+        changed = get_net_or_empty(ci, ctx->id("I" + std::to_string(i))) != f.inputs.at(i);
+    if (!changed)
+        return false;
+
+    for (int i = 0; i < 6; i++) {
+        IdString port = ctx->id("I" + std::to_string(i));
+        disconnect_port(ctx, ci, port);
+        ci->ports.erase(port);
+    }
+
+    if (f.inputs.empty()) {
+        // Constant output; the cell itself is removed by the caller once its users have been moved
+        ci->type = ctx->id("LUT1");
+        ci->ports[ctx->id("I0")].name = ctx->id("I0");
+        ci->ports[ctx->id("I0")].type = PORT_IN;
+        connect_port(ctx, gnd, ci, ctx->id("I0"));
+        ci->params[ctx->id("INIT")] = Property((f.tt & 1) ? 3 : 0, 2);
+        return true;
+    }
+
+    int k = int(f.inputs.size());
+    ci->type = ctx->id("LUT" + std::to_string(k));
+    for (int i = 0; i < k; i++) {
+        IdString port = ctx->id("I" + std::to_string(i));
+        ci->ports[port].name = port;
+        ci->ports[port].type = PORT_IN;
+        connect_port(ctx, f.inputs.at(i), ci, port);
+    }
+    ci->params[ctx->id("INIT")] = Property(f.tt, 1 << k);
+    return true;
+}
+
+void XilinxPacker::optimise_luts()
+{
+    if (ctx->setting<bool>("xilinx/noLutOpt", false))
+        return;
+    log_info("Optimising LUTs..\n");
+
+    NetInfo *gnd = ctx->nets.at(ctx->id("$PACKER_GND_NET")).get();
+    NetInfo *vcc = ctx->nets.at(ctx->id("$PACKER_VCC_NET")).get();
+    int initial_luts = 0, const_folded = 0, buffers = 0, inverters = 0, merged = 0;
+    for (auto cell : sorted(ctx->cells))
+        if (lut_opt_width(cell.second) != -1)
+            ++initial_luts;
+
+    auto lut_inputs = [&](CellInfo *ci) {
+        std::vector<NetInfo *> inputs;
+        for (int i = 0; i < lut_opt_width(ci); i++)
+            inputs.push_back(get_net_or_empty(ci, ctx->id("I" + std::to_string(i))));
+        return inputs;
+    };
+
+    // Move all users of a LUT output to another net, as the LUT is about to be removed
+    auto move_users = [&](NetInfo *from, NetInfo *to, bool invert) {
+        std::vector<PortRef> users = from->users;
+        for (auto &usr : users) {
+            disconnect_port(ctx, usr.cell, usr.port);
+            if (invert) {
+                IdString param = ctx->id("IS_" + usr.port.str(ctx) + "_INVERTED");
+                usr.cell->params[param] = Property(bool_or_default(usr.cell->params, param, false) ? 0 : 1);
+            }
+            connect_port(ctx, to, usr.cell, usr.port);
+        }
+    };
+
+    auto is_invertible = [&](const PortRef &usr) {
+        return invertible_pins.count(usr.cell->type) && invertible_pins.at(usr.cell->type).count(usr.port);
+    };
+    auto can_absorb_inverter = [&](const PortRef &usr) {
+        return is_invertible(usr) && inversion_absorbable(ctx, usr);
+    };
+
+    std::vector<IdString> dead_nets;
+    bool changed = true;
+    while (changed) {
+        changed = false;
+        for (auto cell : sorted(ctx->cells)) {
+            CellInfo *ci = cell.second;
+            if (packed_cells.count(ci->name) || lut_opt_fixed(ci))
+                continue;
+            int k = lut_opt_width(ci);
+            if (k == -1)
+                continue;
+            NetInfo *o = get_net_or_empty(ci, ctx->id("O"));
+            if (o == nullptr || lut_opt_fixed(o))
+                continue;
+
+            // Constant propagation and removal of redundant inputs
+            if (optimise_lut(ci, lut_inputs(ci), lut_init(ctx, ci))) {
+                changed = true;
+                ++const_folded;
+                k = lut_opt_width(ci);
+            }
+            uint64_t init = lut_init(ctx, ci) & tt_mask(k);
+            NetInfo *i0 = get_net_or_empty(ci, ctx->id("I0"));
+
+            if (k == 1 && i0 == gnd) {
+                // Constant driver
+                bool value = (init & 1);
+                std::vector<PortRef> users = o->users;
+                for (auto &usr : users) {
+                    disconnect_port(ctx, usr.cell, usr.port);
+                    bool cval = value;
+                    if (is_invertible(usr)) {
+                        // As in pack_constants, invertible pins are tied to Vcc (which is easier to route) with the
+                        // inversion chosen to give the same value
+                        IdString param = ctx->id("IS_" + usr.port.str(ctx) + "_INVERTED");
+                        bool inv = bool_or_default(usr.cell->params, param, false);
+                        usr.cell->params[param] = Property((value != inv) ? 0 : 1);
+                        cval = true;
+                    }
+                    connect_port(ctx, cval ? vcc : gnd, usr.cell, usr.port);
+                }
+                packed_cells.insert(ci->name);
+                dead_nets.push_back(o->name);
+                changed = true;
+                continue;
+            }
+
+            if (k == 1 && init == 0x2) {
+                // Identity LUT
+                move_users(o, i0, false);
+                packed_cells.insert(ci->name);
+                dead_nets.push_back(o->name);
+                ++buffers;
+                changed = true;
+                continue;
+            }
+
+            if (k == 1 && init == 0x1 && !o->users.empty() &&
+                std::all_of(o->users.begin(), o->users.end(), can_absorb_inverter)) {
+                // Inverter feeding only pins with programmable inversion
+                move_users(o, i0, true);
+                packed_cells.insert(ci->name);
+                dead_nets.push_back(o->name);
+                ++inverters;
+                changed = true;
+                continue;
+            }
+
+            if (o->users.size() != 1)
+                continue;
+            CellInfo *next = o->users.at(0).cell;
+            if (next == ci || packed_cells.count(next->name) || lut_opt_fixed(next))
+                continue;
+            int next_k = lut_opt_width(next);
+            if (next_k == -1)
+                continue;
+            // Merge this LUT into the single LUT that it drives, if the combined function still fits in a LUT6
+            std::vector<NetInfo *> inputs = lut_inputs(ci), next_inputs = lut_inputs(next), new_inputs;
+            for (auto ni : inputs)
+                if (std::find(new_inputs.begin(), new_inputs.end(), ni) == new_inputs.end())
+                    new_inputs.push_back(ni);
+            for (auto ni : next_inputs)
+                if (ni != o && std::find(new_inputs.begin(), new_inputs.end(), ni) == new_inputs.end())
+                    new_inputs.push_back(ni);
+            if (new_inputs.size() > 6 || std::find(inputs.begin(), inputs.end(), o) != inputs.end() ||
+                std::find(new_inputs.begin(), new_inputs.end(), get_net_or_empty(next, ctx->id("O"))) !=
+                        new_inputs.end())
+                continue;
+            uint64_t next_init = lut_init(ctx, next);
+            uint64_t new_tt = 0;
+            for (int m = 0; m < (1 << int(new_inputs.size())); m++) {
+                auto value = [&](NetInfo *ni) {
+                    return bool((m >> (std::find(new_inputs.begin(), new_inputs.end(), ni) - new_inputs.begin())) & 1);
+                };
+                int idx = 0;
+                for (int i = 0; i < k; i++)
+                    if (value(inputs.at(i)))
+                        idx |= (1 << i);
+                bool inner = (init >> idx) & 1;
+                int next_idx = 0;
+                for (int i = 0; i < next_k; i++)
+                    if (next_inputs.at(i) == o ? inner : value(next_inputs.at(i)))
+                        next_idx |= (1 << i);
+                if ((next_init >> next_idx) & 1)
+                    new_tt |= (uint64_t(1) << m);
+            }
+            optimise_lut(next, new_inputs, new_tt);
+            packed_cells.insert(ci->name);
+            dead_nets.push_back(o->name);
+            ++merged;
+            changed = true;
+        }
+        flush_cells();
+        for (auto dn : dead_nets)
+            ctx->nets.erase(dn);
+        dead_nets.clear();
+    }
+
+    int final_luts = 0;
+    for (auto cell : sorted(ctx->cells))
+        if (lut_opt_width(cell.second) != -1)
+            ++final_luts;
+    log_info("    %d LUTs simplified, %d buffers removed, %d inverters absorbed, %d LUTs merged\n", const_folded,
+             buffers, inverters, merged);
+    log_info("    %d LUTs before optimisation, %d after\n", initial_luts, final_luts);
+}
+
+NEXTPNR_NAMESPACE_END
@@ -0,0 +1,135 @@
+/*
+ *  nextpnr -- Next Generation Place and Route
+ *
+ *  Copyright (C) 2026  agent <agent@local>
+ *
+ *  Permission to use, copy, modify, and/or distribute this software for any
+ *  purpose with or without fee is hereby granted, provided that the above
+ *  copyright notice and this permission notice appear in all copies.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ *  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ *  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ *  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ *  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ *  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ *  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ */
+
+#include <algorithm>
+#include <thread>
+#include "log.h"
+#include "nextpnr.h"
+#include "pack.h"
+#include "pins.h"
+#include "util.h"
+
+NEXTPNR_NAMESPACE_BEGIN
+
+namespace {
+// Returns an empty string if the value is accepted, otherwise a description of what is wrong with it
+std::string check_value(const Property &value, const ParamSchema &schema)
+{
+    switch (schema.kind) {
+    case ParamSchema::BITS: {
+        if (value.is_string)
+            return stringf("expected a %d-bit vector, got string '%s'", schema.width, value.str.c_str());
+        for (int w = schema.width / 64; w < value.num_words(); w++) {
+            uint64_t set = value.value_word(w) & ~value.undef_word(w);
+            if (w == schema.width / 64)
+                set &= ~((uint64_t(1) << (schema.width % 64)) - 1);
+            if (set != 0)
+                return stringf("has bits set beyond its width of %d", schema.width);
+        }
+        return "";
+    }
+    case ParamSchema::RANGE: {
+        int64_t number;
+        if (value.is_string) {
+            char *end = nullptr;
+            number = std::strtoll(value.str.c_str(), &end, 10);
+            if (value.str.empty() || *end != '\0')
+                return stringf("expected an integer, got '%s'", value.str.c_str());
+        } else {
+            if (!value.is_fully_def())
+                return "has undefined bits";
+            number = value.as_int64();
+        }
+        if (number < schema.min || number > schema.max)
+            return stringf("value %lld is outside the range %lld..%lld", (long long)number, (long long)schema.min,
+                           (long long)schema.max);
+        return "";
+    }
+    case ParamSchema::ENUM: {
+        std::string str = value.is_string ? value.str : std::to_string(value.as_int64());
+        if (std::find(schema.values.begin(), schema.values.end(), str) != schema.values.end())
+            return "";
+        std::string allowed;
+        for (auto &v : schema.values)
+            allowed += (allowed.empty() ? "" : ", ") + v;
+        return stringf("value '%s' is not one of %s", str.c_str(), allowed.c_str());
+    }
+    }
+    return "";
+}
+} // namespace
+
+void XilinxPacker::validate_params()
+{
+    log_info("Validating cell parameters..\n");
+    std::unordered_map<IdString, std::unordered_map<IdString, ParamSchema>> schemas;
+    get_param_schemas(ctx, schemas);
+
+    // Find the schema of every cell up front, as interning names isn't thread safe; the checks themselves only read
+    // the netlist
+    std::vector<std::pair<const CellInfo *, const std::unordered_map<IdString, ParamSchema> *>> to_check;
+    IdString pad_type = ctx->id("PAD");
+    for (auto cell : sorted(ctx->cells)) {
+        const CellInfo *ci = cell.second;
+        IdString type = (ci->type == pad_type) ? pad_type : ctx->id(str_or_default(ci->attrs, id_X_ORIG_TYPE, ""));
+        auto found = schemas.find(type);
+        if (found != schemas.end())
+            to_check.emplace_back(ci, &found->second);
+    }
+
+    std::vector<std::vector<std::string>> violations(to_check.size());
+    int max_threads =
+            ctx->setting<int>("xilinx/validateThreads", std::max<int>(1, std::thread::hardware_concurrency()));
+    // Small designs aren't worth starting threads for
+    int nthreads = std::max(1, std::min(max_threads, int(to_check.size()) / 1000 + 1));
+    std::vector<std::thread> workers;
+    for (int t = 0; t < nthreads; t++)
+        workers.emplace_back([&, t]() {
+            for (size_t i = t; i < to_check.size(); i += nthreads) {
+                const CellInfo *ci = to_check.at(i).first;
+                // IO settings are attributes of the pad, everything else is a parameter
+                const auto &values = (ci->type == pad_type) ? ci->attrs : ci->params;
+                for (auto &value : values) {
+                    auto schema = to_check.at(i).second->find(value.first);
+                    if (schema == to_check.at(i).second->end())
+                        continue;
+                    std::string error = check_value(value.second, schema->second);
+                    if (!error.empty())
+                        violations.at(i).push_back(stringf("%s '%s' of cell '%s' %s",
+                                                           ci->type == pad_type ? "attribute" : "parameter",
+                                                           value.first.c_str(ctx), ctx->nameOf(ci), error.c_str()));
+                }
+            }
+        });
+    for (auto &th : workers)
+        th.join();
+
+    int count = 0;
+    for (auto &cell_violations : violations) {
+        std::sort(cell_violations.begin(), cell_violations.end());
+        for (auto &v : cell_violations) {
+            log_nonfatal_error("%s\n", v.c_str());
+            ++count;
+        }
+    }
+    if (count > 0)
+        log_error("found %d invalid cell parameter%s\n", count, count == 1 ? "" : "s");
+}
+
+NEXTPNR_NAMESPACE_END
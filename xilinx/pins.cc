@@ -19,7 +19,9 @@
 
 #include <set>
 
+#include "log.h"
 #include "nextpnr.h"
+#include "pins.h"
 
 NEXTPNR_NAMESPACE_BEGIN
 
@@ -733,4 +735,168 @@ void get_top_level_pins(Context *ctx, std::unordered_map<IdString, std::unordere
     toplevel_pins[ctx->id("OBUFTDS")] = {ctx->id("O"), ctx->id("OB")};
 }
 
+void get_param_schemas(Context *ctx, std::unordered_map<IdString, std::unordered_map<IdString, ParamSchema>> &schemas)
+{
+    // Parameters of the original primitives that the bitstream backends interpret, and the values they accept.
+    // Parameters not listed here aren't checked. PAD cells are checked against their IO attributes instead
+    auto bits = [&](const std::string &type, const std::string &param, int width) {
+        ParamSchema &s = schemas[ctx->id(type)][ctx->id(param)];
+        s.kind = ParamSchema::BITS;
+        s.width = width;
+    };
+    auto range = [&](const std::string &type, const std::string &param, int64_t min, int64_t max) {
+        ParamSchema &s = schemas[ctx->id(type)][ctx->id(param)];
+        s.kind = ParamSchema::RANGE;
+        s.min = min;
+        s.max = max;
+    };
+    auto one_of = [&](const std::string &type, const std::string &param, const std::vector<std::string> &values) {
+        ParamSchema &s = schemas[ctx->id(type)][ctx->id(param)];
+        s.kind = ParamSchema::ENUM;
+        s.values = values;
+    };
+
+    // Inversion of any invertible pin is a single bit
+    std::unordered_map<IdString, std::unordered_set<IdString>> invertible_pins;
+    get_invertible_pins(ctx, invertible_pins);
+    for (auto &type : invertible_pins)
+        for (auto pin : type.second)
+            if (pin.str(ctx).find('[') == std::string::npos)
+                bits(type.first.str(ctx), "IS_" + pin.str(ctx) + "_INVERTED", 1);
+
+    // LUTs and shift registers
+    for (int k = 1; k <= 6; k++)
+        bits("LUT" + std::to_string(k), "INIT", 1 << k);
+    bits("LUT6_2", "INIT", 64);
+    bits("SRL16E", "INIT", 16);
+    bits("SRLC32E", "INIT", 32);
+    bits("CFGLUT5", "INIT", 32);
+
+    // Flipflops and latches
+    for (auto type : {"FDRE", "FDSE", "FDCE", "FDPE", "LDCE", "LDPE"})
+        bits(type, "INIT", 1);
+
+    // Block RAM. The widest data width is only available in simple dual port mode, on read port A and write port B
+    for (std::string type : {"RAMB18E1", "RAMB36E1", "RAMB18E2", "RAMB36E2", "FIFO18E2", "FIFO36E2"}) {
+        bool is_36 = type.find("36") != std::string::npos, is_fifo = type.compare(0, 4, "FIFO") == 0;
+        std::vector<std::string> widths{"0", "1", "2", "4", "9", "18"};
+        if (is_36)
+            widths.push_back("36");
+        std::vector<std::string> sdp_widths = widths;
+        sdp_widths.push_back(is_36 ? "72" : "36");
+        if (is_fifo) {
+            one_of(type, "READ_WIDTH", sdp_widths);
+            one_of(type, "WRITE_WIDTH", sdp_widths);
+            one_of(type, "REGISTER_MODE", {"UNREGISTERED", "REGISTERED", "DO_PIPELINED"});
+            one_of(type, "CLOCK_DOMAINS", {"INDEPENDENT", "COMMON"});
+            continue;
+        }
+        one_of(type, "READ_WIDTH_A", sdp_widths);
+        one_of(type, "READ_WIDTH_B", widths);
+        one_of(type, "WRITE_WIDTH_A", widths);
+        one_of(type, "WRITE_WIDTH_B", sdp_widths);
+        one_of(type, "WRITE_MODE_A", {"WRITE_FIRST", "READ_FIRST", "NO_CHANGE"});
+        one_of(type, "WRITE_MODE_B", {"WRITE_FIRST", "READ_FIRST", "NO_CHANGE"});
+        range(type, "DOA_REG", 0, 1);
+        range(type, "DOB_REG", 0, 1);
+        for (int i = 0; i < (is_36 ? 128 : 64); i++)
+            bits(type, stringf("INIT_%02X", i), 256);
+        for (int i = 0; i < (is_36 ? 16 : 8); i++)
+            bits(type, stringf("INITP_%02X", i), 256);
+        for (auto param : {"INIT_A", "INIT_B", "SRVAL_A", "SRVAL_B"})
+            bits(type, param, is_36 ? 36 : 18);
+        if (type.back() == '1') {
+            one_of(type, "RAM_MODE", {"TDP", "SDP"});
+        } else {
+            one_of(type, "CLOCK_DOMAINS", {"INDEPENDENT", "COMMON"});
+            one_of(type, "CASCADE_ORDER_A", {"NONE", "FIRST", "MIDDLE", "LAST"});
+            one_of(type, "CASCADE_ORDER_B", {"NONE", "FIRST", "MIDDLE", "LAST"});
+        }
+    }
+    for (auto param : {"CASCADE_ORDER_A", "CASCADE_ORDER_B"})
+        one_of("URAM288", param, {"NONE", "FIRST", "MIDDLE", "LAST"});
+    for (auto param : {"IREG_PRE_A", "IREG_PRE_B", "OREG_A", "OREG_B", "OREG_ECC_A", "OREG_ECC_B"})
+        one_of("URAM288", param, {"TRUE", "FALSE"});
+
+    // DSPs
+    for (std::string type : {"DSP48E1", "DSP48E2"}) {
+        for (auto param : {"AREG", "BREG", "ACASCREG", "BCASCREG"})
+            range(type, param, 0, 2);
+        for (auto param : {"CREG", "MREG", "PREG", "DREG", "ADREG", "ALUMODEREG", "CARRYINREG", "CARRYINSELREG",
+                           "INMODEREG", "OPMODEREG"})
+            range(type, param, 0, 1);
+        one_of(type, "A_INPUT", {"DIRECT", "CASCADE"});
+        one_of(type, "B_INPUT", {"DIRECT", "CASCADE"});
+        one_of(type, "USE_MULT", {"NONE", "MULTIPLY", "DYNAMIC"});
+        one_of(type, "USE_SIMD", {"ONE48", "TWO24", "FOUR12"});
+        one_of(type, "USE_PATTERN_DETECT", {"NO_PATDET", "PATDET"});
+        one_of(type, "SEL_MASK", {"MASK", "C", "ROUNDING_MODE1", "ROUNDING_MODE2"});
+        one_of(type, "SEL_PATTERN", {"PATTERN", "C"});
+        one_of(type, "AUTORESET_PATDET", {"NO_RESET", "RESET_MATCH", "RESET_NOT_MATCH"});
+        bits(type, "MASK", 48);
+        bits(type, "PATTERN", 48);
+    }
+    one_of("DSP48E1", "USE_DPORT", {"TRUE", "FALSE"});
+    one_of("DSP48E2", "AMULTSEL", {"A", "AD"});
+    one_of("DSP48E2", "BMULTSEL", {"B", "AD"});
+    one_of("DSP48E2", "PREADDINSEL", {"A", "B"});
+    one_of("DSP48E2", "USE_WIDEXOR", {"TRUE", "FALSE"});
+    one_of("DSP48E2", "XORSIMD", {"XOR24_48_96", "XOR12"});
+    bits("DSP48E2", "RND", 48);
+    bits("DSP48E2", "IS_ALUMODE_INVERTED", 4);
+    bits("DSP48E2", "IS_INMODE_INVERTED", 5);
+    bits("DSP48E2", "IS_OPMODE_INVERTED", 9);
+
+    // Clocking
+    for (std::string type : {"MMCME2_ADV", "MMCME2_BASE", "PLLE2_ADV", "PLLE2_BASE"}) {
+        bool is_pll = type.compare(0, 3, "PLL") == 0;
+        range(type, "DIVCLK_DIVIDE", 1, is_pll ? 56 : 106);
+        one_of(type, "BANDWIDTH", {"OPTIMIZED", "HIGH", "LOW"});
+        one_of(type, "COMPENSATION", {"ZHOLD", "EXTERNAL", "INTERNAL", "BUF_IN"});
+        for (int i = is_pll ? 0 : 1; i < (is_pll ? 6 : 7); i++)
+            range(type, "CLKOUT" + std::to_string(i) + "_DIVIDE", 1, 128);
+        if (is_pll)
+            range(type, "CLKFBOUT_MULT", 2, 64);
+    }
+
+    // IO logic
+    one_of("ODDR", "DDR_CLK_EDGE", {"OPPOSITE_EDGE", "SAME_EDGE"});
+    one_of("ODDR", "SRTYPE", {"SYNC", "ASYNC"});
+    bits("ODDR", "INIT", 1);
+    one_of("IDDR", "DDR_CLK_EDGE", {"OPPOSITE_EDGE", "SAME_EDGE", "SAME_EDGE_PIPELINED"});
+    one_of("IDDR", "SRTYPE", {"SYNC", "ASYNC"});
+    bits("IDDR", "INIT_Q1", 1);
+    bits("IDDR", "INIT_Q2", 1);
+    one_of("OSERDESE2", "DATA_RATE_OQ", {"SDR", "DDR"});
+    one_of("OSERDESE2", "DATA_RATE_TQ", {"BUF", "SDR", "DDR"});
+    one_of("OSERDESE2", "DATA_WIDTH", {"1", "2", "3", "4", "5", "6", "7", "8", "10", "14"});
+    one_of("ISERDESE2", "DATA_RATE", {"SDR", "DDR"});
+    one_of("ISERDESE2", "DATA_WIDTH", {"2", "3", "4", "5", "6", "7", "8", "10", "14"});
+    one_of("ISERDESE2", "INTERFACE_TYPE", {"MEMORY", "MEMORY_DDR3", "MEMORY_QDR", "NETWORKING", "OVERSAMPLE"});
+    one_of("ISERDESE2", "IOBDELAY", {"NONE", "BOTH", "IBUF", "IFD"});
+    one_of("ISERDESE2", "SERDES_MODE", {"MASTER", "SLAVE"});
+    range("ISERDESE2", "NUM_CE", 1, 2);
+    range("IDELAYE2", "IDELAY_VALUE", 0, 31);
+    one_of("IDELAYE2", "IDELAY_TYPE", {"FIXED", "VARIABLE", "VAR_LOAD", "VAR_LOAD_PIPE"});
+    one_of("IDELAYE2", "DELAY_SRC", {"IDATAIN", "DATAIN"});
+    range("ODELAYE2", "ODELAY_VALUE", 0, 31);
+    one_of("ODELAYE2", "ODELAY_TYPE", {"FIXED", "VARIABLE", "VAR_LOAD", "VAR_LOAD_PIPE"});
+
+    // Configuration
+    range("BSCANE2", "JTAG_CHAIN", 1, 4);
+    one_of("ICAPE2", "ICAP_WIDTH", {"X32", "X16", "X8"});
+    one_of("STARTUPE2", "PROG_USR", {"TRUE", "FALSE"});
+
+    // IO attributes, as supported by the xc7 FASM backend
+    if (ctx->xc7) {
+        one_of("PAD", "IOSTANDARD",
+               {"LVCMOS12", "LVCMOS15", "LVCMOS18", "LVCMOS25", "LVCMOS33", "LVTTL", "SSTL12", "SSTL135", "SSTL15",
+                "DIFF_SSTL12", "DIFF_SSTL135", "DIFF_SSTL15", "LVDS", "LVDS_25", "TMDS_33"});
+        one_of("PAD", "DRIVE", {"2", "4", "6", "8", "12", "16", "24"});
+        one_of("PAD", "SLEW", {"SLOW", "FAST"});
+        one_of("PAD", "PULLTYPE", {"NONE", "PULLUP", "PULLDOWN", "KEEPER"});
+        one_of("PAD", "IN_TERM", {"NONE", "UNTUNED_SPLIT_40", "UNTUNED_SPLIT_50", "UNTUNED_SPLIT_60"});
+    }
+}
+
 NEXTPNR_NAMESPACE_END
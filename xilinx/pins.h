@@ -29,6 +29,21 @@ void get_tied_pins(Context *ctx, std::unordered_map<IdString, std::unordered_map
 void get_bram36_ul_pins(Context *ctx, std::vector<std::pair<IdString, std::vector<std::string>>> &ul_pins);
 void get_top_level_pins(Context *ctx, std::unordered_map<IdString, std::unordered_set<IdString>> &toplevel_pins);
 
+// The values accepted for a primitive parameter
+struct ParamSchema
+{
+    enum Kind
+    {
+        BITS,  // a bit vector of at most width bits
+        RANGE, // an integer between min and max
+        ENUM   // one of values
+    } kind;
+    int width = 0;
+    int64_t min = 0, max = 0;
+    std::vector<std::string> values;
+};
+void get_param_schemas(Context *ctx, std::unordered_map<IdString, std::unordered_map<IdString, ParamSchema>> &schemas);
+
 NEXTPNR_NAMESPACE_END
 
 #endif
\ No newline at end of file
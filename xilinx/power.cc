@@ -0,0 +1,513 @@
+/*
+ *  nextpnr -- Next Generation Place and Route
+ *
+ *  Copyright (C) 2026  agent <agent@local>
+ *
+ *  Permission to use, copy, modify, and/or distribute this software for any
+ *  purpose with or without fee is hereby granted, provided that the above
+ *  copyright notice and this permission notice appear in all copies.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ *  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ *  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ *  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ *  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ *  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ *  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ */
+
+#include <algorithm>
+#include <boost/algorithm/string.hpp>
+#include <fstream>
+#include <map>
+#include <queue>
+#include "log.h"
+#include "nextpnr.h"
+#include "util.h"
+
+NEXTPNR_NAMESPACE_BEGIN
+
+// Dynamic power is estimated as 0.5 * C * V^2 * f * toggles per cycle for every net, with the activity of each net
+// propagated from its drivers and the capacitance taken from its routing. The coefficients are rough figures for
+// 28nm/20nm fabric at 1.0V and are only meant for comparing implementations of the same design, not for signoff
+
+namespace {
+// Capacitance in fF of one routing wire, by its intent
+double wire_capacitance(int32_t intent)
+{
+    switch (intent) {
+    case ID_NODE_SINGLE:
+        return 3.0;
+    case ID_NODE_DOUBLE:
+        return 5.0;
+    case ID_NODE_HQUAD:
+    case ID_NODE_VQUAD:
+        return 9.0;
+    case ID_NODE_HLONG:
+    case ID_NODE_VLONG:
+        return 20.0;
+    case ID_NODE_GLOBAL_BUFG:
+    case ID_NODE_GLOBAL_HROUTE:
+    case ID_NODE_GLOBAL_VROUTE:
+    case ID_NODE_GLOBAL_HDISTR:
+    case ID_NODE_GLOBAL_VDISTR:
+    case ID_NODE_GLOBAL_LEAF:
+        return 30.0;
+    case ID_NODE_LAGUNA_DATA:
+        return 40.0;
+    default:
+        return 1.0;
+    }
+}
+
+// Load of each sink pin, and of each tile of estimated wirelength for nets that aren't routed, in fF
+const double pin_capacitance = 1.5;
+const double unrouted_tile_capacitance = 4.0;
+// Capacitance switched inside a LUT, mux or carry output, and inside a flipflop, per output toggle, in fF
+const double logic_capacitance = 3.0;
+const double ff_capacitance = 2.0;
+// Block RAM and DSP power per MHz at full enable/default activity, in uW
+const double bram36_uw_per_mhz = 28.0, bram18_uw_per_mhz = 14.0, uram_uw_per_mhz = 60.0, dsp_uw_per_mhz = 6.0;
+
+bool is_clock_buffer(const std::string &type)
+{
+    return type.compare(0, 4, "BUFG") == 0 || type.compare(0, 4, "BUFH") == 0 || type.compare(0, 5, "BUFCE") == 0 ||
+           type.compare(0, 5, "BUFGCE") == 0;
+}
+
+// Logical inputs of a LUT-type cell by their bit in INIT, as in the bitstream writer; empty for unknown types
+std::vector<std::string> logical_lut_inputs(const std::string &type)
+{
+    if (type == "LUT6_2")
+        return {"I0", "I1", "I2", "I3", "I4", "I5"};
+    if (type.size() == 4 && type.compare(0, 3, "LUT") == 0 && type[3] >= '1' && type[3] <= '6') {
+        std::vector<std::string> inputs;
+        for (int i = 0; i < type[3] - '0'; i++)
+            inputs.push_back("I" + std::to_string(i));
+        return inputs;
+    }
+    if (type == "RAMD64E")
+        return {"RADR0", "RADR1", "RADR2", "RADR3", "RADR4", "RADR5"};
+    if (type == "RAMD32")
+        return {"RADR0", "RADR1", "RADR2", "RADR3", "RADR4"};
+    if (type == "SRL16E")
+        return {"A0", "A1", "A2", "A3"};
+    if (type == "SRLC32E")
+        return {"A[0]", "A[1]", "A[2]", "A[3]", "A[4]"};
+    return {};
+}
+
+bool is_bram(const std::string &type)
+{
+    return type.compare(0, 4, "RAMB") == 0 || type.compare(0, 4, "FIFO") == 0;
+}
+
+bool is_dsp(const std::string &type) { return type.compare(0, 3, "DSP") == 0; }
+
+bool is_uram(const std::string &type) { return type.compare(0, 4, "URAM") == 0; }
+} // namespace
+
+double Arch::getClockFrequency(const NetInfo *clock) const
+{
+    // Follow clock buffers back to a constrained clock, if there is one
+    for (int depth = 0; clock != nullptr && depth < 4; depth++) {
+        if (clock->clkconstr != nullptr)
+            return 1e9 / getDelayNS(clock->clkconstr->period.maxDelay());
+        const CellInfo *drv = clock->driver.cell;
+        if (drv == nullptr || !is_clock_buffer(drv->type.str(this)))
+            break;
+        const NetInfo *input = nullptr;
+        for (auto &port : drv->ports)
+            if (port.second.type == PORT_IN && port.second.net != nullptr &&
+                port.second.net->driver.cell != nullptr && port.second.net->driver.cell->type != id_PSEUDO_GND &&
+                port.second.net->driver.cell->type != id_PSEUDO_VCC)
+                input = port.second.net;
+        clock = input;
+    }
+    return getCtx()->setting<float>("target_freq");
+}
+
+std::unordered_map<IdString, Arch::NetActivity> Arch::estimateActivity()
+{
+    std::unordered_map<IdString, NetActivity> activity;
+    double default_density = getCtx()->setting<float>("power/defaultToggleRate", 12.5) / 100.0;
+    std::unordered_set<IdString> fixed;
+
+    for (auto &net : nets) {
+        NetInfo *ni = net.second.get();
+        NetActivity &act = activity[ni->name];
+        act.density = default_density;
+        const CellInfo *drv = ni->driver.cell;
+        if (drv != nullptr && (drv->type == id_PSEUDO_GND || drv->type == id_PSEUDO_VCC)) {
+            act.prob = (drv->type == id_PSEUDO_VCC) ? 1.0 : 0.0;
+            act.density = 0;
+            fixed.insert(ni->name);
+        }
+        // Activity given with set_switching_activity
+        auto toggle = ni->attrs.find(id("X_TOGGLE_RATE"));
+        if (toggle != ni->attrs.end()) {
+            act.density = std::stod(toggle->second.as_string()) / 100.0;
+            fixed.insert(ni->name);
+        }
+        auto prob = ni->attrs.find(id("X_STATIC_PROB"));
+        if (prob != ni->attrs.end()) {
+            act.prob = std::stod(prob->second.as_string());
+            fixed.insert(ni->name);
+        }
+    }
+
+    // Clocks toggle twice a cycle; and are their own domain
+    IdString ff_clk = xc7 ? id_CK : id_CLK;
+    for (auto &cell : cells) {
+        const CellInfo *ci = cell.second.get();
+        if (ci->type != id_SLICE_FFX)
+            continue;
+        const NetInfo *clk = get_net_or_empty(ci, ff_clk);
+        if (clk == nullptr || fixed.count(clk->name))
+            continue;
+        NetActivity &act = activity.at(clk->name);
+        act.prob = 0.5;
+        act.density = 2.0;
+        act.clock = clk->name;
+        act.freq = getClockFrequency(clk);
+        fixed.insert(clk->name);
+    }
+
+    // Combinational cells are evaluated in topological order, so that each sees the final activity of its inputs.
+    // Cells on combinational loops keep the default activity
+    auto is_comb = [&](const CellInfo *ci) {
+        if (ci->type == id_SLICE_LUTX)
+            return !ci->attrs.count(id("X_LUT_AS_DRAM")) && !ci->attrs.count(id("X_LUT_AS_SRL"));
+        return ci->type == id_F7MUX || ci->type == id_F8MUX || ci->type == id_F9MUX ||
+               ci->type == id("SELMUX2_1") || ci->type == id_CARRY4 || ci->type == id_CARRY8;
+    };
+    std::vector<const CellInfo *> order;
+    {
+        std::unordered_map<IdString, int> pending;
+        std::queue<const CellInfo *> ready;
+        for (auto cell : sorted(cells)) {
+            const CellInfo *ci = cell.second;
+            if (!is_comb(ci))
+                continue;
+            int count = 0;
+            for (auto &port : ci->ports)
+                if (port.second.type == PORT_IN && port.second.net != nullptr &&
+                    port.second.net->driver.cell != nullptr && is_comb(port.second.net->driver.cell))
+                    ++count;
+            pending[ci->name] = count;
+            if (count == 0)
+                ready.push(ci);
+        }
+        while (!ready.empty()) {
+            const CellInfo *ci = ready.front();
+            ready.pop();
+            order.push_back(ci);
+            for (auto &port : ci->ports) {
+                if (port.second.type != PORT_OUT || port.second.net == nullptr)
+                    continue;
+                for (auto &usr : port.second.net->users)
+                    if (is_comb(usr.cell) && --pending.at(usr.cell->name) == 0)
+                        ready.push(usr.cell);
+            }
+        }
+    }
+
+    NetActivity zero;
+    zero.prob = 0;
+    auto input = [&](const CellInfo *ci, IdString port) -> const NetActivity & {
+        const NetInfo *ni = get_net_or_empty(ci, port);
+        return (ni == nullptr) ? zero : activity.at(ni->name);
+    };
+    auto set_output = [&](const CellInfo *ci, IdString port, double prob, double density,
+                          const std::vector<const NetActivity *> &inputs) {
+        const NetInfo *ni = get_net_or_empty(ci, port);
+        if (ni == nullptr || fixed.count(ni->name))
+            return;
+        NetActivity &act = activity.at(ni->name);
+        act.prob = std::min(1.0, std::max(0.0, prob));
+        act.density = density;
+        // Combinational outputs belong to the fastest domain among their inputs
+        act.clock = IdString();
+        act.freq = 0;
+        for (auto in : inputs)
+            if (in->freq > act.freq) {
+                act.clock = in->clock;
+                act.freq = in->freq;
+            }
+    };
+    // Probability and transition density of a function with truth table init of independent inputs, using the
+    // probability of the Boolean difference with respect to each input (Najm's transition density)
+    auto eval_function = [&](uint64_t init, const std::vector<const NetActivity *> &inputs, double &prob,
+                             double &density) {
+        int k = int(inputs.size());
+        prob = 0;
+        density = 0;
+        auto minterm_prob = [&](int m, int skip) {
+            double p = 1.0;
+            for (int i = 0; i < k; i++)
+                if (i != skip)
+                    p *= ((m >> i) & 1) ? inputs.at(i)->prob : (1.0 - inputs.at(i)->prob);
+            return p;
+        };
+        for (int m = 0; m < (1 << k); m++)
+            if ((init >> m) & 1)
+                prob += minterm_prob(m, -1);
+        for (int i = 0; i < k; i++) {
+            if (inputs.at(i)->density == 0)
+                continue;
+            double diff = 0;
+            for (int m = 0; m < (1 << k); m++)
+                if (!((m >> i) & 1) && (((init >> m) & 1) != ((init >> (m | (1 << i))) & 1)))
+                    diff += minterm_prob(m, i);
+            density += diff * inputs.at(i)->density;
+        }
+    };
+
+    static const IdString lut_inputs[] = {id_A1, id_A2, id_A3, id_A4, id_A5, id_A6};
+    // Flipflops are evaluated before each pass over the combinational logic; a few passes let activity settle
+    // around sequential loops
+    int passes = getCtx()->setting<int>("power/activityPasses", 3);
+    for (int pass = 0; pass < passes; pass++) {
+        for (auto &cell : cells) {
+            const CellInfo *ci = cell.second.get();
+            if (ci->type != id_SLICE_FFX)
+                continue;
+            const NetActivity &d = input(ci, id_D);
+            const NetInfo *clk = get_net_or_empty(ci, ff_clk);
+            const NetInfo *q = get_net_or_empty(ci, id_Q);
+            if (q == nullptr || fixed.count(q->name))
+                continue;
+            NetActivity &act = activity.at(q->name);
+            act.prob = d.prob;
+            // A register output can toggle at most once a cycle
+            act.density = std::min(d.density, 2.0 * d.prob * (1.0 - d.prob));
+            act.clock = (clk != nullptr) ? clk->name : IdString();
+            act.freq = (clk != nullptr) ? activity.at(clk->name).freq : 0;
+        }
+        for (auto ci : order) {
+            double prob, density;
+            if (ci->type == id_SLICE_LUTX) {
+                auto init_param = ci->params.find(id_INIT);
+                uint64_t init = (init_param != ci->params.end() && !init_param->second.is_string)
+                                        ? uint64_t(init_param->second.as_int64())
+                                        : 0;
+                std::vector<const NetActivity *> inputs;
+                auto log_inputs = logical_lut_inputs(str_or_default(ci->attrs, id("X_ORIG_TYPE"), ""));
+                if (!log_inputs.empty()) {
+                    // INIT is indexed by the logical inputs, which the router may have permuted across the physical
+                    // pins; X_ORIG_PORT_* on each physical pin names the logical input(s) it drives
+                    inputs.assign(log_inputs.size(), &zero);
+                    for (auto a : lut_inputs) {
+                        auto orig = ci->attrs.find(id("X_ORIG_PORT_" + a.str(this)));
+                        if (orig == ci->attrs.end())
+                            continue;
+                        std::vector<std::string> names;
+                        boost::split(names, orig->second.as_string(), boost::is_any_of(" "));
+                        for (auto &name : names) {
+                            auto log = std::find(log_inputs.begin(), log_inputs.end(), name);
+                            if (log != log_inputs.end())
+                                inputs.at(log - log_inputs.begin()) = &input(ci, a);
+                        }
+                    }
+                    // A packed LUT is one logical function, whichever of O6/O5 it drives
+                    eval_function(init, inputs, prob, density);
+                    set_output(ci, id_O6, prob, density, inputs);
+                    set_output(ci, id_O5, prob, density, inputs);
+                } else {
+                    for (auto a : lut_inputs)
+                        inputs.push_back(&input(ci, a));
+                    eval_function(init, inputs, prob, density);
+                    set_output(ci, id_O6, prob, density, inputs);
+                    inputs.pop_back();
+                    eval_function(init & 0xFFFFFFFFULL, inputs, prob, density);
+                    set_output(ci, id_O5, prob, density, inputs);
+                }
+            } else if (ci->type == id_CARRY4 || ci->type == id_CARRY8) {
+                // O[i] = S[i] ^ C[i], C[i+1] = S[i] ? C[i] : DI[i]
+                int width = (ci->type == id_CARRY4) ? 4 : 8;
+                IdString cin = ci->ports.count(id("CYINIT")) && get_net_or_empty(ci, id("CYINIT")) != nullptr
+                                       ? id("CYINIT")
+                                       : (ci->ports.count(id("CIN")) ? id("CIN") : id_AX);
+                NetActivity carry = input(ci, cin);
+                for (int i = 0; i < width; i++) {
+                    const NetActivity &s = input(ci, id("S" + std::to_string(i)));
+                    const NetActivity &di = input(ci, id("DI" + std::to_string(i)));
+                    std::vector<const NetActivity *> xor_in{&s, &carry};
+                    eval_function(0x6, xor_in, prob, density);
+                    set_output(ci, id("O" + std::to_string(i)), prob, density, xor_in);
+                    // Inputs of the mux are DI, C, S
+                    std::vector<const NetActivity *> mux_in{&di, &carry, &s};
+                    eval_function(0xCA, mux_in, prob, density);
+                    set_output(ci, id("CO" + std::to_string(i)), prob, density, mux_in);
+                    NetActivity next = carry;
+                    next.prob = prob;
+                    next.density = density;
+                    carry = next;
+                }
+            } else {
+                std::vector<const NetActivity *> inputs{&input(ci, id_I0), &input(ci, id_I1), &input(ci, id_S0)};
+                eval_function(0xCA, inputs, prob, density);
+                set_output(ci, id_OUT, prob, density, inputs);
+            }
+        }
+    }
+    return activity;
+}
+
+void Arch::writePowerReport(const std::string &filename)
+{
+    auto activity = estimateActivity();
+    double vccint = getCtx()->setting<float>("power/vccint", xc7 ? 1.0 : 0.85);
+    double default_freq = getCtx()->setting<float>("target_freq");
+    auto freq_of = [&](const NetActivity &act) { return act.freq > 0 ? act.freq : default_freq; };
+    // Power in mW of switching a capacitance in fF
+    auto switching_mw = [&](double cap_ff, double toggles, double freq) {
+        return 0.5 * cap_ff * 1e-15 * vccint * vccint * freq * toggles * 1e3;
+    };
+
+    struct NetPower
+    {
+        IdString name;
+        double cap, power;
+    };
+    std::vector<NetPower> net_power;
+    std::map<std::string, double> domain_power, domain_freq;
+    double clock_total = 0, signal_total = 0, logic_total = 0, bram_total = 0, dsp_total = 0;
+    auto domain_name = [&](const NetActivity &act) {
+        return act.clock == IdString() ? std::string("(unclocked)") : act.clock.str(this);
+    };
+
+    for (auto net : sorted(nets)) {
+        const NetInfo *ni = net.second;
+        if (ni->driver.cell == nullptr || ni->driver.cell->type == id_PSEUDO_GND ||
+            ni->driver.cell->type == id_PSEUDO_VCC)
+            continue;
+        const NetActivity &act = activity.at(ni->name);
+        double cap = pin_capacitance * ni->users.size();
+        if (!ni->wires.empty()) {
+            for (auto &wire : ni->wires)
+                cap += wire_capacitance(wireIntent(wire.first));
+        } else if (ni->driver.cell->bel != BelId()) {
+            Loc drv = getBelLocation(ni->driver.cell->bel);
+            int x0 = drv.x, x1 = drv.x, y0 = drv.y, y1 = drv.y;
+            for (auto &usr : ni->users) {
+                if (usr.cell->bel == BelId())
+                    continue;
+                Loc loc = getBelLocation(usr.cell->bel);
+                x0 = std::min(x0, loc.x);
+                x1 = std::max(x1, loc.x);
+                y0 = std::min(y0, loc.y);
+                y1 = std::max(y1, loc.y);
+            }
+            cap += unrouted_tile_capacitance * ((x1 - x0) + (y1 - y0));
+        }
+        double power = switching_mw(cap, act.density, freq_of(act));
+        bool is_clock = (act.clock == ni->name);
+        (is_clock ? clock_total : signal_total) += power;
+        domain_power[domain_name(act)] += power;
+        domain_freq[domain_name(act)] = freq_of(act);
+        net_power.push_back(NetPower{ni->name, cap, power});
+    }
+
+    for (auto cell : sorted(cells)) {
+        const CellInfo *ci = cell.second;
+        const std::string &type = ci->type.str(this);
+        double power = 0;
+        std::string domain = "(unclocked)";
+        if (ci->type == id_SLICE_FFX) {
+            const NetInfo *q = get_net_or_empty(ci, id_Q);
+            if (q != nullptr) {
+                const NetActivity &act = activity.at(q->name);
+                power = switching_mw(ff_capacitance, act.density, freq_of(act));
+                domain = domain_name(act);
+            }
+            logic_total += power;
+        } else if (ci->type == id_SLICE_LUTX || ci->type == id_F7MUX || ci->type == id_F8MUX ||
+                   ci->type == id_F9MUX || ci->type == id_CARRY4 || ci->type == id_CARRY8) {
+            for (auto &port : ci->ports) {
+                if (port.second.type != PORT_OUT || port.second.net == nullptr)
+                    continue;
+                const NetActivity &act = activity.at(port.second.net->name);
+                power += switching_mw(logic_capacitance, act.density, freq_of(act));
+                domain = domain_name(act);
+            }
+            logic_total += power;
+        } else if (is_bram(type) || is_uram(type) || is_dsp(type)) {
+            // Block power scales with the clock, and with the enables (RAMs) or input activity (DSPs)
+            double freq = 0, enable = 0, density = 0;
+            int n_enable = 0, n_inputs = 0;
+            for (auto &port : ci->ports) {
+                if (port.second.net == nullptr || port.second.type != PORT_IN)
+                    continue;
+                const NetActivity &act = activity.at(port.second.net->name);
+                const std::string &pname = port.first.str(this);
+                if (pname.find("CLK") != std::string::npos) {
+                    if (freq_of(act) > freq) {
+                        freq = freq_of(act);
+                        domain = domain_name(act);
+                    }
+                } else if (pname.compare(0, 2, "EN") == 0) {
+                    enable = std::max(enable, act.prob);
+                    ++n_enable;
+                } else {
+                    density += act.density;
+                    ++n_inputs;
+                }
+            }
+            if (freq == 0)
+                freq = default_freq;
+            double scale = vccint * vccint * freq / 1e6 * 1e-3;
+            if (is_dsp(type)) {
+                double rel_activity = n_inputs > 0 ? (density / n_inputs) / 0.125 : 1.0;
+                power = dsp_uw_per_mhz * scale * std::min(4.0, rel_activity);
+                dsp_total += power;
+            } else {
+                double uw_per_mhz = is_uram(type) ? uram_uw_per_mhz
+                                                  : (type.find("18") != std::string::npos ? bram18_uw_per_mhz
+                                                                                          : bram36_uw_per_mhz);
+                power = uw_per_mhz * scale * (n_enable > 0 ? enable : 0.5);
+                bram_total += power;
+            }
+        } else {
+            continue;
+        }
+        domain_power[domain] += power;
+        if (!domain_freq.count(domain))
+            domain_freq[domain] = default_freq;
+    }
+
+    double total = clock_total + signal_total + logic_total + bram_total + dsp_total;
+    log_info("Estimated dynamic power: %.2f mW (clocks %.2f, signals %.2f, logic %.2f, BRAM %.2f, DSP %.2f)\n", total,
+             clock_total, signal_total, logic_total, bram_total, dsp_total);
+
+    std::ofstream out(filename);
+    if (!out)
+        log_error("failed to open power report file '%s'\n", filename.c_str());
+    out << "Dynamic power estimate at VCCINT " << vccint << "V" << std::endl << std::endl;
+    out << stringf("%-24s %12s\n", "Category", "Power (mW)");
+    out << stringf("%-24s %12.3f\n", "Clocks", clock_total);
+    out << stringf("%-24s %12.3f\n", "Signals", signal_total);
+    out << stringf("%-24s %12.3f\n", "Logic", logic_total);
+    out << stringf("%-24s %12.3f\n", "BRAM", bram_total);
+    out << stringf("%-24s %12.3f\n", "DSP", dsp_total);
+    out << stringf("%-24s %12.3f\n", "Total", total) << std::endl;
+
+    out << stringf("%-40s %12s %12s\n", "Clock domain", "Freq (MHz)", "Power (mW)");
+    for (auto &domain : domain_power)
+        out << stringf("%-40s %12.2f %12.3f\n", domain.first.c_str(), domain_freq.at(domain.first) / 1e6,
+                       domain.second);
+    out << std::endl;
+
+    std::stable_sort(net_power.begin(), net_power.end(),
+                     [](const NetPower &a, const NetPower &b) { return a.power > b.power; });
+    out << stringf("%-60s %-24s %10s %10s %10s %12s\n", "Net", "Clock domain", "Toggle (%)", "Prob", "Cap (fF)",
+                   "Power (mW)");
+    for (auto &np : net_power) {
+        const NetActivity &act = activity.at(np.name);
+        out << stringf("%-60s %-24s %10.2f %10.3f %10.1f %12.5f\n", np.name.c_str(this), domain_name(act).c_str(),
+                       act.density * 100.0, act.prob, np.cap, np.power);
+    }
+}
+
+NEXTPNR_NAMESPACE_END
@@ -176,6 +176,28 @@ void Arch::parseXdc(std::istream &in)
                 n->clkconstr->high.delay = n->clkconstr->period.delay / 2;
                 n->clkconstr->low.delay = n->clkconstr->period.delay / 2;
             }
+        } else if (cmd == "set_switching_activity") {
+            // Only net activity is supported, given as a toggle rate in percent of the clock and a static probability
+            std::string toggle_rate, static_prob;
+            int cursor = 1;
+            for (cursor = 1; cursor < int(arguments.size()); cursor++) {
+                std::string opt = arguments.at(cursor);
+                if (opt == "-toggle_rate" && cursor + 1 < int(arguments.size()))
+                    toggle_rate = arguments.at(++cursor);
+                else if (opt == "-static_probability" && cursor + 1 < int(arguments.size()))
+                    static_prob = arguments.at(++cursor);
+                else
+                    break;
+            }
+            if (cursor >= int(arguments.size()))
+                log_error("found set_switching_activity without target (on line %d)\n", lineno);
+            std::vector<NetInfo *> dest = get_nets(arguments.at(cursor));
+            for (auto n : dest) {
+                if (!toggle_rate.empty())
+                    n->attrs[id("X_TOGGLE_RATE")] = toggle_rate;
+                if (!static_prob.empty())
+                    n->attrs[id("X_STATIC_PROB")] = static_prob;
+            }
         } else {
             log_info("ignoring unsupported XDC command '%s' (on line %d)\n", cmd.c_str(), lineno);
         }